@@ -91,6 +91,43 @@ static void gnc_tree_model_account_event_handler (QofInstance *entity,
         GncTreeModelAccount *model,
         GncEventData *ed);
 
+/** The balances kept by the balance rollup cache. */
+typedef enum
+{
+    BALANCE_PRESENT,
+    BALANCE_CURRENT,
+    BALANCE_CLEARED,
+    BALANCE_RECONCILED,
+    BALANCE_FUTURE_MIN,
+    BALANCE_PERIOD_START,
+    BALANCE_PERIOD_END,
+    NUM_BALANCES
+} AccountBalanceType;
+
+#define BALANCE_BIT(type) (1 << (type))
+#define PERIOD_BITS (BALANCE_BIT(BALANCE_PERIOD_START) | \
+                     BALANCE_BIT(BALANCE_PERIOD_END))
+
+/** The balances of one account in its own commodity, without any
+ *  sign reversal.  The totals include all of the descendants,
+ *  converted to the account's commodity the way the engine's
+ *  recursive balance functions do it.  A balance is only valid if
+ *  its bit is set in own_valid or total_valid.
+ *
+ *  An account's total is only valid if the own balances of all of
+ *  its descendants are.  Any event for an account invalidates its own
+ *  balances and the totals of its ancestors; a total is then rebuilt
+ *  from the still valid totals of its children.
+ */
+typedef struct
+{
+    const gnc_commodity *commodity;
+    guint own_valid;
+    guint total_valid;
+    gnc_numeric own[NUM_BALANCES];
+    gnc_numeric total[NUM_BALANCES];
+} AccountBalances;
+
 /** The instance private data for an account tree model. */
 typedef struct GncTreeModelAccountPrivate
 {
@@ -101,6 +138,9 @@ typedef struct GncTreeModelAccountPrivate
 
     GHashTable *account_values_hash;
 
+    GHashTable *account_balances;
+    time64 period_start;
+    time64 period_end;
 } GncTreeModelAccountPrivate;
 
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
@@ -201,6 +241,12 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                        g_free, g_free);
 
+    // and the balance rollup cache
+    priv->account_balances = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                    NULL, g_free);
+    priv->period_start = gnc_accounting_period_fiscal_start ();
+    priv->period_end = gnc_accounting_period_fiscal_end ();
+
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
                            model);
@@ -254,6 +300,7 @@ gnc_tree_model_account_dispose (GObject *object)
 
     // destroy the cached account values
     g_hash_table_destroy (priv->account_values_hash);
+    g_hash_table_destroy (priv->account_balances);
 
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gnc_tree_model_account_update_color,
@@ -551,6 +598,249 @@ gnc_tree_model_account_set_color (GncTreeModelAccount *model,
         g_value_set_static_string (value, NULL);
 }
 
+/************************************************************/
+/*                 Balance Rollup Cache                     */
+/************************************************************/
+
+static AccountBalances *
+get_account_balances (GncTreeModelAccount *model, Account *account)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountBalances *balances;
+
+    balances = g_hash_table_lookup (priv->account_balances, account);
+    if (!balances)
+    {
+        balances = g_new0 (AccountBalances, 1);
+        balances->commodity = xaccAccountGetCommodity (account);
+        g_hash_table_insert (priv->account_balances, account, balances);
+    }
+    return balances;
+}
+
+static gnc_numeric
+compute_own_balance (GncTreeModelAccount *model, Account *account,
+                     AccountBalanceType type)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    switch (type)
+    {
+    case BALANCE_PRESENT:
+        return xaccAccountGetPresentBalance (account);
+    case BALANCE_CURRENT:
+        return xaccAccountGetBalance (account);
+    case BALANCE_CLEARED:
+        return xaccAccountGetClearedBalance (account);
+    case BALANCE_RECONCILED:
+        return xaccAccountGetReconciledBalance (account);
+    case BALANCE_FUTURE_MIN:
+        return xaccAccountGetProjectedMinimumBalance (account);
+    case BALANCE_PERIOD_START:
+        return xaccAccountGetBalanceAsOfDate (account, priv->period_start);
+    case BALANCE_PERIOD_END:
+        return xaccAccountGetBalanceAsOfDate (account, priv->period_end);
+    default:
+        g_assert_not_reached ();
+        return gnc_numeric_zero ();
+    }
+}
+
+static gnc_numeric
+get_own_balance (GncTreeModelAccount *model, Account *account,
+                 AccountBalanceType type)
+{
+    AccountBalances *balances = get_account_balances (model, account);
+
+    if (!balances->commodity)
+        return gnc_numeric_zero ();
+
+    if (!(balances->own_valid & BALANCE_BIT(type)))
+    {
+        balances->own[type] = compute_own_balance (model, account, type);
+        balances->own_valid |= BALANCE_BIT(type);
+    }
+    return balances->own[type];
+}
+
+typedef struct
+{
+    GncTreeModelAccount *model;
+    AccountBalanceType type;
+    const gnc_commodity *commodity;
+    gnc_numeric total;
+} BalanceSum;
+
+static void
+add_converted_balance (Account *account, gpointer user_data)
+{
+    BalanceSum *sum = user_data;
+    gnc_numeric balance;
+
+    balance = get_own_balance (sum->model, account, sum->type);
+    balance = xaccAccountConvertBalanceToCurrency (account, balance,
+                                                   xaccAccountGetCommodity (account),
+                                                   sum->commodity);
+    sum->total = gnc_numeric_add (sum->total, balance,
+                                  gnc_commodity_get_fraction (sum->commodity),
+                                  GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static gnc_numeric
+get_total_balance (GncTreeModelAccount *model, Account *account,
+                   AccountBalanceType type)
+{
+    AccountBalances *balances = get_account_balances (model, account);
+    GList *children, *node;
+    BalanceSum sum;
+
+    if (!balances->commodity)
+        return gnc_numeric_zero ();
+
+    if (balances->total_valid & BALANCE_BIT(type))
+        return balances->total[type];
+
+    sum.model = model;
+    sum.type = type;
+    sum.commodity = balances->commodity;
+    sum.total = get_own_balance (model, account, type);
+
+    children = gnc_account_get_children (account);
+    for (node = children; node; node = g_list_next (node))
+    {
+        Account *child = node->data;
+
+        /* A child in the same commodity already has the total of its
+         * subtree, the others are converted one account at a time. */
+        if (gnc_commodity_equiv (xaccAccountGetCommodity (child), sum.commodity))
+            sum.total = gnc_numeric_add (sum.total,
+                                         get_total_balance (model, child, type),
+                                         gnc_commodity_get_fraction (sum.commodity),
+                                         GNC_HOW_RND_ROUND_HALF_UP);
+        else
+        {
+            add_converted_balance (child, &sum);
+            gnc_account_foreach_descendant (child, add_converted_balance, &sum);
+        }
+    }
+    g_list_free (children);
+
+    balances->total[type] = sum.total;
+    balances->total_valid |= BALANCE_BIT(type);
+    return sum.total;
+}
+
+static void
+invalidate_total_balances (GncTreeModelAccount *model, Account *account,
+                           guint bits)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    for (; account; account = gnc_account_get_parent (account))
+    {
+        AccountBalances *balances = g_hash_table_lookup (priv->account_balances,
+                                                         account);
+        if (balances)
+            balances->total_valid &= ~bits;
+    }
+}
+
+static void
+forget_account_balances (Account *account, gpointer user_data)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(user_data);
+
+    g_hash_table_remove (priv->account_balances, account);
+}
+
+/** Forget the own balances of an account that changed and the totals
+ *  of the account and its ancestors.  They're recomputed when a row
+ *  that shows them is drawn, by which time the engine has brought the
+ *  account's balances up to date. */
+static void
+invalidate_own_balances (GncTreeModelAccount *model, Account *account)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountBalances *balances;
+
+    balances = g_hash_table_lookup (priv->account_balances, account);
+    if (balances)
+    {
+        balances->commodity = xaccAccountGetCommodity (account);
+        balances->own_valid = 0;
+    }
+    invalidate_total_balances (model, account, ~0);
+}
+
+static void
+gnc_tree_model_account_update_balances (GncTreeModelAccount *model,
+                                        Account *account,
+                                        QofEventId event_type,
+                                        GncEventData *ed)
+{
+    switch (event_type)
+    {
+    case QOF_EVENT_ADD:
+        invalidate_total_balances (model, gnc_account_get_parent (account), ~0);
+        break;
+
+    case QOF_EVENT_REMOVE:
+        forget_account_balances (account, model);
+        gnc_account_foreach_descendant (account, forget_account_balances, model);
+        if (ed && ed->node)
+            invalidate_total_balances (model, GNC_ACCOUNT(ed->node), ~0);
+        break;
+
+    case QOF_EVENT_DESTROY:
+        forget_account_balances (account, model);
+        break;
+
+    default:
+        /* QOF_EVENT_MODIFY and the GNC_EVENT_ITEM_* events for the
+         * account's splits. */
+        invalidate_own_balances (model, account);
+        break;
+    }
+}
+
+static void
+clear_period_balances (gpointer key, gpointer value, gpointer user_data)
+{
+    AccountBalances *balances = value;
+
+    balances->own_valid &= ~PERIOD_BITS;
+    balances->total_valid &= ~PERIOD_BITS;
+}
+
+static gnc_numeric
+get_balance (GncTreeModelAccount *model, Account *account,
+             AccountBalanceType type, gboolean recurse)
+{
+    if (recurse)
+        return get_total_balance (model, account, type);
+    else
+        return get_own_balance (model, account, type);
+}
+
+static gchar *
+gnc_tree_model_account_get_print_balance (GncTreeModelAccount *model,
+                                          Account *account,
+                                          AccountBalanceType type,
+                                          gboolean recurse,
+                                          gboolean *negative)
+{
+    gnc_numeric balance;
+
+    balance = get_balance (model, account, type, recurse);
+    if (gnc_reverse_balance (account))
+        balance = gnc_numeric_neg (balance);
+
+    if (negative)
+        *negative = gnc_numeric_negative_p (balance);
+
+    return g_strdup (xaccPrintAmount (balance, gnc_account_print_info (account, TRUE)));
+}
+
 static gchar *
 gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
                                                Account *acct,
@@ -574,7 +864,17 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
     if (t1 > t2)
         return g_strdup ("");
 
-    b3 = xaccAccountGetBalanceChangeForPeriod (acct, t1, t2, recurse);
+    if (t1 != priv->period_start || t2 != priv->period_end)
+    {
+        priv->period_start = t1;
+        priv->period_end = t2;
+        g_hash_table_foreach (priv->account_balances,
+                              clear_period_balances, NULL);
+    }
+
+    b3 = gnc_numeric_sub (get_balance (model, acct, BALANCE_PERIOD_END, recurse),
+                          get_balance (model, acct, BALANCE_PERIOD_START, recurse),
+                          GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
     if (gnc_reverse_balance (acct))
         b3 = gnc_numeric_neg (b3);
 
@@ -604,6 +904,9 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
         priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                            g_free, g_free);
 
+        // the balances may have been converted with prices that changed
+        g_hash_table_remove_all (priv->account_balances);
+
         gtk_tree_model_foreach (GTK_TREE_MODEL(model), row_changed_foreach_func, NULL);
     }
 }
@@ -773,8 +1076,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_PRESENT, TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
@@ -785,16 +1088,16 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_PRESENT, TRUE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CURRENT, FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
@@ -805,8 +1108,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CURRENT, FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -824,8 +1127,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CLEARED, TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
@@ -836,16 +1139,16 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CLEARED, TRUE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_RECONCILED, TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
@@ -862,16 +1165,16 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_RECONCILED, TRUE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_FUTURE_MIN, TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
@@ -882,16 +1185,16 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_FUTURE_MIN, TRUE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CURRENT, TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
@@ -902,8 +1205,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_get_print_balance (model, account,
+                 BALANCE_CURRENT, TRUE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -1445,6 +1748,9 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         return;
     }
 
+    /* bring the balance rollups up to date */
+    gnc_tree_model_account_update_balances (model, account, event_type, ed);
+
     /* clear the cached model values for account */
     if (event_type != QOF_EVENT_ADD)
         gnc_tree_model_account_clear_cached_values (model, account);
@@ -1490,6 +1796,9 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         break;
 
     case QOF_EVENT_MODIFY:
+    case GNC_EVENT_ITEM_ADDED:
+    case GNC_EVENT_ITEM_REMOVED:
+    case GNC_EVENT_ITEM_CHANGED:
         DEBUG("modify  account %p (%s)", account, xaccAccountGetName (account));
         path = gnc_tree_model_account_get_path_from_account (model, account);
         if (!path)
@@ -0,0 +1,169 @@
+/********************************************************************
+ * gtest-tree-model-account.cpp -- unit tests for the balances the  *
+ *                                 account tree model shows.        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <gtest/gtest.h>
+extern "C"
+{
+#include <config.h>
+#include <gtk/gtk.h>
+#include <gnc-session.h>
+#include <gnc-ui-util.h>
+#include <Account.h>
+#include <Transaction.h>
+#include "gnc-tree-model-account.h"
+}
+#include <string>
+
+class TreeModelAccountTest : public ::testing::Test
+{
+protected:
+    TreeModelAccountTest() :
+        m_book{gnc_get_current_book()}, m_root{gnc_account_create_root(m_book)}
+    {
+        m_usd = gnc_commodity_table_lookup (gnc_commodity_table_get_table (m_book),
+                                            GNC_COMMODITY_NS_CURRENCY, "USD");
+        m_assets = make_account (m_root, ACCT_TYPE_ASSET, "Assets");
+        m_bank = make_account (m_assets, ACCT_TYPE_BANK, "Bank");
+        m_cash = make_account (m_assets, ACCT_TYPE_CASH, "Cash");
+        m_income = make_account (m_root, ACCT_TYPE_INCOME, "Income");
+        m_model = GNC_TREE_MODEL_ACCOUNT(gnc_tree_model_account_new (m_root));
+    }
+    ~TreeModelAccountTest()
+    {
+        g_object_unref (m_model);
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        gnc_clear_current_session ();
+    }
+    Account* make_account (Account* parent, GNCAccountType type,
+                           const char* name)
+    {
+        auto account = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetType (account, type);
+        xaccAccountSetName (account, name);
+        xaccAccountSetCommodity (account, m_usd);
+        xaccAccountBeginEdit (parent);
+        gnc_account_append_child (parent, account);
+        xaccAccountCommitEdit (parent);
+        xaccAccountCommitEdit (account);
+        return account;
+    }
+    /* Returns the split in acc of a transaction from the income account. */
+    Split* deposit (Account* acc, gint64 amount)
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (trans, gnc_time (nullptr));
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+        xaccSplitSetValue (split, gnc_numeric_create (amount, 1));
+        auto other = xaccMallocSplit (m_book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, m_income);
+        xaccSplitSetAmount (other, gnc_numeric_create (-amount, 1));
+        xaccSplitSetValue (other, gnc_numeric_create (-amount, 1));
+        xaccTransCommitEdit (trans);
+        return split;
+    }
+    void set_amount (Split* split, gint64 amount)
+    {
+        auto trans = xaccSplitGetParent (split);
+        xaccTransBeginEdit (trans);
+        for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+        {
+            auto s = static_cast<Split*>(node->data);
+            auto value = gnc_numeric_create (s == split ? amount : -amount, 1);
+            xaccSplitSetAmount (s, value);
+            xaccSplitSetValue (s, value);
+        }
+        xaccTransCommitEdit (trans);
+    }
+    /* The total the model shows for acc. */
+    std::string total (Account* acc)
+    {
+        GtkTreeIter iter;
+        gchar* str = nullptr;
+        if (!gnc_tree_model_account_get_iter_from_account (m_model, acc, &iter))
+            return "";
+        gtk_tree_model_get (GTK_TREE_MODEL(m_model), &iter,
+                            GNC_TREE_MODEL_ACCOUNT_COL_TOTAL, &str, -1);
+        std::string result {str ? str : ""};
+        g_free (str);
+        return result;
+    }
+    /* How the model prints amount as a total of acc. */
+    std::string expected (Account* acc, gint64 amount)
+    {
+        return xaccPrintAmount (gnc_numeric_create (amount, 1),
+                                gnc_account_print_info (acc, TRUE));
+    }
+
+    QofBook* m_book;
+    Account* m_root;
+    gnc_commodity* m_usd;
+    Account* m_assets;
+    Account* m_bank;
+    Account* m_cash;
+    Account* m_income;
+    GncTreeModelAccount* m_model;
+};
+
+TEST_F(TreeModelAccountTest, total_after_new_split)
+{
+    deposit (m_bank, 10);
+    EXPECT_EQ (expected (m_assets, 10), total (m_assets));
+
+    deposit (m_cash, 5);
+    EXPECT_EQ (expected (m_cash, 5), total (m_cash));
+    EXPECT_EQ (expected (m_assets, 15), total (m_assets));
+}
+
+TEST_F(TreeModelAccountTest, total_after_split_amount_change)
+{
+    auto split = deposit (m_bank, 10);
+    deposit (m_cash, 5);
+    EXPECT_EQ (expected (m_bank, 10), total (m_bank));
+    EXPECT_EQ (expected (m_assets, 15), total (m_assets));
+
+    set_amount (split, 25);
+    EXPECT_EQ (expected (m_bank, 25), total (m_bank));
+    EXPECT_EQ (expected (m_assets, 30), total (m_assets));
+}
+
+TEST_F(TreeModelAccountTest, total_after_split_removed)
+{
+    auto split = deposit (m_bank, 10);
+    deposit (m_cash, 5);
+    EXPECT_EQ (expected (m_assets, 15), total (m_assets));
+
+    auto trans = xaccSplitGetParent (split);
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    EXPECT_EQ (expected (m_bank, 0), total (m_bank));
+    EXPECT_EQ (expected (m_assets, 5), total (m_assets));
+}
@@ -843,8 +843,9 @@ gnc_sx_sxsincelast_book_opened(void)
     inst_model = gnc_sx_get_current_instances();
     gnc_sx_instance_model_summarize(inst_model, &summary);
     gnc_sx_summary_print(&summary);
-    gnc_sx_instance_model_effect_change(inst_model, TRUE, &auto_created_txns,
-                                        &creation_errors);
+    gnc_sx_instance_model_effect_change_batched(inst_model, TRUE,
+                                                &auto_created_txns,
+                                                &creation_errors);
 
     if (summary.need_dialog)
     {
@@ -1194,6 +1195,6 @@ gnc_sx_slr_model_effect_change(GncSxSlrTreeModelAdapter *model,
     }
 
     g_signal_handler_block(model->instances, model->updated_cb_id);
-    gnc_sx_instance_model_effect_change(model->instances, auto_create_only, created_transaction_guids, creation_errors);
+    gnc_sx_instance_model_effect_change_batched(model->instances, auto_create_only, created_transaction_guids, creation_errors);
     g_signal_handler_unblock(model->instances, model->updated_cb_id);
 }
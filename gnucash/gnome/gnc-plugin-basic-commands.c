@@ -539,7 +539,7 @@ gnc_main_window_cmd_actions_since_last_run (GtkAction *action, GncMainWindowActi
 
     sx_instances = gnc_sx_get_current_instances();
     gnc_sx_instance_model_summarize(sx_instances, &summary);
-    gnc_sx_instance_model_effect_change(sx_instances, TRUE, &auto_created_txns, NULL);
+    gnc_sx_instance_model_effect_change_batched(sx_instances, TRUE, &auto_created_txns, NULL);
     if (summary.need_dialog)
     {
         gnc_ui_sx_since_last_run_dialog (window, sx_instances, auto_created_txns);
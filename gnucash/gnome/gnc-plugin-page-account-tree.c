@@ -42,6 +42,7 @@
 
 #include "Scrub.h"
 #include "Scrub3.h"
+#include "ScrubPlan.h"
 #include "ScrubBusiness.h"
 #include "Transaction.h"
 #include "dialog-account.h"
@@ -1798,6 +1799,30 @@ gnc_plugin_page_account_tree_cmd_scrub (GtkAction *action, GncPluginPageAccountT
     gnc_resume_gui_refresh ();
 }
 
+/* Looks for problems in the whole tree first, which can use several
+ * threads, then fixes them. Showing progress runs the main loop, so it's
+ * only shown while the plan is applied, and the window is insensitive
+ * from before the plan is made. */
+static void
+scrub_account_tree (Account *account)
+{
+    // XXX: Lots/capital gains scrubbing is disabled
+    gboolean scrub_lots = g_getenv("GNC_AUTO_SCRUB_LOTS") != NULL;
+    ScrubPlan *plan;
+
+    gnc_window_show_progress (_("Checking transactions"), 0.0);
+    plan = xaccScrubPlanNew (account, scrub_lots, NULL);
+
+    if (qof_log_check (log_module, QOF_LOG_INFO))
+    {
+        gchar *report = xaccScrubPlanGetReport (plan);
+        PINFO ("Check & Repair will make these changes:\n%s", report);
+        g_free (report);
+    }
+    xaccScrubPlanApply (plan, gnc_window_show_progress);
+    xaccScrubPlanFree (plan);
+}
+
 static void
 gnc_plugin_page_account_tree_cmd_scrub_sub (GtkAction *action, GncPluginPageAccountTree *page)
 {
@@ -1811,12 +1836,7 @@ gnc_plugin_page_account_tree_cmd_scrub_sub (GtkAction *action, GncPluginPageAcco
     window = GNC_WINDOW(GNC_PLUGIN_PAGE (page)->window);
     gnc_window_set_progressbar_window (window);
 
-    xaccAccountTreeScrubOrphans (account, gnc_window_show_progress);
-    xaccAccountTreeScrubImbalance (account, gnc_window_show_progress);
-
-    // XXX: Lots/capital gains scrubbing is disabled
-    if (g_getenv("GNC_AUTO_SCRUB_LOTS") != NULL)
-        xaccAccountTreeScrubLots(account);
+    scrub_account_tree (account);
 
     gncScrubBusinessAccountTree(account, gnc_window_show_progress);
 
@@ -1834,11 +1854,7 @@ gnc_plugin_page_account_tree_cmd_scrub_all (GtkAction *action, GncPluginPageAcco
     window = GNC_WINDOW(GNC_PLUGIN_PAGE (page)->window);
     gnc_window_set_progressbar_window (window);
 
-    xaccAccountTreeScrubOrphans (root, gnc_window_show_progress);
-    xaccAccountTreeScrubImbalance (root, gnc_window_show_progress);
-    // XXX: Lots/capital gains scrubbing is disabled
-    if (g_getenv("GNC_AUTO_SCRUB_LOTS") != NULL)
-        xaccAccountTreeScrubLots(root);
+    scrub_account_tree (root);
 
     gncScrubBusinessAccountTree(root, gnc_window_show_progress);
 
@@ -43,6 +43,7 @@
 #include "gnc-date-edit.h"
 
 #include "gnc-plugin-page-register.h"
+#include "gnc-balance-matrix.h"
 #include "gnc-budget.h"
 
 #include "dialog-options.h"
@@ -924,11 +925,29 @@ estimate_budget_helper (GtkTreeModel *model, GtkTreePath *path,
     }
     else
     {
+        GList *acct_list = g_list_prepend (NULL, acct);
+        time64 *dates = g_new (time64, 2 * num_periods + 1);
+        gnc_numeric *balances;
+
+        /* Get the balances at the bounds of all the periods in one pass
+         * over the splits. Like
+         * xaccAccountGetNoclosingBalanceChangeForPeriod, leave out the
+         * splits at the bounds themselves. */
         for (i = 0; i < num_periods; i++)
         {
-            num = xaccAccountGetNoclosingBalanceChangeForPeriod
-                (acct, recurrenceGetPeriodTime (&priv->r, i, FALSE),
-                 recurrenceGetPeriodTime (&priv->r, i, TRUE), TRUE);
+            dates[2 * i] = recurrenceGetPeriodTime (&priv->r, i, FALSE) - 1;
+            dates[2 * i + 1] = recurrenceGetPeriodTime (&priv->r, i, TRUE) - 1;
+        }
+        balances = gnc_account_list_get_balances_at_dates
+            (acct_list, dates, 2 * num_periods,
+             GNC_BALANCE_RECURSE | GNC_BALANCE_NOCLOSING, NULL);
+        g_list_free (acct_list);
+        g_free (dates);
+
+        for (i = 0; balances && i < num_periods; i++)
+        {
+            num = gnc_numeric_sub (balances[2 * i + 1], balances[2 * i],
+                                   GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 
             if (!gnc_numeric_check (num))
             {
@@ -941,6 +960,7 @@ estimate_budget_helper (GtkTreeModel *model, GtkTreePath *path,
                 gnc_budget_set_account_period_value (priv->budget, acct, i, num);
             }
         }
+        g_free (balances);
     }
 }
 
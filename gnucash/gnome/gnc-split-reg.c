@@ -1880,6 +1880,11 @@ gnc_split_reg_jump_to_split(GNCSplitReg *gsr, Split *split)
 
     reg = gnc_ledger_display_get_split_register( gsr->ledger );
 
+    /* The split may be before the rows a large register has loaded. */
+    if (!gnc_split_register_get_split_virt_loc(reg, split, &vcell_loc) &&
+            gnc_split_register_clear_load_window (reg))
+        gnc_ledger_display_refresh( gsr->ledger );
+
     if (gnc_split_register_get_split_virt_loc(reg, split, &vcell_loc))
         gnucash_register_goto_virt_cell( gsr->reg, vcell_loc );
 
@@ -1904,6 +1909,10 @@ gnc_split_reg_jump_to_split_amount(GNCSplitReg *gsr, Split *split)
 
     reg = gnc_ledger_display_get_split_register (gsr->ledger);
 
+    if (!gnc_split_register_get_split_amount_virt_loc (reg, split, &virt_loc) &&
+            gnc_split_register_clear_load_window (reg))
+        gnc_ledger_display_refresh (gsr->ledger);
+
     if (gnc_split_register_get_split_amount_virt_loc (reg, split, &virt_loc))
         gnucash_register_goto_virt_loc (gsr->reg, virt_loc);
 
@@ -2285,6 +2294,8 @@ gnc_split_reg_set_sort_reversed(GNCSplitReg *gsr, gboolean rev, gboolean refresh
      */
     Query *query = gnc_ledger_display_get_query( gsr->ledger );
     qof_query_set_sort_increasing (query, !rev, !rev, !rev);
+    gnc_split_register_set_sort_reversed (gnc_ledger_display_get_split_register (gsr->ledger),
+                                          rev);
     gsr->sort_rev = rev;
     if (refresh)
         gnc_ledger_display_refresh( gsr->ledger );
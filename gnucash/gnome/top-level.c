@@ -28,6 +28,7 @@
 #include <glib/gi18n.h>
 #include <stdlib.h>
 
+#include "Scrub3.h"
 #include "TransLog.h"
 #include "business-options-gnome.h"
 #include "business-urls.h"
@@ -61,6 +62,7 @@
 #include "gnc-plugin-page-register2.h"
 #include "gnc-plugin-manager.h" /* FIXME Remove this line*/
 #include "gnc-html.h"
+#include "gnc-lot.h"
 #include "gnc-gnome-utils.h"
 #include "gnc-report.h"
 #include "gnc-split-reg.h"
@@ -364,6 +366,72 @@ gnc_save_all_state (gpointer session, gpointer unused)
     LEAVE("");
 }
 
+/* ============================================================== */
+/* Keep the lots and capital gains of changed trades up to date by
+ * scrubbing them a few at a time whenever the GUI is idle. Like the
+ * other automatic lot scrubbing this is only done if
+ * GNC_AUTO_SCRUB_LOTS is set. */
+
+#define LOT_SCRUB_STEP 10
+
+static gint lot_scrub_handler_id = 0;
+static guint lot_scrub_idle_id = 0;
+
+static gboolean
+gnc_lot_scrub_idle_cb (gpointer unused)
+{
+    if (gnc_current_session_exist () &&
+        xaccAccountTreeScrubDirtyLotsStep (gnc_get_current_root_account (),
+                                           LOT_SCRUB_STEP))
+        return TRUE;
+    lot_scrub_idle_id = 0;
+    return FALSE;
+}
+
+static void
+gnc_lot_scrub_event_cb (QofInstance *entity, QofEventId event_type,
+                        gpointer handler_data, gpointer event_data)
+{
+    if (lot_scrub_idle_id)
+        return;
+    if (!GNC_IS_TRANSACTION (entity) && !GNC_IS_LOT (entity))
+        return;
+    if (!(event_type & (QOF_EVENT_ADD | QOF_EVENT_MODIFY | QOF_EVENT_REMOVE)))
+        return;
+    lot_scrub_idle_id = g_idle_add (gnc_lot_scrub_idle_cb, NULL);
+}
+
+static void
+gnc_lot_scrub_book_opened (gpointer session, gpointer unused)
+{
+    QofBook *book = qof_session_get_book (session);
+
+    if (lot_scrub_handler_id || qof_book_is_readonly (book))
+        return;
+    // XXX: Lots/capital gains scrubbing is disabled
+    if (g_getenv ("GNC_AUTO_SCRUB_LOTS") == NULL)
+        return;
+    /* The lots are as they were saved; only scrub what changes. */
+    xaccAccountTreeStartLotWork (gnc_book_get_root_account (book));
+    lot_scrub_handler_id =
+        qof_event_register_handler (gnc_lot_scrub_event_cb, NULL);
+}
+
+static void
+gnc_lot_scrub_book_closed (gpointer session, gpointer unused)
+{
+    if (lot_scrub_idle_id)
+    {
+        g_source_remove (lot_scrub_idle_id);
+        lot_scrub_idle_id = 0;
+    }
+    if (lot_scrub_handler_id)
+    {
+        qof_event_unregister_handler (lot_scrub_handler_id);
+        lot_scrub_handler_id = 0;
+    }
+}
+
 void
 gnc_main_gui_init (void)
 {
@@ -420,6 +488,10 @@ gnc_main_gui_init (void)
                          (GFunc)gnc_invoice_remind_bills_due_cb, NULL);
     gnc_hook_add_dangler(HOOK_BOOK_OPENED,
                          (GFunc)gnc_invoice_remind_invoices_due_cb, NULL);
+    gnc_hook_add_dangler(HOOK_BOOK_OPENED,
+                         gnc_lot_scrub_book_opened, NULL);
+    gnc_hook_add_dangler(HOOK_BOOK_CLOSED,
+                         gnc_lot_scrub_book_closed, NULL);
 
     gnc_ui_sx_initialize();
 
@@ -52,6 +52,10 @@
 #define GNC_PREF_DEFAULT_STYLE_AUTOLEDGER "default-style-autoledger"
 #define GNC_PREF_DEFAULT_STYLE_JOURNAL    "default-style-journal"
 
+/* The number of splits first loaded into a register; earlier ones are
+ * loaded as the register is scrolled to its top. */
+#define LOAD_WINDOW_SPLITS 1000
+
 
 struct gnc_ledger_display
 {
@@ -73,6 +77,9 @@ struct gnc_ledger_display
     
     gint number_of_subaccounts;
 
+    /* the splits of the last load, to tell if a reload is needed */
+    GList *loaded_splits;
+
     gint component_id;
 };
 
@@ -515,6 +522,21 @@ gnc_ledger_display_parent (void *user_data)
     return gnc_ledger_display_get_parent( ld );
 }
 
+static gboolean
+gnc_ledger_display_load_more (gpointer user_data)
+{
+    GNCLedgerDisplay *ld = user_data;
+
+    if (ld->loading || !gnc_split_register_full_refresh_ok (ld->reg))
+        return FALSE;
+
+    if (!gnc_split_register_extend_load_window (ld->reg))
+        return FALSE;
+
+    gnc_ledger_display_refresh (ld);
+    return TRUE;
+}
+
 static void
 gnc_ledger_display_set_watches (GNCLedgerDisplay *ld, GList *splits)
 {
@@ -538,6 +560,50 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay *ld, GList *splits)
     }
 }
 
+/* If the query gives the same splits as for the last load, redraws the
+ * rows of the changed transactions instead of loading the register
+ * again. Returns FALSE if the register has to be loaded. */
+static gboolean
+gnc_ledger_display_refresh_changes (GNCLedgerDisplay *ld, GHashTable *changes,
+                                    GList *splits)
+{
+    QofBook *book = gnc_get_current_book ();
+    GList *changed = NULL;
+    GList *node, *loaded;
+    GHashTableIter iter;
+    gpointer key;
+    gboolean redrawn;
+
+    if (!gnc_split_register_full_refresh_ok (ld->reg))
+        return FALSE;
+
+    /* Added, removed or moved splits change the rows. */
+    for (node = splits, loaded = ld->loaded_splits; node && loaded;
+            node = node->next, loaded = loaded->next)
+        if (node->data != loaded->data)
+            return FALSE;
+
+    if (node || loaded)
+        return FALSE;
+
+    g_hash_table_iter_init (&iter, changes);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+        Transaction *trans = xaccTransLookup (key, book);
+
+        if (!trans)
+            trans = xaccSplitGetParent (xaccSplitLookup (key, book));
+
+        if (trans)
+            changed = g_list_prepend (changed, trans);
+    }
+
+    redrawn = gnc_split_register_redraw_transactions (ld->reg, changed);
+    g_list_free (changed);
+
+    return redrawn;
+}
+
 static void
 refresh_handler (GHashTable *changes, gpointer user_data)
 {
@@ -600,6 +666,12 @@ refresh_handler (GHashTable *changes, gpointer user_data)
      */
     splits = qof_query_run (ld->query);
 
+    if (changes && gnc_ledger_display_refresh_changes (ld, changes, splits))
+    {
+        LEAVE("redrew changed transactions");
+        return;
+    }
+
     gnc_ledger_display_set_watches (ld, splits);
 
     gnc_ledger_display_refresh_internal (ld, splits);
@@ -626,6 +698,7 @@ close_handler (gpointer user_data)
     qof_query_destroy (ld->query);
     ld->query = NULL;
 
+    g_list_free (ld->loaded_splits);
     g_free (ld);
 }
 
@@ -790,6 +863,7 @@ gnc_ledger_display_internal (Account *lead_account, Query *q,
     ld->destroy = NULL;
     ld->get_parent = NULL;
     ld->user_data = NULL;
+    ld->loaded_splits = NULL;
 
     limit = gnc_prefs_get_float(GNC_PREFS_GROUP_GENERAL_REGISTER, GNC_PREF_MAX_TRANS);
 
@@ -812,6 +886,9 @@ gnc_ledger_display_internal (Account *lead_account, Query *q,
                                       is_template);
 
     gnc_split_register_set_data (ld->reg, ld, gnc_ledger_display_parent);
+    gnc_split_register_set_load_window (ld->reg, LOAD_WINDOW_SPLITS);
+    gnc_table_model_set_load_more_handler (ld->reg->table->model,
+                                           gnc_ledger_display_load_more, ld);
 
     splits = qof_query_run (ld->query);
 
@@ -861,6 +938,9 @@ gnc_ledger_display_refresh_internal (GNCLedgerDisplay *ld, GList *splits)
     gnc_split_register_load (ld->reg, splits,
                              gnc_ledger_display_leader (ld));
 
+    g_list_free (ld->loaded_splits);
+    ld->loaded_splits = g_list_copy (splits);
+
     ld->loading = FALSE;
 }
 
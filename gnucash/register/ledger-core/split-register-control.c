@@ -27,6 +27,7 @@
 #include <glib/gi18n.h>
 
 #include "Scrub.h"
+#include "SX-book.h"
 #include "combocell.h"
 #include "gnc-component-manager.h"
 #include "gnc-prefs.h"
@@ -760,6 +761,106 @@ gnc_find_trans_in_reg_by_desc (SplitRegister *reg, const char *description)
     return NULL;
 }
 
+/* TRUE if trans is the template of a scheduled transaction. */
+static gboolean
+gnc_trans_is_template (Transaction *trans)
+{
+    Account *template_root =
+        gnc_book_get_template_root (xaccTransGetBook (trans));
+    GList *node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Account *account = xaccSplitGetAccount (node->data);
+
+        if (account && gnc_account_get_root (account) == template_root)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Finds the split of trans which goes to account when trans is used
+ * to autofill a register of the account: the split in the account,
+ * or else one in an account of the same commodity, preferably of the
+ * same type. Returns NULL if there is none. */
+static Split *
+gnc_find_split_for_account (Transaction *trans, Account *account)
+{
+    gnc_commodity *commodity = xaccAccountGetCommodity (account);
+    Split *same_type = NULL, *same_commodity = NULL;
+    GList *node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split *split = node->data;
+        Account *split_account = xaccSplitGetAccount (split);
+
+        if (split_account == account)
+            return split;
+        if (!split_account ||
+            !gnc_commodity_equiv (xaccAccountGetCommodity (split_account),
+                                  commodity))
+            continue;
+        if (xaccAccountGetType (split_account) == xaccAccountGetType (account))
+        {
+            if (!same_type)
+                same_type = split;
+        }
+        else if (!same_commodity)
+            same_commodity = split;
+    }
+    return same_type ? same_type : same_commodity;
+}
+
+/* Finds the latest transaction of the book with the given description.
+ * The description quickfill offers the descriptions of all of the
+ * book's transactions, including those not in the register. Templates
+ * of scheduled transactions are left out and, if account isn't NULL,
+ * so are transactions with no split gnc_find_split_for_account()
+ * finds. */
+static Transaction *
+gnc_find_trans_in_book_by_desc (QofBook *book, const char *description,
+                                Account *account)
+{
+    QofQuery *query;
+    QofQueryPredData *pred_data;
+    GSList *primary_sort_params, *secondary_sort_params;
+    GList *node;
+    Transaction *result = NULL;
+
+    query = qof_query_create_for (GNC_ID_TRANS);
+    qof_query_set_book (query, book);
+
+    pred_data = qof_query_string_predicate (QOF_COMPARE_EQUAL, description,
+                                            QOF_STRING_MATCH_NORMAL, FALSE);
+    qof_query_add_term (query,
+                        qof_query_build_param_list (TRANS_DESCRIPTION, NULL),
+                        pred_data, QOF_QUERY_FIRST_TERM);
+
+    primary_sort_params = qof_query_build_param_list (TRANS_DATE_POSTED, NULL);
+    secondary_sort_params = qof_query_build_param_list (TRANS_DATE_ENTERED,
+                            NULL);
+    qof_query_set_sort_order (query, primary_sort_params,
+                              secondary_sort_params, NULL);
+    qof_query_set_sort_increasing (query, TRUE, TRUE, TRUE);
+
+    /* Take the latest one that can be used. */
+    for (node = g_list_last (qof_query_run (query)); node; node = node->prev)
+    {
+        Transaction *trans = node->data;
+
+        if (gnc_trans_is_template (trans))
+            continue;
+        if (account && !gnc_find_split_for_account (trans, account))
+            continue;
+        result = trans;
+        break;
+    }
+
+    qof_query_destroy (query);
+    return result;
+}
+
 /* This function determines if auto-completion is appropriate and,
  * if so, performs it. This should only be called by LedgerTraverse. */
 static gboolean
@@ -860,6 +961,12 @@ gnc_split_register_auto_completion (SplitRegister *reg,
         else
             auto_trans = gnc_find_trans_in_reg_by_desc(reg, desc);
 
+        /* The description may only be used outside of the register. */
+        if (auto_trans == NULL)
+            auto_trans = gnc_find_trans_in_book_by_desc (gnc_get_current_book (),
+                                                         desc,
+                                                         gnc_split_register_get_default_account (reg));
+
         if (auto_trans == NULL)
             return FALSE;
 
@@ -899,21 +1006,18 @@ gnc_split_register_auto_completion (SplitRegister *reg,
                 gnc_split_register_get_default_account (reg);
             gnc_commodity *trans_cmdty = xaccTransGetCurrency(trans);
             gnc_commodity *acct_cmdty = xaccAccountGetCommodity(default_account);
-            Split *s;
-            int i = 0;
             if (gnc_commodity_is_currency(acct_cmdty) &&
                 !gnc_commodity_equal(trans_cmdty, acct_cmdty))
                 xaccTransSetCurrency(trans, acct_cmdty);
 
-            while ((s = xaccTransGetSplit(trans, i)) != NULL)
+            /* A transaction from another account has its split in an
+             * account like the default one moved to it. */
+            blank_split = gnc_find_split_for_account (trans, default_account);
+            if (blank_split)
             {
-                if (default_account == xaccSplitGetAccount(s))
-                {
-                    blank_split = s;
-                    info->blank_split_guid = *xaccSplitGetGUID(blank_split);
-                    break;
-                }
-                i++;
+                if (xaccSplitGetAccount (blank_split) != default_account)
+                    xaccSplitSetAccount (blank_split, default_account);
+                info->blank_split_guid = *xaccSplitGetGUID(blank_split);
             }
         }
 
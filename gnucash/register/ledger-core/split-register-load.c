@@ -32,6 +32,7 @@
 #include "qof.h"
 #include "gnc-ui-util.h"
 #include "gnc-gui-query.h"
+#include "gnc-trans-quickfill.h"
 #include "numcell.h"
 #include "quickfillcell.h"
 #include "recncell.h"
@@ -231,32 +232,23 @@ _find_split_with_parent_txn(gconstpointer a, gconstpointer b)
     return xaccSplitGetParent(split) == txn ? 0 : 1;
 }
 
-static void add_quickfill_completions(TableLayout *layout, Transaction *trans,
-                                      Split *split, gboolean has_last_num)
+static void
+gnc_split_register_load_desc_cells (SplitRegister *reg)
 {
-    Split *s;
-    int i = 0;
-
-    gnc_quickfill_cell_add_completion(
-        (QuickFillCell *) gnc_table_layout_get_cell(layout, DESC_CELL),
-        xaccTransGetDescription(trans));
+    QofBook *book = gnc_get_current_book ();
+    TableLayout *layout = reg->table->layout;
 
-    gnc_quickfill_cell_add_completion(
-        (QuickFillCell *) gnc_table_layout_get_cell(layout, NOTES_CELL),
-        xaccTransGetNotes(trans));
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, DESC_CELL),
+        gnc_get_shared_trans_quickfill (book, GNC_TRANS_QF_DESCRIPTION));
 
-    if (!has_last_num)
-        gnc_num_cell_set_last_num(
-            (NumCell *) gnc_table_layout_get_cell(layout, NUM_CELL),
-            gnc_get_num_action(trans, split));
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, NOTES_CELL),
+        gnc_get_shared_trans_quickfill (book, GNC_TRANS_QF_NOTES));
 
-    while ((s = xaccTransGetSplit(trans, i)) != NULL)
-    {
-        gnc_quickfill_cell_add_completion(
-            (QuickFillCell *) gnc_table_layout_get_cell(layout, MEMO_CELL),
-            xaccSplitGetMemo(s));
-        i++;
-    }
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell *) gnc_table_layout_get_cell (layout, MEMO_CELL),
+        gnc_get_shared_trans_quickfill (book, GNC_TRANS_QF_MEMO));
 }
 
 static Split*
@@ -325,6 +317,68 @@ change_account_separator (SRInfo *info, Table *table, SplitRegister *reg)
 	gnc_split_register_recn_cell_confirm, reg);
 }
 
+/* TRUE if the register shows a running balance for its default
+ * account, e.g. an "Open SubAccounts" ledger. The balance of a row is
+ * summed from the first row of the register, see
+ * gnc_split_register_get_rbaln(). */
+static gboolean
+register_has_running_balance (SplitRegister *reg)
+{
+    CellBlock *cursor;
+
+    if (!gnc_split_register_get_default_account (reg))
+        return FALSE;
+
+    cursor = gnc_table_layout_get_cursor (reg->table->layout,
+                                          CURSOR_SINGLE_LEDGER);
+    return cursor &&
+           gnc_cellblock_get_cell_by_name (cursor, RBALN_CELL, NULL, NULL);
+}
+
+/* Returns the node of slist from which splits are loaded into the
+ * register. Registers whose balances depend on the earlier rows, and
+ * the transaction the cursor is going to, keep all of the list. */
+static GList *
+load_window_start (SplitRegister *reg, GList *slist,
+                   Transaction *find_trans, Transaction *pending_trans)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+    GList *start, *node;
+    guint length;
+
+    info->load_window_partial = FALSE;
+
+    if (info->load_window <= 0)
+        return slist;
+
+    if (reg->type >= NUM_SINGLE_REGISTER_TYPES &&
+            reg->type != GENERAL_JOURNAL)
+        return slist;
+
+    if (register_has_running_balance (reg))
+        return slist;
+
+    /* The newest splits are at the start of a reversed list. */
+    if (info->sort_reversed)
+        return slist;
+
+    length = g_list_length (slist);
+    if (length <= (guint) info->load_window)
+        return slist;
+
+    start = g_list_nth (slist, length - info->load_window);
+    for (node = slist; node != start; node = node->next)
+    {
+        Transaction *trans = xaccSplitGetParent (node->data);
+
+        if (trans && (trans == find_trans || trans == pending_trans))
+            break;
+    }
+
+    info->load_window_partial = (node != slist);
+    return node;
+}
+
 static void
 update_info (SRInfo *info, SplitRegister *reg)
 {
@@ -362,9 +416,11 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     Split *find_split;
     Split *split;
     Table *table;
+    GList *window_start;
     GList *node;
 
     gboolean start_primary_color = TRUE;
+    gboolean in_window;
     gboolean found_pending = FALSE;
     gboolean need_divider_upper = FALSE;
     gboolean found_divider_upper = FALSE;
@@ -509,6 +565,7 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
 
         /* load up account names into the transfer combobox menus */
         gnc_split_register_load_xfer_cells (reg, default_account);
+        gnc_split_register_load_desc_cells (reg);
         gnc_split_register_load_associate_cells (reg);
         gnc_split_register_load_recn_cells (reg);
         gnc_split_register_load_type_cells (reg);
@@ -549,12 +606,19 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     if (multi_line)
         trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
 
+    /* A large register only loads the rows at the end of the list. */
+    window_start = load_window_start (reg, slist, find_trans, pending_trans);
+    in_window = (window_start == slist);
+
     /* populate the table */
     for (node = slist; node; node = node->next)
     {
         split = node->data;
         trans = xaccSplitGetParent (split);
 
+        if (node == window_start)
+            in_window = TRUE;
+
         if (!xaccTransStillHasSplit(trans, split))
             continue;
 
@@ -573,6 +637,12 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
         if (trans == blank_trans)
             continue;
 
+        /* A transaction is only marked as loaded by a split in the
+         * window, so one with splits on both sides of its start is
+         * still loaded. */
+        if (!in_window)
+            continue;
+
         if (multi_line)
         {
             /* Skip this split if its transaction has already been loaded. */
@@ -638,10 +708,12 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
             }
         }
 
-        /* If this is the first load of the register,
-         * fill up the quickfill cells. */
-        if (info->first_pass)
-            add_quickfill_completions(reg->table->layout, trans, split, has_last_num);
+        /* If this is the first load of the register and the account
+         * doesn't know its last number, take it from the splits. */
+        if (info->first_pass && !has_last_num)
+            gnc_num_cell_set_last_num (
+                (NumCell *) gnc_table_layout_get_cell (table->layout, NUM_CELL),
+                gnc_get_num_action (trans, split));
 
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
@@ -789,6 +861,203 @@ gnc_split_register_load (SplitRegister *reg, GList * slist,
     LEAVE(" ");
 }
 
+/* Checks that the rows below the lead row of trans at lead_row still
+ * hold its splits, followed by the empty split row. */
+static gboolean
+trans_rows_match (Table *table, CellBlock *split_cursor, Transaction *trans,
+                  int lead_row)
+{
+    QofBook *book = gnc_get_current_book ();
+    VirtualCellLocation vcell_loc = { lead_row + 1, 0 };
+    VirtualCell *vcell;
+    GList *node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (!xaccTransStillHasSplit (trans, split))
+            continue;
+
+        vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+        if (!vcell || vcell->cellblock != split_cursor ||
+                xaccSplitLookup (vcell->vcell_data, book) != split)
+            return FALSE;
+
+        vcell_loc.virt_row++;
+    }
+
+    vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    return (vcell && vcell->cellblock == split_cursor &&
+            xaccSplitLookup (vcell->vcell_data, book) == NULL);
+}
+
+/* Checks that trans, at lead_row, is still on the same side of the
+ * dividers the last load put in. */
+static gboolean
+trans_dividers_match (SplitRegister *reg, Transaction *trans, int lead_row)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+    TableModel *model = reg->table->model;
+    time64 date = xaccTransGetDate (trans);
+    QofBook *book = gnc_get_current_book ();
+    gboolean after_divider;
+
+    if (!info->show_present_divider)
+        return TRUE;
+
+    after_divider = model->dividing_row >= 0 && lead_row >= model->dividing_row;
+    if (after_divider != (date > gnc_time64_get_today_end ()))
+        return FALSE;
+
+    if (qof_book_uses_autoreadonly (book))
+    {
+        GDate *d = qof_book_get_autoreadonly_gdate (book);
+        time64 autoreadonly_time = d ? gdate_to_time64 (*d) : 0;
+
+        g_date_free (d);
+        after_divider = (model->dividing_row_upper >= 0 &&
+                         lead_row >= model->dividing_row_upper);
+        if (after_divider != (date >= autoreadonly_time))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+gboolean
+gnc_split_register_redraw_transactions (SplitRegister *reg,
+                                        GList *transactions)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+    QofBook *book = gnc_get_current_book ();
+    GHashTable *changed;
+    CellBlock *split_cursor;
+    Transaction *pending_trans;
+    Transaction *blank_trans;
+    Transaction *current_trans;
+    GList *rows = NULL;
+    GList *node;
+    Table *table;
+    int v_row;
+
+    g_return_val_if_fail (info, FALSE);
+
+    table = reg->table;
+
+    if (!info->reg_loaded || gnc_table_current_cursor_changed (table, FALSE))
+        return FALSE;
+
+    pending_trans = xaccTransLookup (&info->pending_trans_guid, book);
+    blank_trans = xaccSplitGetParent (xaccSplitLookup (&info->blank_split_guid,
+                                                       book));
+    current_trans = gnc_split_register_get_current_trans (reg);
+
+    changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (node = transactions; node; node = node->next)
+    {
+        Transaction *trans = node->data;
+
+        /* The loader takes care of the transactions being edited. */
+        if (trans == pending_trans || trans == blank_trans ||
+                trans == current_trans)
+        {
+            g_hash_table_destroy (changed);
+            return FALSE;
+        }
+        g_hash_table_insert (changed, trans, trans);
+    }
+
+    split_cursor = gnc_table_layout_get_cursor (table->layout, CURSOR_SPLIT);
+
+    for (v_row = 1; v_row < table->num_virt_rows; v_row++)
+    {
+        VirtualCellLocation vcell_loc = { v_row, 0 };
+        VirtualCell *vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+        Transaction *trans;
+        Split *split;
+
+        if (!vcell || vcell->cellblock == split_cursor)
+            continue;
+
+        split = xaccSplitLookup (vcell->vcell_data, book);
+        trans = xaccSplitGetParent (split);
+        if (!trans || !g_hash_table_lookup (changed, trans))
+            continue;
+
+        if (!trans_rows_match (table, split_cursor, trans, v_row) ||
+                !trans_dividers_match (reg, trans, v_row))
+        {
+            g_list_free (rows);
+            g_hash_table_destroy (changed);
+            return FALSE;
+        }
+
+        rows = g_list_prepend (rows, GINT_TO_POINTER (v_row));
+    }
+    g_hash_table_destroy (changed);
+
+    DEBUG("redrawing %d changed transactions", g_list_length (rows));
+
+    for (node = rows; node; node = node->next)
+    {
+        VirtualCellLocation vcell_loc = { GPOINTER_TO_INT (node->data), 0 };
+
+        gnc_table_refresh_cursor_gui (table, vcell_loc, FALSE);
+    }
+    g_list_free (rows);
+
+    /* The balances of the rows below them may have changed too. */
+    gnc_table_redraw_gui (table);
+
+    return TRUE;
+}
+
+void
+gnc_split_register_set_load_window (SplitRegister *reg, gint num_splits)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    g_return_if_fail (info);
+
+    info->load_window = MAX (num_splits, 0);
+}
+
+void
+gnc_split_register_set_sort_reversed (SplitRegister *reg, gboolean reversed)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    g_return_if_fail (info);
+
+    info->sort_reversed = reversed;
+}
+
+gboolean
+gnc_split_register_extend_load_window (SplitRegister *reg)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    g_return_val_if_fail (info, FALSE);
+
+    if (!info->load_window_partial)
+        return FALSE;
+
+    info->load_window *= 2;
+    return TRUE;
+}
+
+gboolean
+gnc_split_register_clear_load_window (SplitRegister *reg)
+{
+    SRInfo *info = gnc_split_register_get_info (reg);
+
+    g_return_val_if_fail (info, FALSE);
+
+    info->load_window = 0;
+    return info->load_window_partial;
+}
+
 /* ===================================================================== */
 
 #define QKEY  "split_reg_shared_quickfill"
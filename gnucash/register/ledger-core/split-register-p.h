@@ -133,6 +133,17 @@ struct sr_info
 
     /** true if the account separator has changed */
     gboolean separator_changed;
+
+    /** The number of splits at the end of the list which are loaded,
+     * or 0 to load all of them */
+    gint load_window;
+
+    /** true if the last load left out the splits before the window */
+    gboolean load_window_partial;
+
+    /** true if the splits are loaded newest first, which the window
+     * doesn't handle */
+    gboolean sort_reversed;
 };
 
 
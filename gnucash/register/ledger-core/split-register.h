@@ -502,6 +502,65 @@ void gnc_split_register_cancel_cursor_trans_changes (SplitRegister *reg);
 void gnc_split_register_load (SplitRegister *reg, GList * slist,
                               Account *default_account);
 
+/** Redraws the rows of transactions that have changed since the
+ *  register was loaded, without loading it again. That can only be done
+ *  if the register would be loaded with the same splits in the same
+ *  order, which the caller checks, and if the transactions still fit
+ *  their rows, which this function checks.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param transactions the changed transactions; those not in the
+ *  register are ignored
+ *
+ *  @return FALSE if the register has to be loaded again
+ */
+gboolean gnc_split_register_redraw_transactions (SplitRegister *reg,
+                                                 GList *transactions);
+
+/** Makes gnc_split_register_load() load only the last @a num_splits
+ *  splits of the list, or all of them if @a num_splits is 0. The
+ *  transaction the cursor is to go to is always loaded. The window is
+ *  ignored by registers whose balances depend on the rows before it;
+ *  only single account registers and a general journal without a
+ *  running balance use it.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param num_splits the number of splits to load
+ */
+void gnc_split_register_set_load_window (SplitRegister *reg, gint num_splits);
+
+/** Tells the register that the list of splits it loads is sorted in
+ *  reverse order, newest first. Such a register ignores the load
+ *  window, which keeps the end of the list.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param reversed TRUE if the sort order is reversed
+ */
+void gnc_split_register_set_sort_reversed (SplitRegister *reg,
+                                           gboolean reversed);
+
+/** If the last load of the register left out some splits, doubles the
+ *  load window so the next load has more of them.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @return TRUE if the window was extended and the register should be
+ *  reloaded
+ */
+gboolean gnc_split_register_extend_load_window (SplitRegister *reg);
+
+/** Makes the register load all of its splits from now on.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @return TRUE if the last load left out some splits and the register
+ *  should be reloaded
+ */
+gboolean gnc_split_register_clear_load_window (SplitRegister *reg);
+
 /** Copy the contents of the current cursor to a split. The split and
  *    transaction that are updated are the ones associated with the
  *    current cursor (register entry) position. If the do_commit flag
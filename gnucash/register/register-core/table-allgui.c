@@ -583,6 +583,17 @@ gnc_table_save_cells (Table *table, gpointer save_data)
         save_handler (save_data, table->model->handler_user_data);
 }
 
+gboolean
+gnc_table_load_more (Table *table)
+{
+    g_return_val_if_fail (table, FALSE);
+
+    if (!table->model->load_more_handler)
+        return FALSE;
+
+    return table->model->load_more_handler (table->model->load_more_data);
+}
+
 void
 gnc_table_set_size (Table * table, int virt_rows, int virt_cols)
 {
@@ -269,6 +269,11 @@ gboolean       gnc_table_get_cell_location (Table *table,
 
 void           gnc_table_save_cells (Table *table, gpointer save_data);
 
+/** Ask the model to load the rows before the first one, if the table
+ *  only holds the last part of its data.  Returns TRUE if rows were
+ *  added. */
+gboolean       gnc_table_load_more (Table *table);
+
 
 /** Return the virtual cell of the header */
 VirtualCell *  gnc_table_get_header_cell (Table *table);
@@ -342,6 +347,10 @@ void        gnc_table_refresh_current_cursor_gui (Table * table,
 /** Refresh the whole GUI from the table. */
 void        gnc_table_refresh_gui (Table *table, gboolean do_scroll);
 
+/** Redraw the whole GUI without refreshing it from the table, for when
+ *  only the contents of cells have changed. */
+void        gnc_table_redraw_gui (Table *table);
+
 /** Try to show the whole range in the register. */
 void        gnc_table_show_range (Table *table,
                                   VirtualCellLocation start_loc,
@@ -518,6 +518,18 @@ gnc_table_model_get_save_handler
     return gnc_table_model_handler_hash_lookup (model->save_handlers, cell_name);
 }
 
+void
+gnc_table_model_set_load_more_handler
+(TableModel *model,
+ TableLoadMoreHandler load_more_handler,
+ gpointer user_data)
+{
+    g_return_if_fail (model != NULL);
+
+    model->load_more_handler = load_more_handler;
+    model->load_more_data = user_data;
+}
+
 TableSaveHandler
 gnc_table_model_get_pre_save_handler
 (TableModel *model)
@@ -97,6 +97,10 @@ typedef void (*TableSaveCellHandler) (BasicCell * cell,
 typedef void (*TableSaveHandler) (gpointer save_data,
                                   gpointer user_data);
 
+/* Loads the rows before the first one of a table that only holds part
+ * of its data. Returns TRUE if rows were added. */
+typedef gboolean (*TableLoadMoreHandler) (gpointer user_data);
+
 typedef gpointer (*VirtCellDataAllocator)   (void);
 typedef void     (*VirtCellDataDeallocator) (gpointer cell_data);
 typedef void     (*VirtCellDataCopy)        (gpointer to, gconstpointer from);
@@ -118,6 +122,9 @@ typedef struct
 
     gpointer handler_user_data;
 
+    TableLoadMoreHandler load_more_handler;
+    gpointer load_more_data;
+
     /* If true, denotes that this table is read-only
      * and edits should not be allowed. */
     gboolean read_only;
@@ -250,5 +257,10 @@ TableSaveHandler gnc_table_model_get_pre_save_handler
 (TableModel *model);
 TableSaveHandler gnc_table_model_get_post_save_handler
 (TableModel *model);
+
+void gnc_table_model_set_load_more_handler
+(TableModel *model,
+ TableLoadMoreHandler load_more_handler,
+ gpointer user_data);
 /** @} */
 #endif
@@ -698,11 +698,64 @@ gnucash_sheet_update_adjustments (GnucashSheet *sheet)
 }
 
 
+static gboolean
+gnucash_sheet_load_more_idle (GnucashSheet *sheet)
+{
+    VirtualCellLocation vcell_loc = { 1, 0 };
+    SheetBlock *block;
+    gint old_rows;
+
+    sheet->load_more_idle = 0;
+
+    if (gtk_adjustment_get_value (sheet->vadj) >
+            gtk_adjustment_get_lower (sheet->vadj))
+        return FALSE;
+
+    old_rows = sheet->table->num_virt_rows;
+    if (!gnc_table_load_more (sheet->table))
+        return FALSE;
+
+    /* Keep the row that was at the top of the view there. */
+    vcell_loc.virt_row += sheet->table->num_virt_rows - old_rows;
+    block = gnucash_sheet_get_block (sheet, vcell_loc);
+    if (block)
+        gtk_adjustment_set_value (sheet->vadj, block->origin_y);
+
+    return FALSE;
+}
+
+/* A windowed table only holds its last rows; when the view reaches the
+ * top, the earlier ones are asked for.  That reloads the table, so it's
+ * done from an idle handler. */
+static void
+gnucash_sheet_check_load_more (GnucashSheet *sheet)
+{
+    if (sheet->load_more_idle || !sheet->table ||
+            !sheet->table->model->load_more_handler)
+        return;
+
+    if (gtk_adjustment_get_value (sheet->vadj) >
+            gtk_adjustment_get_lower (sheet->vadj))
+        return;
+
+    sheet->load_more_idle =
+        g_idle_add ((GSourceFunc) gnucash_sheet_load_more_idle, sheet);
+}
+
+void
+gnucash_sheet_cancel_load_more (GnucashSheet *sheet)
+{
+    if (sheet->load_more_idle)
+        g_source_remove (sheet->load_more_idle);
+    sheet->load_more_idle = 0;
+}
+
 static void
 gnucash_sheet_vadjustment_value_changed (GtkAdjustment *adj,
         GnucashSheet *sheet)
 {
     gnucash_sheet_compute_visible_range (sheet);
+    gnucash_sheet_check_load_more (sheet);
 }
 
 
@@ -772,6 +825,8 @@ gnucash_sheet_finalize (GObject *object)
 
     sheet = GNUCASH_SHEET (object);
 
+    gnucash_sheet_cancel_load_more (sheet);
+
     g_table_resize (sheet->blocks, 0, 0);
     g_table_destroy (sheet->blocks);
     sheet->blocks = NULL;
@@ -2512,6 +2567,8 @@ gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll)
 
     gnucash_sheet_cursor_set_from_table (sheet, do_scroll);
     gnucash_sheet_activate_cursor_cell (sheet, TRUE);
+
+    gnucash_sheet_check_load_more (sheet);
 }
 
 /*************************************************************/
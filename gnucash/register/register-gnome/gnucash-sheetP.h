@@ -96,6 +96,8 @@ struct _GnucashSheet
     GFunc moved_cb;
     gpointer moved_cb_data;
 
+    guint load_more_idle; /* loads earlier rows of a windowed table */
+
     /* IMContext */
     GtkIMContext *im_context;
     gint preedit_length; /** num of bytes */
@@ -129,6 +131,7 @@ GncItemEdit *gnucash_sheet_get_item_edit (GnucashSheet *sheet);
 void gnucash_sheet_set_popup (GnucashSheet *sheet, GtkWidget *popup, gpointer data);
 void gnucash_sheet_goto_virt_loc (GnucashSheet *sheet, VirtualLocation virt_loc);
 void gnucash_sheet_refresh_from_prefs (GnucashSheet *sheet);
+void gnucash_sheet_cancel_load_more (GnucashSheet *sheet);
 //Table       *gnucash_sheet_get_table (GnucashSheet *sheet);
 //gint         gnucash_sheet_get_num_virt_rows (GnucashSheet *sheet);
 //gint         gnucash_sheet_get_num_virt_cols (GnucashSheet *sheet);
@@ -144,6 +144,7 @@ table_destroy_cb (Table *table)
 
     sheet = GNUCASH_SHEET (table->ui_data);
 
+    gnucash_sheet_cancel_load_more (sheet);
     g_object_unref (sheet);
 
     table->ui_data = NULL;
@@ -184,6 +185,17 @@ gnc_table_refresh_gui (Table * table, gboolean do_scroll)
     gnucash_sheet_redraw_all (sheet);
 }
 
+void
+gnc_table_redraw_gui (Table *table)
+{
+    if (!table || !table->ui_data)
+        return;
+
+    g_return_if_fail (GNUCASH_IS_SHEET (table->ui_data));
+
+    gnucash_sheet_redraw_all (GNUCASH_SHEET (table->ui_data));
+}
+
 
 static void
 gnc_table_refresh_cursor_gnome (Table * table,
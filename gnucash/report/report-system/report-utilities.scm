@@ -457,6 +457,7 @@ flawed. see report-utilities.scm. please update reports.")
 ;;      dates-list (list of time64) - NOTE: IT WILL BE SORTED
 ;;      split->amount - an unary lambda. calling (split->amount split)
 ;;      returns a number, or #f which effectively skips the split.
+;;      defaults to the split amount.
 ;; out: (list bal0 bal1 ...), each entry is a gnc-monetary object
 ;;
 ;; NOTE a prior incarnation accepted a #:ignore-closing? boolean
@@ -464,16 +465,20 @@ flawed. see report-utilities.scm. please update reports.")
 ;; (and (not (xaccTransGetIsClosingTxn (xaccSplitGetParent s)))
 ;; (xaccSplitGetAmount s)))
 (define* (gnc:account-get-balances-at-dates
-          account dates-list #:key (split->amount xaccSplitGetAmount))
+          account dates-list #:key split->amount)
   (define (amount->monetary bal)
     (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
   (define balance 0)
   (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+       (if split->amount
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance))
+           ;; plain balances are computed by the engine in one pass
+           (car (gnc-account-list-get-balances-at-dates
+                 (list account) dates-list 0 #f)))))
 
 
 ;; this function will scan through account splitlist, building a list
@@ -540,12 +545,13 @@ flawed. see report-utilities.scm. please update reports.")
                         (if include-children?
                             (gnc-account-get-descendants account)
                             '()))))
+    ;; xaccAccountGetBalanceAsOfDate leaves out the splits at date,
+    ;; gnc-account-list-get-balances-at-dates includes them.
     (for-each
-     (lambda (acct)
-       (balance-collector 'add
-                          (xaccAccountGetCommodity acct)
-                          (xaccAccountGetBalanceAsOfDate acct date)))
-     accounts)
+     (lambda (acct balances)
+       (balance-collector 'add (xaccAccountGetCommodity acct) (car balances)))
+     accounts
+     (gnc-account-list-get-balances-at-dates accounts (list (1- date)) 0 #f))
     balance-collector))
 
 ;; Calculate the increase in the balance of the account in terms of
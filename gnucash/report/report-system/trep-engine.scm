@@ -129,6 +129,7 @@ in the Options panel."))
   ;; Defines the different sorting keys, as an association-list
   ;; together with the subtotal functions. Each entry:
   ;;  'sortkey             - sort parameter sent via qof-query
+  ;;  'native-key          - key the native engine compares splits by
   ;;  'split-sortvalue     - function retrieves number/string for comparing splits
   ;;  'text                - text displayed in Display tab
   ;;  'tip                 - tooltip displayed in Display tab
@@ -140,6 +141,7 @@ in the Options panel."))
   ;;
   (list (list 'account-name
               (cons 'sortkey (list SPLIT-ACCT-FULLNAME))
+              (cons 'native-key GNC-REPORT-KEY-ACCOUNT-NAME)
               (cons 'split-sortvalue
                     (compose gnc-account-get-full-name xaccSplitGetAccount))
               (cons 'text (_ "Account Name"))
@@ -148,6 +150,7 @@ in the Options panel."))
 
         (list 'account-code
               (cons 'sortkey (list SPLIT-ACCOUNT ACCOUNT-CODE-))
+              (cons 'native-key GNC-REPORT-KEY-ACCOUNT-CODE)
               (cons 'split-sortvalue (compose xaccAccountGetCode xaccSplitGetAccount))
               (cons 'text (_ "Account Code"))
               (cons 'tip (_ "Sort & subtotal by account code."))
@@ -155,6 +158,7 @@ in the Options panel."))
 
         (list 'date
               (cons 'sortkey (list SPLIT-TRANS TRANS-DATE-POSTED))
+              (cons 'native-key GNC-REPORT-KEY-DATE)
               (cons 'split-sortvalue (compose xaccTransGetDate xaccSplitGetParent))
               (cons 'text (_ "Date"))
               (cons 'tip (_ "Sort by date."))
@@ -162,6 +166,7 @@ in the Options panel."))
 
         (list 'reconciled-date
               (cons 'sortkey (list SPLIT-DATE-RECONCILED))
+              (cons 'native-key GNC-REPORT-KEY-RECONCILED-DATE)
               (cons 'split-sortvalue xaccSplitGetDateReconciled)
               (cons 'text (_ "Reconciled Date"))
               (cons 'tip (_ "Sort by the Reconciled Date."))
@@ -169,6 +174,7 @@ in the Options panel."))
 
         (list 'reconciled-status
               (cons 'sortkey #f)
+              (cons 'native-key GNC-REPORT-KEY-RECONCILED-STATUS)
               (cons 'split-sortvalue (lambda (s)
                                        (length (memv (xaccSplitGetReconcile s)
                                                      (map car reconcile-list)))))
@@ -180,6 +186,7 @@ in the Options panel."))
 
         (list 'register-order
               (cons 'sortkey (list QUERY-DEFAULT-SORT))
+              (cons 'native-key GNC-REPORT-KEY-NONE)
               (cons 'split-sortvalue #f)
               (cons 'text (_ "Register Order"))
               (cons 'tip (_ "Sort as in the register."))
@@ -187,6 +194,7 @@ in the Options panel."))
 
         (list 'corresponding-acc-name
               (cons 'sortkey (list SPLIT-CORR-ACCT-NAME))
+              (cons 'native-key GNC-REPORT-KEY-CORR-ACCOUNT-NAME)
               (cons 'split-sortvalue xaccSplitGetCorrAccountFullName)
               (cons 'text (_ "Other Account Name"))
               (cons 'tip (_ "Sort by account transferred from/to's name."))
@@ -194,6 +202,7 @@ in the Options panel."))
 
         (list 'corresponding-acc-code
               (cons 'sortkey (list SPLIT-CORR-ACCT-CODE))
+              (cons 'native-key GNC-REPORT-KEY-CORR-ACCOUNT-CODE)
               (cons 'split-sortvalue xaccSplitGetCorrAccountCode)
               (cons 'text (_ "Other Account Code"))
               (cons 'tip (_ "Sort by account transferred from/to's code."))
@@ -201,6 +210,7 @@ in the Options panel."))
 
         (list 'amount
               (cons 'sortkey (list SPLIT-VALUE))
+              (cons 'native-key GNC-REPORT-KEY-AMOUNT)
               (cons 'split-sortvalue xaccSplitGetValue)
               (cons 'text (_ "Amount"))
               (cons 'tip (_ "Sort by amount."))
@@ -208,6 +218,7 @@ in the Options panel."))
 
         (list 'description
               (cons 'sortkey (list SPLIT-TRANS TRANS-DESCRIPTION))
+              (cons 'native-key GNC-REPORT-KEY-DESCRIPTION)
               (cons 'split-sortvalue (compose xaccTransGetDescription
                                               xaccSplitGetParent))
               (cons 'text (_ "Description"))
@@ -217,6 +228,7 @@ in the Options panel."))
         (if split-action?
             (list 'number
                   (cons 'sortkey (list SPLIT-ACTION))
+                  (cons 'native-key GNC-REPORT-KEY-ACTION)
                   (cons 'split-sortvalue xaccSplitGetAction)
                   (cons 'text (_ "Number/Action"))
                   (cons 'tip (_ "Sort by check number/action."))
@@ -224,6 +236,7 @@ in the Options panel."))
 
             (list 'number
                   (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
+                  (cons 'native-key GNC-REPORT-KEY-NUMBER)
                   (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
                   (cons 'text (_ "Number"))
                   (cons 'tip (_ "Sort by check/transaction number."))
@@ -231,6 +244,7 @@ in the Options panel."))
 
         (list 't-number
               (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
+              (cons 'native-key GNC-REPORT-KEY-NUMBER)
               (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
               (cons 'text (_ "Transaction Number"))
               (cons 'tip (_ "Sort by transaction number."))
@@ -238,6 +252,7 @@ in the Options panel."))
 
         (list 'memo
               (cons 'sortkey (list SPLIT-MEMO))
+              (cons 'native-key GNC-REPORT-KEY-MEMO)
               (cons 'split-sortvalue xaccSplitGetMemo)
               (cons 'text (_ "Memo"))
               (cons 'tip (_ "Sort by memo."))
@@ -245,6 +260,7 @@ in the Options panel."))
 
         (list 'notes
               (cons 'sortkey #f)
+              (cons 'native-key GNC-REPORT-KEY-NOTES)
               (cons 'split-sortvalue (compose xaccTransGetNotes xaccSplitGetParent))
               (cons 'text (_ "Notes"))
               (cons 'tip (_ "Sort by transaction notes."))
@@ -252,6 +268,7 @@ in the Options panel."))
 
         (list 'none
               (cons 'sortkey '())
+              (cons 'native-key GNC-REPORT-KEY-NONE)
               (cons 'split-sortvalue #f)
               (cons 'text (_ "None"))
               (cons 'tip (_ "Do not sort."))
@@ -276,6 +293,7 @@ in the Options panel."))
 (define date-subtotal-list
   ;; List for date option.
   ;; Defines the different date sorting keys, as an association-list. Each entry:
+  ;;  'native-group        - period the native engine compares dates by
   ;;  'split-sortvalue     - func retrieves number/string used for comparing splits
   ;;  'text                - text displayed in Display tab
   ;;  'tip                 - tooltip displayed in Display tab
@@ -284,6 +302,7 @@ in the Options panel."))
   ;;         otherwise it converts split->string
   (list
    (list 'none
+         (cons 'native-group GNC-REPORT-DATE-NONE)
          (cons 'split-sortvalue #f)
          (cons 'date-sortvalue #f)
          (cons 'text (_ "None"))
@@ -291,6 +310,7 @@ in the Options panel."))
          (cons 'renderer-fn #f))
 
    (list 'daily
+         (cons 'native-group GNC-REPORT-DATE-DAY)
          (cons 'split-sortvalue (lambda (s) (time64-day (split->time64 s))))
          (cons 'date-sortvalue time64-day)
          (cons 'text (_ "Daily"))
@@ -298,6 +318,7 @@ in the Options panel."))
          (cons 'renderer-fn (lambda (s) (qof-print-date (split->time64 s)))))
 
    (list 'weekly
+         (cons 'native-group GNC-REPORT-DATE-WEEK)
          (cons 'split-sortvalue (lambda (s) (time64-week (split->time64 s))))
          (cons 'date-sortvalue time64-week)
          (cons 'text (_ "Weekly"))
@@ -307,6 +328,7 @@ in the Options panel."))
                                      split->time64)))
 
    (list 'monthly
+         (cons 'native-group GNC-REPORT-DATE-MONTH)
          (cons 'split-sortvalue (lambda (s) (time64-month (split->time64 s))))
          (cons 'date-sortvalue time64-month)
          (cons 'text (_ "Monthly"))
@@ -316,6 +338,7 @@ in the Options panel."))
                                      split->time64)))
 
    (list 'quarterly
+         (cons 'native-group GNC-REPORT-DATE-QUARTER)
          (cons 'split-sortvalue (lambda (s) (time64-quarter (split->time64 s))))
          (cons 'date-sortvalue time64-quarter)
          (cons 'text (_ "Quarterly"))
@@ -325,6 +348,7 @@ in the Options panel."))
                                      split->time64)))
 
    (list 'yearly
+         (cons 'native-group GNC-REPORT-DATE-YEAR)
          (cons 'split-sortvalue (lambda (s) (time64-year (split->time64 s))))
          (cons 'date-sortvalue time64-year)
          (cons 'text (_ "Yearly"))
@@ -336,14 +360,17 @@ in the Options panel."))
 (define filter-list
   (list
    (list 'none
+         (cons 'native-filter GNC-REPORT-ACCOUNTS-ANY)
          (cons 'text (_ "None"))
          (cons 'tip (_ "Do not do any filtering.")))
 
    (list 'include
+         (cons 'native-filter GNC-REPORT-ACCOUNTS-INCLUDE)
          (cons 'text (_ "Include Transactions to/from Filter Accounts"))
          (cons 'tip (_ "Include transactions to/from filter accounts only.")))
 
    (list 'exclude
+         (cons 'native-filter GNC-REPORT-ACCOUNTS-EXCLUDE)
          (cons 'text (_ "Exclude Transactions to/from Filter Accounts"))
          (cons 'tip (_ "Exclude transactions to/from all filter accounts.")))))
 
@@ -1028,6 +1055,14 @@ be excluded from periodic reporting.")
   (gnc:register-trep-option
    (gnc:make-internal-option "__trep" "unique-transactions" #f))
 
+  ;; this hidden option selects whether the splits are filtered,
+  ;; sorted and grouped for subtotals by the native engine (see
+  ;; gnc-report-splits.h) or in scheme. The scheme code is still used
+  ;; for regex transaction filters. It can be disabled in a derived
+  ;; report.
+  (gnc:register-trep-option
+   (gnc:make-internal-option "__trep" "native-engine" #t))
+
   (gnc:options-set-default-section options gnc:pagename-general)
   options)
 
@@ -1035,7 +1070,10 @@ be excluded from periodic reporting.")
 ;; Here comes the big function that builds the whole table.
 
 (define (make-split-table splits options custom-calculated-cells
-                          begindate)
+                          begindate split-groups)
+  ;; split-groups is #f, or the lists of the splits' primary and
+  ;; secondary subtotal groups from the native engine. Splits with the
+  ;; same group number have the same subtotal-comparator value.
 
   (define (opt-val section name)
     (let ((option (gnc:lookup-option options section name)))
@@ -1685,6 +1723,14 @@ be excluded from periodic reporting.")
     (define primary-subtotal-comparator (primary-get-info 'split-sortvalue))
     (define secondary-subtotal-comparator (secondary-get-info 'split-sortvalue))
 
+    ;; whether the subtotal group changes after the current split;
+    ;; groups are the group numbers from the current split onwards.
+    (define (new-group? comparator groups current next)
+      (or (not next)
+          (if groups
+              (not (= (car groups) (cadr groups)))
+              (not (equal? (comparator current) (comparator next))))))
+
     (gnc:html-table-set-col-headers!
      table (concatenate (list
                          (gnc:html-make-empty-cells indent-level)
@@ -1700,6 +1746,8 @@ be excluded from periodic reporting.")
                       def:secondary-subtotal-style (car splits) 'secondary))
 
     (let loop ((splits splits)
+               (primary-groups (and split-groups (car split-groups)))
+               (secondary-groups (and split-groups (cadr split-groups)))
                (odd-row? #t)
                (work-done 0))
 
@@ -1753,9 +1801,8 @@ be excluded from periodic reporting.")
 
             (cond
              ((and primary-subtotal-comparator
-                   (or (not next)
-                       (not (equal? (primary-subtotal-comparator current)
-                                    (primary-subtotal-comparator next)))))
+                   (new-group? primary-subtotal-comparator primary-groups
+                               current next))
               (when secondary-subtotal-comparator
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
@@ -1792,9 +1839,8 @@ be excluded from periodic reporting.")
 
              (else
               (when (and secondary-subtotal-comparator
-                         (or (not next)
-                             (not (equal? (secondary-subtotal-comparator current)
-                                          (secondary-subtotal-comparator next)))))
+                         (new-group? secondary-subtotal-comparator
+                                     secondary-groups current next))
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
                                   secondary-subtotal-collectors
@@ -1814,7 +1860,10 @@ be excluded from periodic reporting.")
                   (add-subheading (render-summary next 'secondary #t)
                                   def:secondary-subtotal-style next 'secondary)))))
 
-            (loop rest (not odd-row?) (1+ work-done)))))
+            (loop rest
+                  (and primary-groups (cdr primary-groups))
+                  (and secondary-groups (cdr secondary-groups))
+                  (not odd-row?) (1+ work-done)))))
 
     (let ((csvlist (cond
                     ((any (lambda (cell) (vector-ref cell 4)) calculated-cells)
@@ -2011,6 +2060,7 @@ be excluded from periodic reporting.")
                          (opt-val pagename-filter optname-closing-transactions)
                          'closing-match))
          (splits '())
+         (split-groups #f)
          (custom-sort? (or (and (memq primary-key DATE-SORTING-TYPES)
                                 (not (eq? primary-date-subtotal 'none)))
                            (and (memq secondary-key DATE-SORTING-TYPES)
@@ -2029,6 +2079,9 @@ be excluded from periodic reporting.")
                    (if transaction-matcher-regexp
                        (regexp-exec transaction-matcher-regexp str)
                        (string-contains str transaction-matcher))))
+         ;; the native engine matches substrings only
+         (native-engine? (and (opt-val "__trep" "native-engine")
+                              (not transaction-matcher-regexp)))
          (query (qof-query-create-for-splits)))
 
     (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
@@ -2074,6 +2127,24 @@ be excluded from periodic reporting.")
           (match? (xaccTransGetNotes (xaccSplitGetParent split)))
           (match? (xaccSplitGetMemo split))))
 
+    ;; include/exclude using split->date according to date options,
+    ;; and custom-split-filter, a split->bool function for derived reports
+    (define (split-date-match split)
+      (or (not split->date)
+          (let ((date (split->date split)))
+            (if date
+                (<= begindate date enddate)
+                split->date-include-false?))))
+
+    (define (custom-split-match split)
+      (or (not custom-split-filter)
+          (custom-split-filter split)))
+
+    (define (native-sort-level sortkey date-subtotal-key order)
+      (list (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION) sortkey 'native-key)
+            (keylist-get-info date-subtotal-list date-subtotal-key 'native-group)
+            (eq? order 'ascend)))
+
     (cond
      ((or (null? c_account_1)
           (symbol? account-matcher-regexp)
@@ -2134,26 +2205,42 @@ be excluded from periodic reporting.")
          query (eq? primary-order 'ascend) (eq? secondary-order 'ascend)
          #t))
 
-      (if (opt-val "__trep" "unique-transactions")
-          (set! splits (xaccQueryGetSplitsUniqueTrans query))
-          (set! splits (qof-query-run query)))
-
-      (qof-query-destroy query)
+      (cond
+       (native-engine?
+        ;; The native engine runs the query, applies the same
+        ;; combined filter and custom sort as the scheme code, and
+        ;; groups the splits for the subtotals.
+        (let ((rows (gnc-report-splits-from-query
+                     query (opt-val "__trep" "unique-transactions")
+                     c_account_2
+                     (keylist-get-info filter-list filter-mode 'native-filter)
+                     transaction-matcher transaction-filter-exclude?
+                     (and (or split->date custom-split-filter)
+                          (lambda (split)
+                            (and (split-date-match split)
+                                 (custom-split-match split))))
+                     (native-sort-level primary-key primary-date-subtotal
+                                        primary-order)
+                     (native-sort-level secondary-key secondary-date-subtotal
+                                        secondary-order)
+                     custom-sort?)))
+          (set! splits (car rows))
+          (set! split-groups (cdr rows))))
 
-      ;; Combined Filter:
-      ;; - include/exclude using split->date according to date options
-      ;; - include/exclude splits to/from selected accounts
-      ;; - substring/regex matcher for Transaction Description/Notes/Memo
-      ;; - custom-split-filter, a split->bool function for derived reports
-      (set! splits
-        (filter
-         (lambda (split)
-           (let* ((trans (xaccSplitGetParent split)))
-             (and (or (not split->date)
-                      (let ((date (split->date split)))
-                        (if date
-                            (<= begindate date enddate)
-                            split->date-include-false?)))
+       (else
+        (if (opt-val "__trep" "unique-transactions")
+            (set! splits (xaccQueryGetSplitsUniqueTrans query))
+            (set! splits (qof-query-run query)))
+
+        ;; Combined Filter:
+        ;; - include/exclude using split->date according to date options
+        ;; - include/exclude splits to/from selected accounts
+        ;; - substring/regex matcher for Transaction Description/Notes/Memo
+        ;; - custom-split-filter, a split->bool function for derived reports
+        (set! splits
+          (filter
+           (lambda (split)
+             (and (split-date-match split)
                   (case filter-mode
                     ((none) #t)
                     ((include) (is-filter-member split c_account_2))
@@ -2162,14 +2249,15 @@ be excluded from periodic reporting.")
                       (if transaction-filter-exclude?
                           (not (transaction-filter-match split))
                           (transaction-filter-match split)))
-                  (or (not custom-split-filter)
-                      (custom-split-filter split)))))
-         splits))
+                  (custom-split-match split)))
+           splits))
+
+        (when custom-sort?
+          (set! splits (stable-sort! splits date-comparator?))
+          (set! splits (stable-sort! splits secondary-comparator?))
+          (set! splits (stable-sort! splits primary-comparator?)))))
 
-      (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+      (qof-query-destroy query)
 
       (cond
        ((null? splits)
@@ -2188,7 +2276,7 @@ be excluded from periodic reporting.")
        (else
         (let-values (((table grid csvlist)
                       (make-split-table splits options custom-calculated-cells
-                                        begindate)))
+                                        begindate split-groups)))
 
           (gnc:html-document-set-title! document report-title)
 
@@ -32,20 +32,39 @@
 #include "gnc-ui-util.h"
 
 
+/* A text held by the nodes of one tree. Each distinct string is stored
+ * once per tree, however many nodes it is the best match of. */
+typedef struct
+{
+    guint refs;          /* number of nodes holding the text   */
+    int len;             /* number of chars in the string      */
+    char str[1];         /* the string itself                  */
+} QuickFillText;
+
+/* A node of the tree. A node without children whose text is longer
+ * than the node is deep stands for the chain of nodes leading to the
+ * end of its text, which is the only string below it. The chain is
+ * only built as far as a lookup or an insertion of another string
+ * needs it, which saves most of the nodes of a tree. */
 struct _QuickFill
 {
-    char *text;          /* the first matching text string     */
-    int len;             /* number of chars in text string     */
-    GHashTable *matches; /* array of children in the tree      */
+    QuickFillText *text; /* the first matching text string     */
+    int depth;           /* number of chars leading to the node */
+    gunichar key;        /* the upper case char leading to it  */
+    guint num_matches;
+    QuickFill **matches; /* the children, sorted by key        */
+    GHashTable *texts;   /* the root's texts, by string        */
 };
 
 
 /** PROTOTYPES ******************************************************/
-static void quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
-                                        const char* next_char, QuickFillSort sort);
+static void quickfill_insert_recursive (QuickFill *root, QuickFill *qf,
+                                        QuickFillText *text,
+                                        const char *next_char,
+                                        QuickFillSort sort);
 
-static void gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
-        gint depth, QuickFillSort sort);
+static void gnc_quickfill_remove_recursive (QuickFill *root, QuickFill *qf,
+        const gchar *text, const gchar *next_char, QuickFillSort sort);
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_REGISTER;
@@ -53,6 +72,150 @@ static QofLogModule log_module = GNC_MOD_REGISTER;
 /********************************************************************\
 \********************************************************************/
 
+static QuickFillText *
+quickfill_text_intern (QuickFill *root, const char *str)
+{
+    QuickFillText *text = g_hash_table_lookup (root->texts, str);
+    gsize size;
+
+    if (text)
+        return text;
+
+    size = strlen (str);
+    text = g_malloc (G_STRUCT_OFFSET (QuickFillText, str) + size + 1);
+    text->refs = 0;
+    text->len = g_utf8_strlen (str, size);
+    memcpy (text->str, str, size + 1);
+    g_hash_table_insert (root->texts, text->str, text);
+
+    return text;
+}
+
+static void
+quickfill_text_unref (QuickFill *root, QuickFillText *text)
+{
+    if (text == NULL || --text->refs > 0)
+        return;
+
+    g_hash_table_remove (root->texts, text->str);
+    g_free (text);
+}
+
+static void
+quickfill_set_text (QuickFill *root, QuickFill *qf, QuickFillText *text)
+{
+    QuickFillText *old_text = qf->text;
+
+    if (text)
+        text->refs++;
+    qf->text = text;
+    quickfill_text_unref (root, old_text);
+}
+
+/********************************************************************\
+\********************************************************************/
+
+static QuickFill *
+quickfill_node_new (int depth, gunichar key, QuickFillText *text)
+{
+    QuickFill *qf = g_new (QuickFill, 1);
+
+    qf->text = text;
+    if (text)
+        text->refs++;
+    qf->depth = depth;
+    qf->key = key;
+    qf->num_matches = 0;
+    qf->matches = NULL;
+    qf->texts = NULL;
+
+    return qf;
+}
+
+static void
+quickfill_node_free (QuickFill *root, QuickFill *qf)
+{
+    guint i;
+
+    for (i = 0; i < qf->num_matches; i++)
+        quickfill_node_free (root, qf->matches[i]);
+    g_free (qf->matches);
+
+    quickfill_text_unref (root, qf->text);
+    g_free (qf);
+}
+
+/* Finds the child of qf for key. If there's none, *index is set to
+ * where it would go. */
+static QuickFill *
+quickfill_find_match (QuickFill *qf, guint key, guint *index)
+{
+    guint low = 0, high = qf->num_matches;
+
+    while (low < high)
+    {
+        guint mid = (low + high) / 2;
+        guint mid_key = qf->matches[mid]->key;
+
+        if (mid_key == key)
+        {
+            if (index)
+                *index = mid;
+            return qf->matches[mid];
+        }
+        if (mid_key < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (index)
+        *index = low;
+    return NULL;
+}
+
+static QuickFill *
+quickfill_add_match (QuickFill *qf, guint index, guint key,
+                     QuickFillText *text)
+{
+    QuickFill *match_qf = quickfill_node_new (qf->depth + 1, key, text);
+
+    qf->matches = g_renew (QuickFill *, qf->matches, qf->num_matches + 1);
+    memmove (qf->matches + index + 1, qf->matches + index,
+             (qf->num_matches - index) * sizeof (QuickFill *));
+    qf->matches[index] = match_qf;
+    qf->num_matches++;
+
+    return match_qf;
+}
+
+static void
+quickfill_remove_match (QuickFill *qf, guint index)
+{
+    qf->num_matches--;
+    memmove (qf->matches + index, qf->matches + index + 1,
+             (qf->num_matches - index) * sizeof (QuickFill *));
+}
+
+/* If qf stands for the rest of its text, gives it the child for the
+ * next char of the text. */
+static void
+quickfill_expand_tail (QuickFill *qf)
+{
+    const char *next_char;
+    guint key;
+
+    if (qf->num_matches > 0 || qf->text == NULL || qf->depth >= qf->text->len)
+        return;
+
+    next_char = g_utf8_offset_to_pointer (qf->text->str, qf->depth);
+    key = g_unichar_toupper (g_utf8_get_char (next_char));
+    quickfill_add_match (qf, 0, key, qf->text);
+}
+
+/********************************************************************\
+\********************************************************************/
+
 QuickFill *
 gnc_quickfill_new (void)
 {
@@ -64,12 +227,8 @@ gnc_quickfill_new (void)
         return NULL;
     }
 
-    qf = g_new (QuickFill, 1);
-
-    qf->text = NULL;
-    qf->len = 0;
-
-    qf->matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qf = quickfill_node_new (0, 0, NULL);
+    qf->texts = g_hash_table_new (g_str_hash, g_str_equal);
 
     return qf;
 }
@@ -77,43 +236,36 @@ gnc_quickfill_new (void)
 /********************************************************************\
 \********************************************************************/
 
-static gboolean
-destroy_helper (gpointer key, gpointer value, gpointer data)
-{
-    gnc_quickfill_destroy (value);
-    return TRUE;
-}
-
 void
 gnc_quickfill_destroy (QuickFill *qf)
 {
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach (qf->matches, (GHFunc)destroy_helper, NULL);
-    g_hash_table_destroy (qf->matches);
-    qf->matches = NULL;
-
-    if (qf->text)
-        g_free(qf->text);
-    qf->text = NULL;
-    qf->len = 0;
+    g_return_if_fail (qf->texts != NULL);
 
+    gnc_quickfill_purge (qf);
+    g_hash_table_destroy (qf->texts);
     g_free (qf);
 }
 
 void
 gnc_quickfill_purge (QuickFill *qf)
 {
+    guint i;
+
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach_remove (qf->matches, destroy_helper, NULL);
+    g_return_if_fail (qf->texts != NULL);
 
-    if (qf->text)
-        g_free (qf->text);
-    qf->text = NULL;
-    qf->len = 0;
+    for (i = 0; i < qf->num_matches; i++)
+        quickfill_node_free (qf, qf->matches[i]);
+    g_free (qf->matches);
+    qf->matches = NULL;
+    qf->num_matches = 0;
+
+    quickfill_set_text (qf, qf, NULL);
 }
 
 /********************************************************************\
@@ -122,10 +274,10 @@ gnc_quickfill_purge (QuickFill *qf)
 const char *
 gnc_quickfill_string (QuickFill *qf)
 {
-    if (qf == NULL)
+    if (qf == NULL || qf->text == NULL)
         return NULL;
 
-    return qf->text;
+    return qf->text->str;
 }
 
 /********************************************************************\
@@ -140,7 +292,8 @@ gnc_quickfill_get_char_match (QuickFill *qf, gunichar uc)
 
     DEBUG ("xaccGetQuickFill(): index = %u\n", key);
 
-    return g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+    quickfill_expand_tail (qf);
+    return quickfill_find_match (qf, key, NULL);
 }
 
 /********************************************************************\
@@ -187,14 +340,6 @@ gnc_quickfill_get_string_match (QuickFill *qf, const char *str)
 /********************************************************************\
 \********************************************************************/
 
-static void
-unique_len_helper (gpointer key, gpointer value, gpointer data)
-{
-    QuickFill **qf_p = data;
-
-    *qf_p = value;
-}
-
 QuickFill *
 gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 {
@@ -206,14 +351,12 @@ gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 
     while (1)
     {
-        guint count;
-
-        count = g_hash_table_size (qf->matches);
+        quickfill_expand_tail (qf);
 
-        if (count != 1)
+        if (qf->num_matches != 1)
             break;
 
-        g_hash_table_foreach (qf->matches, unique_len_helper, &qf);
+        qf = qf->matches[0];
 
         if (length != NULL)
             (*length)++;
@@ -228,28 +371,33 @@ gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 void
 gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 {
+    QuickFillText *qf_text;
     gchar *normalized_str;
-    int len;
 
     if (NULL == qf) return;
     if (NULL == text) return;
 
+    g_return_if_fail (qf->texts != NULL);
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    len = g_utf8_strlen (text, -1);
-    quickfill_insert_recursive (qf, normalized_str, len, normalized_str, sort);
+    qf_text = quickfill_text_intern (qf, normalized_str);
     g_free (normalized_str);
+
+    qf_text->refs++;
+    quickfill_insert_recursive (qf, qf, qf_text, qf_text->str, sort);
+    quickfill_text_unref (qf, qf_text);
 }
 
 /********************************************************************\
 \********************************************************************/
 
 static void
-quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
+quickfill_insert_recursive (QuickFill *root, QuickFill *qf, QuickFillText *text,
                             const char *next_char, QuickFillSort sort)
 {
     guint key;
-    char *old_text;
+    guint index;
+    QuickFillText *old_text;
     QuickFill *match_qf;
     gunichar key_char_uc;
 
@@ -263,19 +411,24 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
     key_char_uc = g_utf8_get_char (next_char);
     key = g_unichar_toupper (key_char_uc);
 
-    match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+    match_qf = quickfill_find_match (qf, key, &index);
     if (match_qf == NULL)
     {
-        match_qf = gnc_quickfill_new ();
-        g_hash_table_insert (qf->matches, GUINT_TO_POINTER (key), match_qf);
+        /* Nothing else starts this way, so the new node stands for the
+         * rest of the text. */
+        quickfill_add_match (qf, index, key, text);
+        return;
     }
 
+    /* Keep the strings below the node before its text is replaced. */
+    quickfill_expand_tail (match_qf);
+
     old_text = match_qf->text;
 
     switch (sort)
     {
     case QUICKFILL_ALPHA:
-        if (old_text && (g_utf8_collate (text, old_text) >= 0))
+        if (old_text && (g_utf8_collate (text->str, old_text->str) >= 0))
             break;
         /* fall through */
 
@@ -284,23 +437,21 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
         /* If there's no string there already, just put the new one in. */
         if (old_text == NULL)
         {
-            match_qf->text = g_strdup(text);
-            match_qf->len = len;
+            quickfill_set_text (root, match_qf, text);
             break;
         }
 
         /* Leave prefixes in place */
-        if ((len > match_qf->len) &&
-                (strncmp(text, old_text, strlen(old_text)) == 0))
+        if ((text->len > old_text->len) &&
+                (strncmp(text->str, old_text->str, strlen(old_text->str)) == 0))
             break;
 
-        g_free(old_text);
-        match_qf->text = g_strdup(text);
-        match_qf->len = len;
+        quickfill_set_text (root, match_qf, text);
         break;
     }
 
-    quickfill_insert_recursive (match_qf, text, len, g_utf8_next_char (next_char), sort);
+    quickfill_insert_recursive (root, match_qf, text,
+                                g_utf8_next_char (next_char), sort);
 }
 
 /********************************************************************\
@@ -314,88 +465,55 @@ gnc_quickfill_remove (QuickFill *qf, const gchar *text, QuickFillSort sort)
     if (qf == NULL) return;
     if (text == NULL) return;
 
+    g_return_if_fail (qf->texts != NULL);
+
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    gnc_quickfill_remove_recursive (qf, normalized_str, 0, sort);
+    gnc_quickfill_remove_recursive (qf, qf, normalized_str, normalized_str,
+                                    sort);
     g_free (normalized_str);
 }
 
 /********************************************************************\
 \********************************************************************/
 
-struct _BestText
-{
-    gchar *text;
-    QuickFillSort sort;
-};
-
 static void
-best_text_helper (gpointer key, gpointer value, gpointer user_data)
-{
-    QuickFill *qf = value;
-    struct _BestText *best = user_data;
-
-    if (best->text == NULL)
-    {
-        /* start with the first text */
-        best->text = qf->text;
-
-    }
-    else if (best->text == QUICKFILL_LIFO)
-    {
-        /* we do not track history, so ignore it */
-        return;
-
-    }
-    else if (g_utf8_collate (qf->text, best->text) < 0)
-    {
-        /* even better text */
-        best->text = qf->text;
-    }
-}
-
-
-
-static void
-gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
+gnc_quickfill_remove_recursive (QuickFill *root, QuickFill *qf,
+                                const gchar *text, const gchar *next_char,
                                 QuickFillSort sort)
 {
     QuickFill *match_qf;
-    gchar *child_text;
-    gint child_len;
+    QuickFillText *child_text;
 
     child_text = NULL;
-    child_len = 0;
 
-    if (depth < g_utf8_strlen (text, -1))
+    if (*next_char != '\0')
     {
         /* process next letter */
 
-        gchar *key_char;
         gunichar key_char_uc;
         guint key;
+        guint index;
 
-        key_char = g_utf8_offset_to_pointer (text, depth);
-        key_char_uc = g_utf8_get_char (key_char);
+        key_char_uc = g_utf8_get_char (next_char);
         key = g_unichar_toupper (key_char_uc);
 
-        match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+        match_qf = quickfill_find_match (qf, key, &index);
         if (match_qf)
         {
             /* remove text from child qf */
-            gnc_quickfill_remove_recursive (match_qf, text, depth + 1, sort);
+            gnc_quickfill_remove_recursive (root, match_qf, text,
+                                            g_utf8_next_char (next_char), sort);
 
             if (match_qf->text == NULL)
             {
                 /* text was the only word with a prefix up to match_qf */
-                g_hash_table_remove (qf->matches, GUINT_TO_POINTER (key));
-                gnc_quickfill_destroy (match_qf);
-
+                quickfill_remove_match (qf, index);
+                quickfill_node_free (root, match_qf);
             }
             else
             {
                 /* remember remaining best child string */
                 child_text = match_qf->text;
-                child_len = match_qf->len;
             }
         }
     }
@@ -403,47 +521,65 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
     if (qf->text == NULL)
         return;
 
-    if (strcmp (text, qf->text) == 0)
+    if (strcmp (text, qf->text->str) == 0)
     {
         /* the currently best text is about to be removed */
 
-        gchar *best_text = NULL;
-        gint best_len = 0;
+        QuickFillText *best_text = child_text;
+        guint i;
 
-        if (child_text != NULL)
-        {
-            /* other children are pretty good as well */
-            best_text = child_text;
-            best_len = child_len;
-
-        }
-        else
-        {
-            if (g_hash_table_size (qf->matches) != 0)
-            {
-                /* otherwise search for another good text */
-                struct _BestText bts;
-                bts.text = NULL;
-                bts.sort = sort;
-
-                g_hash_table_foreach (qf->matches, (GHFunc) best_text_helper, &bts);
-                best_text = bts.text;
-                best_len = (best_text == NULL) ? 0 : g_utf8_strlen (best_text, -1);
-            }
-        }
+        /* otherwise search for another good text */
+        if (best_text == NULL)
+            for (i = 0; i < qf->num_matches; i++)
+                if (best_text == NULL ||
+                        g_utf8_collate (qf->matches[i]->text->str,
+                                        best_text->str) < 0)
+                    best_text = qf->matches[i]->text;
 
         /* now replace or clear text */
-        g_free(qf->text);
-        if (best_text != NULL)
-        {
-            qf->text = g_strdup(best_text);
-            qf->len = best_len;
-        }
-        else
-        {
-            qf->text = NULL;
-            qf->len = 0;
-        }
+        quickfill_set_text (root, qf, best_text);
+    }
+}
+
+/********************************************************************\
+\********************************************************************/
+
+static void
+quickfill_stats_helper (QuickFill *qf, QuickFillStats *stats)
+{
+    guint i;
+
+    stats->nodes++;
+    stats->bytes += sizeof (QuickFill) + qf->num_matches * sizeof (QuickFill *);
+
+    for (i = 0; i < qf->num_matches; i++)
+        quickfill_stats_helper (qf->matches[i], stats);
+}
+
+void
+gnc_quickfill_get_stats (QuickFill *qf, QuickFillStats *stats)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    g_return_if_fail (stats != NULL);
+
+    memset (stats, 0, sizeof (QuickFillStats));
+    if (qf == NULL)
+        return;
+
+    g_return_if_fail (qf->texts != NULL);
+
+    quickfill_stats_helper (qf, stats);
+
+    g_hash_table_iter_init (&iter, qf->texts);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        QuickFillText *text = value;
+
+        stats->texts++;
+        stats->bytes += G_STRUCT_OFFSET (QuickFillText, str) +
+                        strlen (text->str) + 1;
     }
 }
 
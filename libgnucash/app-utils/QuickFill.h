@@ -35,6 +35,11 @@
    QuickFill will thus narrow down to the unique matching string
    (or to nothing if no match).
 
+   Each string is stored only once per tree, and the part of a string
+   that no other string shares is only expanded into nodes when a
+   lookup walks into it, so a tree takes little more memory than its
+   strings.
+
    QuickFill works with national-language i18n'ed/l10n'ed multi-byte
    and wide-char strings, as well as plain-old C-locale strings.
    @{
@@ -125,6 +130,17 @@ void         gnc_quickfill_insert (QuickFill *root, const char *text,
 void         gnc_quickfill_remove (QuickFill *root, const gchar *text,
                                    QuickFillSort sort_code);
 
+/** Statistics of a quickfill tree, from gnc_quickfill_get_stats(). */
+typedef struct
+{
+    guint nodes;       /**< Nodes in the tree, including the root. */
+    guint texts;       /**< Distinct strings held by the nodes. */
+    gsize bytes;       /**< Memory used by the nodes and strings. */
+} QuickFillStats;
+
+/** Fill in the statistics of the tree whose root is 'qf'. */
+void         gnc_quickfill_get_stats (QuickFill *qf, QuickFillStats *stats);
+
 /** @} */
 /** @} */
 #endif /* QUICKFILL_H */
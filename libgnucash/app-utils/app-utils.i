@@ -175,5 +175,9 @@ time64 gnc_parse_time_to_time64(const gchar *s, const gchar *format);
   $result = table;
 }
 GHashTable* gnc_sx_all_instantiate_cashflow_all(GDate range_start, GDate range_end);
+GHashTable* gnc_sx_cashflow_get_amounts(const GncSxCashflow *cashflow,
+                                        GDate range_start, GDate range_end);
 %clear GHashTable *;
+GncSxCashflow* gnc_sx_cashflow_new_all(GDate range_start, GDate range_end);
+void gnc_sx_cashflow_free(GncSxCashflow *cashflow);
 #endif
@@ -22,7 +22,9 @@
 #include <stdio.h>
 
 #include "gnc-component-manager.h"
+#include "gnc-session.h"
 #include "qof.h"
+#include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 
 
@@ -54,15 +56,32 @@ typedef struct
 
     char *component_class;
     gint component_id;
+    guint64 serial;     /* registration order */
     gpointer session;
 } ComponentInfo;
 
+typedef struct
+{
+    guint count;
+    gint64 total;
+    gint64 max;
+} RefreshTiming;
+
 
 /** Static Variables ************************************************/
 static guint  suspend_counter = 0;
 /* Some code foolishly uses 0 instead of NO_COMPONENT, so we start with 1. */
 static gint   next_component_id = 1;
 static GList *components = NULL;
+static guint64 next_component_serial = 0;
+static GHashTable *components_by_id = NULL;
+
+/* Reverse indexes of the component watches, so that a refresh only has
+ * to look at the components watching something that changed. The keys
+ * are entity GncGUIDs and entity type names, and the values are sets of
+ * the ComponentInfos watching them with a non-zero mask. */
+static GHashTable *entity_watchers = NULL;
+static GHashTable *type_watchers = NULL;
 
 static ComponentEventInfo changes = { NULL, NULL, FALSE };
 static ComponentEventInfo changes_backup = { NULL, NULL, FALSE };
@@ -137,6 +156,77 @@ destroy_mask_hash (GHashTable *hash)
     g_hash_table_destroy (hash);
 }
 
+static void
+watch_index_init (void)
+{
+    if (components_by_id)
+        return;
+
+    components_by_id = g_hash_table_new (g_direct_hash, g_direct_equal);
+    entity_watchers = g_hash_table_new_full (guid_hash_to_guint,
+                                             guid_g_hash_table_equal,
+                                             (GDestroyNotify) guid_free,
+                                             (GDestroyNotify) g_hash_table_destroy);
+    type_watchers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           (GDestroyNotify) g_hash_table_destroy);
+}
+
+/* Add ci to the watchers of key. copy_key makes the index's own copy of
+ * the key the first time it's watched. */
+static void
+add_watcher (GHashTable *index, gconstpointer key, GBoxedCopyFunc copy_key,
+             ComponentInfo *ci)
+{
+    GHashTable *watchers;
+
+    watchers = g_hash_table_lookup (index, key);
+    if (!watchers)
+    {
+        watchers = g_hash_table_new (g_direct_hash, g_direct_equal);
+        g_hash_table_insert (index, copy_key ((gpointer) key), watchers);
+    }
+
+    g_hash_table_add (watchers, ci);
+}
+
+static void
+remove_watcher (GHashTable *index, gconstpointer key, ComponentInfo *ci)
+{
+    GHashTable *watchers;
+
+    watchers = g_hash_table_lookup (index, key);
+    if (!watchers)
+        return;
+
+    g_hash_table_remove (watchers, ci);
+    if (g_hash_table_size (watchers) == 0)
+        g_hash_table_remove (index, key);
+}
+
+static void
+unindex_type_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    QofEventId * et = value;
+
+    if (*et != 0)
+        remove_watcher (type_watchers, key, user_data);
+}
+
+static void
+unindex_entity_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    remove_watcher (entity_watchers, key, user_data);
+}
+
+/* remove all the watches of a component from the reverse indexes */
+static void
+unindex_watches (ComponentInfo *ci)
+{
+    g_hash_table_foreach (ci->watch_info.event_masks, unindex_type_helper, ci);
+    g_hash_table_foreach (ci->watch_info.entity_events,
+                          unindex_entity_helper, ci);
+}
+
 static gboolean
 destroy_event_hash_helper (gpointer key, gpointer value, gpointer user_data)
 {
@@ -330,17 +420,11 @@ gnc_component_manager_shutdown (void)
 static ComponentInfo *
 find_component (gint component_id)
 {
-    GList *node;
-
-    for (node = components; node; node = node->next)
-    {
-        ComponentInfo *ci = node->data;
-
-        if (ci->component_id == component_id)
-            return ci;
-    }
+    if (!components_by_id)
+        return NULL;
 
-    return NULL;
+    return g_hash_table_lookup (components_by_id,
+                                GINT_TO_POINTER (component_id));
 }
 
 static GList *
@@ -385,6 +469,8 @@ gnc_register_gui_component_internal (const char * component_class)
 
     g_return_val_if_fail (component_class, NULL);
 
+    watch_index_init ();
+
     /* look for a free handler id */
     component_id = next_component_id;
 
@@ -407,9 +493,11 @@ gnc_register_gui_component_internal (const char * component_class)
 
     ci->component_class = g_strdup (component_class);
     ci->component_id = component_id;
+    ci->serial = next_component_serial++;
     ci->session = NULL;
 
     components = g_list_prepend (components, ci);
+    g_hash_table_insert (components_by_id, GINT_TO_POINTER (component_id), ci);
 
     /* update id for next registration */
     next_component_id = component_id + 1;
@@ -454,6 +542,7 @@ gnc_gui_component_watch_entity (gint component_id,
                                 QofEventId event_mask)
 {
     ComponentInfo *ci;
+    gboolean watched;
 
     if (entity == NULL)
         return;
@@ -465,7 +554,14 @@ gnc_gui_component_watch_entity (gint component_id,
         return;
     }
 
+    watched = g_hash_table_lookup (ci->watch_info.entity_events, entity) != NULL;
+
     add_event (&ci->watch_info, entity, event_mask, FALSE);
+
+    if (event_mask != 0 && !watched)
+        add_watcher (entity_watchers, entity, (GBoxedCopyFunc) guid_copy, ci);
+    else if (event_mask == 0 && watched)
+        remove_watcher (entity_watchers, entity, ci);
 }
 
 void
@@ -474,6 +570,10 @@ gnc_gui_component_watch_entity_type (gint component_id,
                                      QofEventId event_mask)
 {
     ComponentInfo *ci;
+    QofEventId *mask;
+    gboolean watched;
+
+    g_return_if_fail (entity_type);
 
     ci = find_component (component_id);
     if (!ci)
@@ -482,7 +582,15 @@ gnc_gui_component_watch_entity_type (gint component_id,
         return;
     }
 
+    mask = g_hash_table_lookup (ci->watch_info.event_masks, entity_type);
+    watched = mask && *mask != 0;
+
     add_event_type (&ci->watch_info, entity_type, event_mask, FALSE);
+
+    if (event_mask != 0 && !watched)
+        add_watcher (type_watchers, entity_type, (GBoxedCopyFunc) g_strdup, ci);
+    else if (event_mask == 0 && watched)
+        remove_watcher (type_watchers, entity_type, ci);
 }
 
 const EventInfo *
@@ -506,6 +614,7 @@ gnc_gui_component_clear_watches (gint component_id)
         return;
     }
 
+    unindex_watches (ci);
     clear_event_info (&ci->watch_info);
 }
 
@@ -530,6 +639,7 @@ gnc_unregister_gui_component (gint component_id)
     gnc_gui_component_clear_watches (component_id);
 
     components = g_list_remove (components, ci);
+    g_hash_table_remove (components_by_id, GINT_TO_POINTER (component_id));
 
     destroy_mask_hash (ci->watch_info.event_masks);
     ci->watch_info.event_masks = NULL;
@@ -662,11 +772,141 @@ changes_match (ComponentEventInfo *cei, ComponentEventInfo *changes)
     return big_cei->match;
 }
 
+static void
+add_watchers_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    g_hash_table_add (user_data, key);
+}
+
+static void
+collect_type_watchers_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    QofEventId * et = value;
+    GHashTable *watchers;
+
+    if (*et == 0)
+        return;
+
+    watchers = g_hash_table_lookup (type_watchers, key);
+    if (watchers)
+        g_hash_table_foreach (watchers, add_watchers_helper, user_data);
+}
+
+static void
+collect_entity_watchers_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    GHashTable *watchers;
+
+    watchers = g_hash_table_lookup (entity_watchers, key);
+    if (watchers)
+        g_hash_table_foreach (watchers, add_watchers_helper, user_data);
+}
+
+static gint
+compare_serial (gconstpointer a, gconstpointer b)
+{
+    const ComponentInfo *ci_a = a;
+    const ComponentInfo *ci_b = b;
+
+    if (ci_a->serial < ci_b->serial)
+        return -1;
+
+    return ci_a->serial > ci_b->serial;
+}
+
+/* Return the ids of the components watching any of the changes, newest
+ * first like the components list. The watch masks still have to be
+ * checked with changes_match. */
+static GList *
+find_watching_component_ids (ComponentEventInfo *changes)
+{
+    GHashTable *found;
+    GList *list = NULL;
+    GList *cis;
+    GList *node;
+
+    if (!components_by_id)
+        return NULL;
+
+    found = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_foreach (changes->event_masks,
+                          collect_type_watchers_helper, found);
+    g_hash_table_foreach (changes->entity_events,
+                          collect_entity_watchers_helper, found);
+
+    cis = g_list_sort (g_hash_table_get_keys (found), compare_serial);
+    for (node = cis; node; node = node->next)
+    {
+        ComponentInfo *ci = node->data;
+
+        list = g_list_prepend (list, GINT_TO_POINTER (ci->component_id));
+    }
+
+    g_list_free (cis);
+    g_hash_table_destroy (found);
+
+    return list;
+}
+
+/* Call the refresh handler of ci. If timings isn't NULL the time it
+ * took is added to the entry for the component's class. */
+static void
+refresh_component (ComponentInfo *ci, GHashTable *changes,
+                   GHashTable *timings)
+{
+    RefreshTiming *timing;
+    char *component_class;
+    gint64 elapsed;
+
+#if CM_DEBUG
+    fprintf (stderr, "calling %s:%d C handler\n", ci->component_class, ci->component_id);
+#endif
+
+    if (!timings)
+    {
+        ci->refresh_handler (changes, ci->user_data);
+        return;
+    }
+
+    /* the handler may unregister the component */
+    component_class = g_strdup (ci->component_class);
+
+    elapsed = g_get_monotonic_time ();
+    ci->refresh_handler (changes, ci->user_data);
+    elapsed = g_get_monotonic_time () - elapsed;
+
+    timing = g_hash_table_lookup (timings, component_class);
+    if (!timing)
+    {
+        timing = g_new0 (RefreshTiming, 1);
+        g_hash_table_insert (timings, component_class, timing);
+    }
+    else
+        g_free (component_class);
+
+    timing->count++;
+    timing->total += elapsed;
+    timing->max = MAX (timing->max, elapsed);
+}
+
+static void
+log_timing_helper (gpointer key, gpointer value, gpointer user_data)
+{
+    RefreshTiming *timing = value;
+
+    PINFO ("%s: %u refreshes in %" G_GINT64_FORMAT " us, slowest %"
+           G_GINT64_FORMAT " us", (char *) key, timing->count, timing->total,
+           timing->max);
+}
+
 static void
 gnc_gui_refresh_internal (gboolean force)
 {
     GList *list;
     GList *node;
+    GHashTable *timings = NULL;
+    gint64 start = 0;
+    guint num_components = 0;
 
     if (!got_events && !force)
         return;
@@ -689,9 +929,22 @@ gnc_gui_refresh_internal (gboolean force)
     fprintf (stderr, "%srefresh!\n", force ? "forced " : "");
 #endif
 
-    list = find_component_ids_by_class (NULL);
-    // reverse the list so class GncPluginPageRegister is before register-single
-    list = g_list_reverse (list);
+    if (qof_log_check (log_module, QOF_LOG_INFO))
+    {
+        timings = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, g_free);
+        start = g_get_monotonic_time ();
+        num_components = g_list_length (components);
+    }
+
+    if (force)
+    {
+        list = find_component_ids_by_class (NULL);
+        // reverse the list so class GncPluginPageRegister is before register-single
+        list = g_list_reverse (list);
+    }
+    else
+        list = find_watching_component_ids (&changes_backup);
 
     for (node = list; node; node = node->next)
     {
@@ -709,25 +962,9 @@ gnc_gui_refresh_internal (gboolean force)
         }
 
         if (force)
-        {
-            if (ci->refresh_handler)
-            {
-#if CM_DEBUG
-                fprintf (stderr, "calling %s:%d C handler\n", ci->component_class, ci->component_id);
-#endif
-                ci->refresh_handler (NULL, ci->user_data);
-            }
-        }
+            refresh_component (ci, NULL, timings);
         else if (changes_match (&ci->watch_info, &changes_backup))
-        {
-            if (ci->refresh_handler)
-            {
-#if CM_DEBUG
-                fprintf (stderr, "calling %s:%d C handler\n", ci->component_class, ci->component_id);
-#endif
-                ci->refresh_handler (changes_backup.entity_events, ci->user_data);
-            }
-        }
+            refresh_component (ci, changes_backup.entity_events, timings);
         else
         {
 #if CM_DEBUG
@@ -736,6 +973,15 @@ gnc_gui_refresh_internal (gboolean force)
         }
     }
 
+    if (timings)
+    {
+        PINFO ("%srefresh checked %u of %u components in %" G_GINT64_FORMAT " us",
+               force ? "forced " : "", g_list_length (list), num_components,
+               g_get_monotonic_time () - start);
+        g_hash_table_foreach (timings, log_timing_helper, NULL);
+        g_hash_table_destroy (timings);
+    }
+
     clear_event_info (&changes_backup);
     got_events = FALSE;
 
@@ -753,6 +999,9 @@ gnc_gui_refresh_all (void)
         return;
     }
 
+    /* A forced refresh follows changes whose events were suspended. */
+    if (gnc_current_session_exist ())
+        gnc_ui_balances_flush_cache (gnc_get_current_book ());
     gnc_gui_refresh_internal (TRUE);
 }
 
@@ -54,6 +54,10 @@ static GHashTable   *variable_bindings = NULL;
 static ParseError    last_error        = PARSER_NO_ERROR;
 static GNCParseError last_gncp_error   = NO_ERR;
 static gboolean      parser_inited     = FALSE;
+/* text -> GNCExpression*, or NULL if the text can't be compiled */
+static GHashTable   *compiled_expressions = NULL;
+
+static void clear_compiled_expressions (void);
 
 
 /** Implementations ************************************************/
@@ -80,6 +84,9 @@ gnc_exp_parser_real_init ( gboolean addPredefined )
     if (parser_inited)
         gnc_exp_parser_shutdown ();
 
+    /* Numbers are read in the current locale. */
+    clear_compiled_expressions ();
+
     /* The parser uses fin.scm for financial functions, so load it here. */
     scm_primitive_load_path(scm_from_utf8_string("fin"));
     variable_bindings = g_hash_table_new (g_str_hash, g_str_equal);
@@ -153,6 +160,8 @@ gnc_exp_parser_shutdown (void)
     g_hash_table_destroy (variable_bindings);
     variable_bindings = NULL;
 
+    clear_compiled_expressions ();
+
     last_error = PARSER_NO_ERROR;
     last_gncp_error = NO_ERR;
 
@@ -429,6 +438,666 @@ negate_numeric(void *value)
     return result;
 }
 
+/** Compiled expressions ********************************************/
+
+/* An expression without assignments is compiled into a list of
+ * operations on a stack, with each variable it names in a slot, so
+ * evaluating it again needs no parsing. The compiler follows the
+ * grammar and tokens of the expression parser in calculation/, and
+ * gives up on anything it doesn't handle, leaving the expression to
+ * the parser. The evaluation keeps the parser's quirks: a negated
+ * variable stays negated for the rest of the expression, and
+ * "(number)" means the negative number. */
+
+#define GEP_NUM_TOKEN 'I'
+#define GEP_VAR_TOKEN 'V'
+#define GEP_FN_TOKEN  'F'
+#define GEP_STR_TOKEN '"'
+#define GEP_ARG_TOKEN ':'
+
+/* The parser keeps names and strings in a buffer this long. */
+#define GEP_MAX_NAME_LEN 127
+
+/* Compiled expressions are kept by their text, up to this many. */
+#define GEP_CACHE_SIZE 1024
+
+typedef enum
+{
+    GEP_OP_NUMBER,              /* push numbers[index] */
+    GEP_OP_VARIABLE,            /* push the variable in slot index */
+    GEP_OP_STRING,              /* push strings[index], only an argument */
+    GEP_OP_NEGATE,
+    GEP_OP_ADD,
+    GEP_OP_SUB,
+    GEP_OP_MUL,
+    GEP_OP_DIV,
+    GEP_OP_CALL,                /* call strings[index] with argc args */
+} GEPOpCode;
+
+typedef struct
+{
+    GEPOpCode code;
+    guint index;
+    guint argc;
+    guint error_offset;         /* for GEP_OP_CALL, where a failure is */
+} GEPOp;
+
+struct GNCExpression
+{
+    gint ref_count;
+    gchar *text;
+    GArray *ops;                /* GEPOp */
+    GArray *numbers;            /* gnc_numeric */
+    GPtrArray *names;           /* the variables, one per slot */
+    GPtrArray *strings;         /* function names and string arguments */
+    guint stack_size;
+};
+
+typedef struct
+{
+    const char *text;
+    const char *str;
+    char token;
+    gchar *name;
+    gnc_numeric number;
+    GString *tokens;
+    gboolean failed;
+    guint depth;
+    GNCExpression *expr;
+} GEPCompiler;
+
+static void
+compiler_next (GEPCompiler *c)
+{
+    const char *s = c->str;
+    char *end;
+
+    while (isspace (*s))
+        s++;
+
+    g_free (c->name);
+    c->name = NULL;
+
+    if (!*s)
+        c->token = EOS;
+    else if (strchr ("+-*/():", *s))
+    {
+        c->token = *s++;
+        /* An assignment operator, which only the parser handles. */
+        if (*s == ASN_OP)
+            c->failed = TRUE;
+    }
+    else if (*s == '"')
+    {
+        const char *close = strchr (s + 1, '"');
+        if (!close || close - s - 1 > GEP_MAX_NAME_LEN)
+            c->failed = TRUE;
+        else
+        {
+            c->name = g_strndup (s + 1, close - s - 1);
+            c->token = GEP_STR_TOKEN;
+            s = close + 1;
+        }
+    }
+    else if (isalpha (*s) || *s == '_')
+    {
+        const char *start = s;
+        while (*s == '_' || isalpha (*s) || isdigit (*s))
+            s++;
+        if (s - start > GEP_MAX_NAME_LEN)
+            c->failed = TRUE;
+        c->name = g_strndup (start, s - start);
+        if (*s == '(')
+        {
+            s++;
+            c->token = GEP_FN_TOKEN;
+        }
+        else
+            c->token = GEP_VAR_TOKEN;
+    }
+    else if (xaccParseAmount (s, TRUE, &c->number, &end))
+    {
+        c->token = GEP_NUM_TOKEN;
+        s = end;
+    }
+    else
+        c->failed = TRUE;
+
+    c->str = s;
+    if (!c->failed && c->token != EOS)
+        g_string_append_c (c->tokens, c->token);
+}
+
+static void
+compiler_emit (GEPCompiler *c, GEPOpCode code, guint index, guint argc)
+{
+    GEPOp op = { code, index, argc, 0 };
+
+    switch (code)
+    {
+    case GEP_OP_NUMBER:
+    case GEP_OP_VARIABLE:
+    case GEP_OP_STRING:
+        if (++c->depth > c->expr->stack_size)
+            c->expr->stack_size = c->depth;
+        break;
+    case GEP_OP_ADD:
+    case GEP_OP_SUB:
+    case GEP_OP_MUL:
+    case GEP_OP_DIV:
+        c->depth--;
+        break;
+    case GEP_OP_CALL:
+        c->depth -= argc;
+        if (++c->depth > c->expr->stack_size)
+            c->expr->stack_size = c->depth;
+        /* The parser stops at the closing parenthesis. */
+        op.error_offset = c->str - c->text;
+        break;
+    case GEP_OP_NEGATE:
+        break;
+    }
+    g_array_append_val (c->expr->ops, op);
+}
+
+static guint
+compiler_add_string (GEPCompiler *c, gchar *string)
+{
+    g_ptr_array_add (c->expr->strings, string);
+    return c->expr->strings->len - 1;
+}
+
+static guint
+compiler_variable_slot (GEPCompiler *c, gchar *name)
+{
+    guint i;
+
+    for (i = 0; i < c->expr->names->len; i++)
+        if (strcmp (g_ptr_array_index (c->expr->names, i), name) == 0)
+        {
+            g_free (name);
+            return i;
+        }
+    g_ptr_array_add (c->expr->names, name);
+    return c->expr->names->len - 1;
+}
+
+/* The parser doesn't allow an operand right after another. */
+static gboolean
+compiler_operand_follows (GEPCompiler *c)
+{
+    return c->token == GEP_VAR_TOKEN || c->token == GEP_STR_TOKEN
+        || c->token == GEP_NUM_TOKEN || c->token == GEP_FN_TOKEN;
+}
+
+static void compile_sum (GEPCompiler *c);
+
+static void
+compile_primary (GEPCompiler *c)
+{
+    char token = c->token;
+    gchar *name = c->name;
+    gnc_numeric number = c->number;
+    guint argc = 0;
+
+    c->name = NULL;
+    compiler_next (c);
+    if (c->failed)
+    {
+        g_free (name);
+        return;
+    }
+
+    switch (token)
+    {
+    case '(':
+        compile_sum (c);
+        if (c->failed || c->token != ')')
+        {
+            c->failed = TRUE;
+            return;
+        }
+        compiler_next (c);
+        break;
+
+    case ADD_OP:
+    case SUB_OP:
+        compile_primary (c);
+        if (!c->failed && token == SUB_OP)
+            compiler_emit (c, GEP_OP_NEGATE, 0, 0);
+        break;
+
+    case GEP_NUM_TOKEN:
+        if (compiler_operand_follows (c))
+        {
+            c->failed = TRUE;
+            return;
+        }
+        g_array_append_val (c->expr->numbers, number);
+        compiler_emit (c, GEP_OP_NUMBER, c->expr->numbers->len - 1, 0);
+        break;
+
+    case GEP_VAR_TOKEN:
+        if (compiler_operand_follows (c))
+        {
+            c->failed = TRUE;
+            g_free (name);
+            return;
+        }
+        compiler_emit (c, GEP_OP_VARIABLE, compiler_variable_slot (c, name), 0);
+        break;
+
+    case GEP_FN_TOKEN:
+        while (c->token != ')')
+        {
+            if (c->token == GEP_STR_TOKEN)
+            {
+                compiler_emit (c, GEP_OP_STRING,
+                               compiler_add_string (c, c->name), 0);
+                c->name = NULL;
+                compiler_next (c);
+                if (c->token != ')' && c->token != GEP_ARG_TOKEN)
+                    c->failed = TRUE;
+            }
+            else
+                compile_sum (c);
+            if (c->failed)
+                break;
+            argc++;
+            if (c->token == GEP_ARG_TOKEN)
+            {
+                compiler_next (c);
+                if (c->token == ')')
+                    c->failed = TRUE;
+            }
+            else if (c->token != ')')
+                c->failed = TRUE;
+        }
+        if (c->failed)
+        {
+            g_free (name);
+            return;
+        }
+        compiler_emit (c, GEP_OP_CALL, compiler_add_string (c, name), argc);
+        compiler_next (c);
+        if (compiler_operand_follows (c))
+            c->failed = TRUE;
+        break;
+
+    default:
+        g_free (name);
+        c->failed = TRUE;
+        break;
+    }
+}
+
+static void
+compile_product (GEPCompiler *c)
+{
+    compile_primary (c);
+    while (!c->failed && (c->token == MUL_OP || c->token == DIV_OP))
+    {
+        GEPOpCode code = c->token == MUL_OP ? GEP_OP_MUL : GEP_OP_DIV;
+        compiler_next (c);
+        if (c->failed)
+            return;
+        compile_primary (c);
+        if (!c->failed)
+            compiler_emit (c, code, 0, 0);
+    }
+}
+
+static void
+compile_sum (GEPCompiler *c)
+{
+    compile_product (c);
+    while (!c->failed && (c->token == ADD_OP || c->token == SUB_OP))
+    {
+        GEPOpCode code = c->token == ADD_OP ? GEP_OP_ADD : GEP_OP_SUB;
+        compiler_next (c);
+        if (c->failed)
+            return;
+        compile_product (c);
+        if (!c->failed)
+            compiler_emit (c, code, 0, 0);
+    }
+}
+
+static GNCExpression *
+compile_expression (const char *expression)
+{
+    GEPCompiler c = { expression, expression, EOS, NULL,
+                      { 0, 1 }, g_string_new (NULL), FALSE, 0, NULL };
+
+    c.expr = g_new0 (GNCExpression, 1);
+    c.expr->ref_count = 1;
+    c.expr->text = g_strdup (expression);
+    c.expr->ops = g_array_new (FALSE, FALSE, sizeof (GEPOp));
+    c.expr->numbers = g_array_new (FALSE, FALSE, sizeof (gnc_numeric));
+    c.expr->names = g_ptr_array_new_with_free_func (g_free);
+    c.expr->strings = g_ptr_array_new_with_free_func (g_free);
+
+    compiler_next (&c);
+    if (!c.failed)
+        compile_sum (&c);
+    if (!c.failed && c.token != EOS)
+        c.failed = TRUE;
+    /* interpret (num) as -num */
+    if (!c.failed && strcmp (c.tokens->str, "(I)") == 0)
+        compiler_emit (&c, GEP_OP_NEGATE, 0, 0);
+
+    g_free (c.name);
+    g_string_free (c.tokens, TRUE);
+    if (c.failed)
+    {
+        gnc_exp_expression_unref (c.expr);
+        return NULL;
+    }
+    return c.expr;
+}
+
+/* Returns the cache's expression for the text, or NULL if the text can't
+ * be compiled. */
+static GNCExpression *
+lookup_compiled_expression (const char *expression)
+{
+    gpointer expr;
+
+    if (!compiled_expressions)
+        compiled_expressions =
+            g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                   (GDestroyNotify)gnc_exp_expression_unref);
+
+    if (g_hash_table_lookup_extended (compiled_expressions, expression,
+                                      NULL, &expr))
+        return expr;
+
+    if (g_hash_table_size (compiled_expressions) >= GEP_CACHE_SIZE)
+        g_hash_table_remove_all (compiled_expressions);
+    expr = compile_expression (expression);
+    g_hash_table_insert (compiled_expressions, g_strdup (expression), expr);
+    return expr;
+}
+
+static void
+clear_compiled_expressions (void)
+{
+    if (!compiled_expressions)
+        return;
+    g_hash_table_destroy (compiled_expressions);
+    compiled_expressions = NULL;
+}
+
+GNCExpression *
+gnc_exp_parser_compile (const char *expression)
+{
+    GNCExpression *expr;
+
+    if (expression == NULL)
+        return NULL;
+
+    expr = lookup_compiled_expression (expression);
+    if (expr)
+        expr->ref_count++;
+    return expr;
+}
+
+void
+gnc_exp_expression_unref (GNCExpression *expr)
+{
+    if (!expr || --expr->ref_count > 0)
+        return;
+
+    g_free (expr->text);
+    g_array_free (expr->ops, TRUE);
+    g_array_free (expr->numbers, TRUE);
+    g_ptr_array_free (expr->names, TRUE);
+    g_ptr_array_free (expr->strings, TRUE);
+    g_free (expr);
+}
+
+guint
+gnc_exp_expression_get_num_variables (const GNCExpression *expr)
+{
+    return expr->names->len;
+}
+
+const char *
+gnc_exp_expression_get_variable (const GNCExpression *expr, guint slot)
+{
+    return g_ptr_array_index (expr->names, slot);
+}
+
+typedef enum
+{
+    GEP_SLOT_EXTERNAL,          /* from the caller's varHash */
+    GEP_SLOT_PREDEFINED,        /* from the parser's own variables */
+    GEP_SLOT_NEW,
+} GEPSlotSource;
+
+typedef struct
+{
+    ParserNum value;
+    GEPSlotSource source;
+    gboolean used;
+} GEPSlot;
+
+/* A value on the stack: a number, a variable, read when it's used as
+ * the parser does, or a string argument. */
+typedef struct
+{
+    VarStoreType type;
+    gnc_numeric value;
+    GEPSlot *slot;
+    const char *string;
+} GEPItem;
+
+static gnc_numeric
+item_value (const GEPItem *item)
+{
+    return item->slot ? item->slot->value.value : item->value;
+}
+
+/* Evaluates expr as the parser would evaluate text. */
+static gboolean
+evaluate_compiled (const GNCExpression *expr, const char *text,
+                   gnc_numeric *value_p, char **error_loc_p,
+                   GHashTable *varHash)
+{
+    GEPSlot *slots = g_new0 (GEPSlot, expr->names->len);
+    GEPItem *stack = g_new0 (GEPItem, expr->stack_size + 1);
+    guint depth = 0, i;
+    gnc_numeric result;
+
+    for (i = 0; i < expr->names->len; i++)
+    {
+        const char *name = g_ptr_array_index (expr->names, i);
+        gpointer value;
+        ParserNum *pnum;
+
+        /* The caller's variables come first. */
+        if (varHash && g_hash_table_lookup_extended (varHash, name,
+                                                     NULL, &value))
+        {
+            if (value)
+                slots[i].value.value = *(gnc_numeric*)value;
+            slots[i].source = GEP_SLOT_EXTERNAL;
+        }
+        else if ((pnum = g_hash_table_lookup (variable_bindings, name)))
+        {
+            slots[i].value = *pnum;
+            slots[i].source = GEP_SLOT_PREDEFINED;
+        }
+        else
+        {
+            slots[i].value.value = gnc_numeric_zero ();
+            slots[i].source = GEP_SLOT_NEW;
+        }
+    }
+
+    last_error = PARSER_NO_ERROR;
+    for (i = 0; i < expr->ops->len && last_error == PARSER_NO_ERROR; i++)
+    {
+        const GEPOp *op = &g_array_index (expr->ops, GEPOp, i);
+        GEPItem *item = &stack[depth];
+
+        switch (op->code)
+        {
+        case GEP_OP_NUMBER:
+            item->type = VST_NUMERIC;
+            item->value = g_array_index (expr->numbers, gnc_numeric, op->index);
+            item->slot = NULL;
+            depth++;
+            break;
+        case GEP_OP_VARIABLE:
+            item->type = VST_NUMERIC;
+            item->slot = &slots[op->index];
+            item->slot->used = TRUE;
+            depth++;
+            break;
+        case GEP_OP_STRING:
+            item->type = VST_STRING;
+            item->string = g_ptr_array_index (expr->strings, op->index);
+            item->slot = NULL;
+            depth++;
+            break;
+        case GEP_OP_NEGATE:
+            item = &stack[depth - 1];
+            if (item->slot)
+                item->slot->value.value = gnc_numeric_neg (item->slot->value.value);
+            else
+                item->value = gnc_numeric_neg (item->value);
+            break;
+        case GEP_OP_ADD:
+        case GEP_OP_SUB:
+        case GEP_OP_MUL:
+        case GEP_OP_DIV:
+        {
+            GEPItem *left = &stack[depth - 2];
+            gnc_numeric l = item_value (left), r = item_value (&stack[depth - 1]);
+            switch (op->code)
+            {
+            case GEP_OP_ADD:
+                left->value = gnc_numeric_add (l, r, GNC_DENOM_AUTO,
+                                               GNC_HOW_DENOM_EXACT);
+                break;
+            case GEP_OP_SUB:
+                left->value = gnc_numeric_sub (l, r, GNC_DENOM_AUTO,
+                                               GNC_HOW_DENOM_EXACT);
+                break;
+            case GEP_OP_MUL:
+                left->value = gnc_numeric_mul (l, r, GNC_DENOM_AUTO,
+                                               GNC_HOW_DENOM_EXACT);
+                break;
+            default:
+                left->value = gnc_numeric_div (l, r, GNC_DENOM_AUTO,
+                                               GNC_HOW_DENOM_EXACT);
+                break;
+            }
+            left->slot = NULL;
+            depth--;
+            break;
+        }
+        case GEP_OP_CALL:
+        {
+            var_store *args = g_new0 (var_store, op->argc);
+            ParserNum *nums = g_new0 (ParserNum, op->argc);
+            void **argv = g_new0 (void*, op->argc);
+            gnc_numeric *value;
+            guint arg;
+
+            depth -= op->argc;
+            for (arg = 0; arg < op->argc; arg++)
+            {
+                GEPItem *argument = &stack[depth + arg];
+                args[arg].type = argument->type;
+                if (argument->type == VST_STRING)
+                    args[arg].value = (char*)argument->string;
+                else
+                {
+                    nums[arg].value = item_value (argument);
+                    args[arg].value = &nums[arg];
+                }
+                argv[arg] = &args[arg];
+            }
+            value = func_op (g_ptr_array_index (expr->strings, op->index),
+                             op->argc, argv);
+            g_free (argv);
+            g_free (nums);
+            g_free (args);
+
+            if (value == NULL)
+            {
+                if (error_loc_p != NULL)
+                    *error_loc_p = (char*)text + op->error_offset;
+                last_error = NOT_A_FUNC;
+                break;
+            }
+            item = &stack[depth];
+            item->type = VST_NUMERIC;
+            item->value = *value;
+            item->slot = NULL;
+            g_free (value);
+            depth++;
+            break;
+        }
+        }
+    }
+
+    if (last_error == PARSER_NO_ERROR)
+    {
+        result = item_value (&stack[0]);
+        if (gnc_numeric_check (result))
+        {
+            if (error_loc_p != NULL)
+                *error_loc_p = (char*)text;
+            last_error = NUMERIC_ERROR;
+        }
+        else
+        {
+            if (value_p)
+                *value_p = gnc_numeric_reduce (result);
+            if (error_loc_p != NULL)
+                *error_loc_p = NULL;
+        }
+    }
+
+    /* Hand the variables back as the parser does, even after an error:
+     * new ones go to the caller's varHash, or without one, changes go
+     * to the parser's own variables. */
+    for (i = 0; i < expr->names->len; i++)
+    {
+        const char *name = g_ptr_array_index (expr->names, i);
+        if (!slots[i].used)
+            continue;
+        if (varHash != NULL && slots[i].source == GEP_SLOT_NEW)
+        {
+            gnc_numeric *numericValue = g_new0 (gnc_numeric, 1);
+            *numericValue = slots[i].value.value;
+            g_hash_table_insert (varHash, g_strdup (name), numericValue);
+        }
+        else if (varHash == NULL && slots[i].source == GEP_SLOT_PREDEFINED)
+            gnc_exp_parser_set_value (name, slots[i].value.value);
+    }
+
+    g_free (stack);
+    g_free (slots);
+    return last_error == PARSER_NO_ERROR;
+}
+
+gboolean
+gnc_exp_parser_evaluate (const GNCExpression *expr, gnc_numeric *value_p,
+                         char **error_loc_p, GHashTable *varHash)
+{
+    if (expr == NULL)
+        return FALSE;
+
+    if (!parser_inited)
+        gnc_exp_parser_real_init ( (varHash == NULL) );
+
+    return evaluate_compiled (expr, expr->text, value_p, error_loc_p, varHash);
+}
+
 static
 void
 gnc_ep_tmpvarhash_check_vals( gpointer key, gpointer value, gpointer user_data )
@@ -485,11 +1154,11 @@ cleanup:
     return toRet;
 }
 
-gboolean
-gnc_exp_parser_parse_separate_vars (const char * expression,
-                                    gnc_numeric *value_p,
-                                    char **error_loc_p,
-                                    GHashTable *varHash )
+static gboolean
+parse_separate_vars_interpreted (const char * expression,
+                                 gnc_numeric *value_p,
+                                 char **error_loc_p,
+                                 GHashTable *varHash )
 {
     parser_env_ptr pe;
     var_store_ptr vars;
@@ -498,12 +1167,6 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     char * error_loc;
     ParserNum *pnum;
 
-    if (expression == NULL)
-        return FALSE;
-
-    if (!parser_inited)
-        gnc_exp_parser_real_init ( (varHash == NULL) );
-
     result.variable_name = NULL;
     result.value = NULL;
     result.next_var = NULL;
@@ -596,6 +1259,28 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     return last_error == PARSER_NO_ERROR;
 }
 
+gboolean
+gnc_exp_parser_parse_separate_vars (const char * expression,
+                                    gnc_numeric *value_p,
+                                    char **error_loc_p,
+                                    GHashTable *varHash )
+{
+    GNCExpression *expr;
+
+    if (expression == NULL)
+        return FALSE;
+
+    if (!parser_inited)
+        gnc_exp_parser_real_init ( (varHash == NULL) );
+
+    expr = lookup_compiled_expression (expression);
+    if (expr)
+        return evaluate_compiled (expr, expression, value_p, error_loc_p,
+                                  varHash);
+    return parse_separate_vars_interpreted (expression, value_p, error_loc_p,
+                                            varHash);
+}
+
 const char *
 gnc_exp_parser_error_string (void)
 {
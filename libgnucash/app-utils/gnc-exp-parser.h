@@ -85,6 +85,39 @@ gboolean gnc_exp_parser_parse_separate_vars (const char * expression,
         char **error_loc_p,
         GHashTable *varHash );
 
+/**
+ * An expression parsed once, to be evaluated many times without parsing
+ * its text again. The variables it uses are found when it is evaluated.
+ **/
+typedef struct GNCExpression GNCExpression;
+
+/**
+ * Compile expression for gnc_exp_parser_evaluate(). Returns NULL if the
+ * expression can only be parsed by gnc_exp_parser_parse_separate_vars,
+ * as assignments can, or if it has an error, which that function will
+ * report. Compiled expressions are kept by their text, so compiling the
+ * same text again is cheap; gnc_exp_parser_parse_separate_vars uses them
+ * too. Release the result with gnc_exp_expression_unref().
+ **/
+GNCExpression *gnc_exp_parser_compile (const char *expression);
+
+void gnc_exp_expression_unref (GNCExpression *expr);
+
+/**
+ * Evaluate a compiled expression, with the same results and errors as
+ * gnc_exp_parser_parse_separate_vars would give for its text. An
+ * error_loc_p points into the expression's own copy of the text.
+ **/
+gboolean gnc_exp_parser_evaluate (const GNCExpression *expr,
+                                  gnc_numeric *value_p,
+                                  char **error_loc_p,
+                                  GHashTable *varHash);
+
+/* The names of the variables the expression uses. */
+guint gnc_exp_expression_get_num_variables (const GNCExpression *expr);
+const char * gnc_exp_expression_get_variable (const GNCExpression *expr,
+                                              guint slot);
+
 /* If the last parse returned FALSE, return an error string describing
  * the problem. Otherwise, return NULL. */
 const char * gnc_exp_parser_error_string (void);
@@ -962,11 +962,16 @@ increment_sx_state(GncSxInstance *inst, GDate **last_occur_date, int *instance_c
     }
 }
 
+typedef struct _SxTemplateTxn SxTemplateTxn;
+
 typedef struct _SxTxnCreationData
 {
     GncSxInstance *instance;
     GList **created_txn_guids;
     GList **creation_errors;
+    /* Set when running in a batch, see SxBatch. */
+    SxTemplateTxn *template_txn;
+    GHashTable *parser_vars;
 } SxTxnCreationData;
 
 static gboolean
@@ -1074,8 +1079,112 @@ _get_debit_formula_value(GncSxInstance *instance, const Split *template_split,
                           "sx-debit-numeric", instance->variable_bindings);
 }
 
+/* A template split's formula as read and compiled once for a batch. A
+ * formula with no names in it can't use variables or functions, so it is
+ * evaluated once and the value used for every instance. */
+typedef struct
+{
+    const char *key;
+    gchar *formula;
+    GNCExpression *compiled;
+    gboolean has_numeric;
+    gnc_numeric numeric;
+    gboolean is_constant;
+    gnc_numeric constant;
+} SxTemplateFormula;
+
+typedef struct
+{
+    Split *split;
+    Account *account;
+    SxTemplateFormula credit;
+    SxTemplateFormula debit;
+} SxTemplateSplit;
+
+struct _SxTemplateTxn
+{
+    Transaction *txn;
+    gnc_commodity *currency;
+    GList *splits;              /* SxTemplateSplit*, in the template's order */
+};
+
+static void
+sx_template_formula_init (SxTemplateFormula *formula, const Split *split,
+                          const char *formula_key, const char *numeric_key)
+{
+    gnc_numeric *numeric_val = NULL;
+    const gchar *c;
+
+    formula->key = formula_key;
+    formula->formula = NULL;
+    formula->compiled = NULL;
+    qof_instance_get (QOF_INSTANCE (split),
+                      formula_key, &formula->formula,
+                      numeric_key, &numeric_val,
+                      NULL);
+    formula->has_numeric = numeric_val != NULL &&
+        gnc_numeric_check (*numeric_val) == GNC_ERROR_OK &&
+        !gnc_numeric_zero_p (*numeric_val);
+    formula->numeric = formula->has_numeric ? *numeric_val : gnc_numeric_zero ();
+    g_free (numeric_val);
+
+    formula->is_constant = FALSE;
+    if (formula->formula == NULL || *formula->formula == '\0')
+        return;
+    formula->compiled = gnc_exp_parser_compile (formula->formula);
+    for (c = formula->formula; *c; c = g_utf8_next_char (c))
+        if (g_unichar_isalpha (g_utf8_get_char (c)))
+            return;
+    formula->constant = gnc_numeric_zero ();
+    formula->is_constant = gnc_exp_parser_parse (formula->formula,
+                                                 &formula->constant, NULL);
+}
+
+/* The same as _get_sx_formula_value, without reading the split again.
+ * The parser's variables are made from the bindings on first use and
+ * kept in *parser_vars for the caller to free. */
+static void
+sx_template_formula_value (const SxTemplateFormula *formula,
+                           const SchedXaction *sx, GHashTable *bindings,
+                           GHashTable **parser_vars, GList **creation_errors,
+                           gnc_numeric *numeric)
+{
+    char *parseErrorLoc = NULL;
+
+    if ((bindings == NULL || g_hash_table_size (bindings) == 0) &&
+        formula->has_numeric)
+    {
+        *numeric = formula->numeric;
+        return;
+    }
+    if (formula->formula == NULL || *formula->formula == '\0')
+        return;
+    if (formula->is_constant)
+    {
+        *numeric = formula->constant;
+        return;
+    }
+    if (bindings && !*parser_vars)
+        *parser_vars = gnc_sx_instance_get_variables_for_parser (bindings);
+    if (formula->compiled
+        ? !gnc_exp_parser_evaluate (formula->compiled, numeric,
+                                    &parseErrorLoc, *parser_vars)
+        : !gnc_exp_parser_parse_separate_vars (formula->formula, numeric,
+                                               &parseErrorLoc, *parser_vars))
+    {
+        gchar *err = N_("Error parsing SX [%s] key [%s]=formula [%s] at [%s]: %s.");
+        REPORT_ERROR(creation_errors, err,
+                     xaccSchedXactionGetName (sx),
+                     formula->key,
+                     formula->formula,
+                     parseErrorLoc,
+                     gnc_exp_parser_error_string ());
+    }
+}
+
 static gnc_numeric
-split_apply_formulas (const Split *split, SxTxnCreationData* creation_data)
+split_apply_formulas (const Split *split, SxTxnCreationData* creation_data,
+                      const SxTemplateSplit *cached)
 {
     gnc_numeric credit_num = gnc_numeric_zero();
     gnc_numeric debit_num = gnc_numeric_zero();
@@ -1083,10 +1192,23 @@ split_apply_formulas (const Split *split, SxTxnCreationData* creation_data)
     gint gncn_error;
     SchedXaction *sx = creation_data->instance->parent->sx;
 
-    _get_credit_formula_value(creation_data->instance, split, &credit_num,
-                              creation_data->creation_errors);
-    _get_debit_formula_value(creation_data->instance, split, &debit_num,
-                             creation_data->creation_errors);
+    if (cached)
+    {
+        GHashTable *bindings = creation_data->instance->variable_bindings;
+        sx_template_formula_value (&cached->credit, sx, bindings,
+                                   &creation_data->parser_vars,
+                                   creation_data->creation_errors, &credit_num);
+        sx_template_formula_value (&cached->debit, sx, bindings,
+                                   &creation_data->parser_vars,
+                                   creation_data->creation_errors, &debit_num);
+    }
+    else
+    {
+        _get_credit_formula_value(creation_data->instance, split, &credit_num,
+                                  creation_data->creation_errors);
+        _get_debit_formula_value(creation_data->instance, split, &debit_num,
+                                 creation_data->creation_errors);
+    }
 
     final = gnc_numeric_sub_fixed(debit_num, credit_num);
 
@@ -1214,8 +1336,10 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
     Split *copying_split;
     SxTxnCreationData *creation_data = (SxTxnCreationData*)user_data;
     SchedXaction *sx = creation_data->instance->parent->sx;
-    gnc_commodity *txn_cmdty = get_transaction_currency (creation_data,
-                                                         sx, template_txn);
+    SxTemplateTxn *cached_txn = creation_data->template_txn;
+    GList *cached_splits = cached_txn ? cached_txn->splits : NULL;
+    gnc_commodity *txn_cmdty = cached_txn ? cached_txn->currency :
+        get_transaction_currency (creation_data, sx, template_txn);
 
     /* No txn_cmdty means there was a defective split. Bail. */
     if (txn_cmdty == NULL)
@@ -1268,6 +1392,7 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
          txn_splits = txn_splits->next, template_splits = template_splits->next)
     {
         const Split *template_split;
+        const SxTemplateSplit *cached_split = NULL;
         Account *split_acct;
         gnc_commodity *split_cmdty = NULL;
 
@@ -1277,15 +1402,23 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
         template_split = (Split*)template_splits->data;
         copying_split = (Split*)txn_splits->data;
 
-        _get_template_split_account(sx, template_split, &split_acct,
-                                    creation_data->creation_errors);
+        if (cached_splits)
+        {
+            cached_split = (SxTemplateSplit*)cached_splits->data;
+            cached_splits = cached_splits->next;
+            split_acct = cached_split->account;
+        }
+        else
+            _get_template_split_account(sx, template_split, &split_acct,
+                                        creation_data->creation_errors);
 
         split_cmdty = xaccAccountGetCommodity(split_acct);
         xaccSplitSetAccount(copying_split, split_acct);
 
         {
             gnc_numeric final = split_apply_formulas(template_split,
-                                                     creation_data);
+                                                     creation_data,
+                                                     cached_split);
             xaccSplitSetValue(copying_split, final);
             g_debug("value is %s for memo split '%s'",
                     gnc_numeric_to_string (final),
@@ -1332,6 +1465,8 @@ create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_gu
     creation_data.instance = instance;
     creation_data.created_txn_guids = created_txn_guids;
     creation_data.creation_errors = creation_errors;
+    creation_data.template_txn = NULL;
+    creation_data.parser_vars = NULL;
     /* Don't update the GUI for every transaction, it can really slow things
      * down.
      */
@@ -1342,20 +1477,175 @@ create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_gu
     qof_event_resume();
 }
 
-void
-gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
-                                    gboolean auto_create_only,
-                                    GList **created_transaction_guids,
-                                    GList **creation_errors)
+/* Creating many instances at once, each SX's template transactions are
+ * read once, with their accounts, currencies and formulas, rather than
+ * once per instance. The accounts the instances go to are held open for
+ * editing until the end, so they're sorted and their balances computed
+ * once, and events are held back for the whole run. The SXs changed are
+ * sent their modify events afterwards. */
+typedef struct
 {
-    GList *iter;
+    GHashTable *templates;      /* SchedXaction* -> GList* of SxTemplateTxn* */
+    GHashTable *accounts;       /* Account* being edited */
+    GList *sxes;                /* SchedXaction* changed */
+} SxBatch;
 
-    if (qof_book_is_readonly(gnc_get_current_book()))
+static void
+sx_template_txn_free (SxTemplateTxn *template_txn)
+{
+    GList *node;
+    for (node = template_txn->splits; node; node = node->next)
     {
-        /* Is the book read-only? Then don't change anything here. */
+        SxTemplateSplit *split = (SxTemplateSplit*)node->data;
+        g_free (split->credit.formula);
+        g_free (split->debit.formula);
+        gnc_exp_expression_unref (split->credit.compiled);
+        gnc_exp_expression_unref (split->debit.compiled);
+        g_free (split);
+    }
+    g_list_free (template_txn->splits);
+    g_free (template_txn);
+}
+
+static void
+sx_template_txns_free (gpointer template_txns)
+{
+    g_list_free_full ((GList*)template_txns, (GDestroyNotify)sx_template_txn_free);
+}
+
+static gboolean
+sx_batch_add_template_txn (Transaction *txn, gpointer user_data)
+{
+    GList **template_txns = (GList**)user_data;
+    SxTemplateTxn *template_txn = g_new0 (SxTemplateTxn, 1);
+    GList *node;
+
+    template_txn->txn = txn;
+    for (node = xaccTransGetSplitList (txn); node; node = node->next)
+    {
+        SxTemplateSplit *split = g_new0 (SxTemplateSplit, 1);
+        split->split = (Split*)node->data;
+        sx_template_formula_init (&split->credit, split->split,
+                                  "sx-credit-formula", "sx-credit-numeric");
+        sx_template_formula_init (&split->debit, split->split,
+                                  "sx-debit-formula", "sx-debit-numeric");
+        template_txn->splits = g_list_prepend (template_txn->splits, split);
+    }
+    template_txn->splits = g_list_reverse (template_txn->splits);
+    *template_txns = g_list_prepend (*template_txns, template_txn);
+    return FALSE;
+}
+
+/* Returns NULL in *usable if one of the templates has a split without an
+ * account; instances of that SX are then created the usual way, which
+ * reports the error for each. */
+static GList*
+sx_batch_get_templates (SxBatch *batch, SchedXaction *sx, gboolean *usable)
+{
+    GList *template_txns = NULL, *node, *split_node;
+    SxTxnCreationData no_errors = { NULL, NULL, NULL, NULL, NULL };
+    gpointer found;
+
+    if (g_hash_table_lookup_extended (batch->templates, sx, NULL, &found))
+    {
+        *usable = found != NULL;
+        return (GList*)found;
+    }
+
+    xaccAccountForEachTransaction (gnc_sx_get_template_transaction_account (sx),
+                                   sx_batch_add_template_txn, &template_txns);
+    template_txns = g_list_reverse (template_txns);
+    *usable = TRUE;
+    for (node = template_txns; node && *usable; node = node->next)
+    {
+        SxTemplateTxn *template_txn = (SxTemplateTxn*)node->data;
+        for (split_node = template_txn->splits; split_node;
+             split_node = split_node->next)
+        {
+            SxTemplateSplit *split = (SxTemplateSplit*)split_node->data;
+            if (!_get_template_split_account (sx, split->split,
+                                              &split->account, NULL))
+            {
+                *usable = FALSE;
+                break;
+            }
+        }
+        if (*usable)
+            template_txn->currency =
+                get_transaction_currency (&no_errors, sx, template_txn->txn);
+    }
+    if (!*usable)
+    {
+        sx_template_txns_free (template_txns);
+        template_txns = NULL;
+    }
+
+    for (node = template_txns; node; node = node->next)
+    {
+        SxTemplateTxn *template_txn = (SxTemplateTxn*)node->data;
+        for (split_node = template_txn->splits; split_node;
+             split_node = split_node->next)
+        {
+            Account *account = ((SxTemplateSplit*)split_node->data)->account;
+            if (!g_hash_table_contains (batch->accounts, account))
+            {
+                xaccAccountBeginEdit (account);
+                g_hash_table_add (batch->accounts, account);
+            }
+        }
+    }
+    g_hash_table_insert (batch->templates, sx, template_txns);
+    return template_txns;
+}
+
+static void
+create_transactions_for_instance_batched (SxBatch *batch,
+                                          GncSxInstance *instance,
+                                          GList **created_txn_guids,
+                                          GList **creation_errors)
+{
+    SxTxnCreationData creation_data;
+    gboolean usable;
+    GList *template_txns = sx_batch_get_templates (batch, instance->parent->sx,
+                                                   &usable);
+    GList *node;
+
+    if (!usable)
+    {
+        create_transactions_for_instance (instance, created_txn_guids,
+                                          creation_errors);
         return;
     }
 
+    creation_data.instance = instance;
+    creation_data.created_txn_guids = created_txn_guids;
+    creation_data.creation_errors = creation_errors;
+    creation_data.parser_vars = NULL;
+    for (node = template_txns; node; node = node->next)
+    {
+        creation_data.template_txn = (SxTemplateTxn*)node->data;
+        create_each_transaction_helper (creation_data.template_txn->txn,
+                                        &creation_data);
+    }
+    if (creation_data.parser_vars)
+        g_hash_table_destroy (creation_data.parser_vars);
+}
+
+static void
+sx_batch_commit_account (gpointer key, gpointer value, gpointer user_data)
+{
+    xaccAccountCommitEdit ((Account*)key);
+}
+
+static void
+effect_change_internal (GncSxInstanceModel *model,
+                        gboolean auto_create_only,
+                        GList **created_transaction_guids,
+                        GList **creation_errors,
+                        SxBatch *batch)
+{
+    GList *iter;
+
     for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
     {
         GList *instance_iter;
@@ -1363,6 +1653,8 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         GDate *last_occur_date;
         gint instance_count = 0;
         gint remain_occur_count = 0;
+        gint64 start_time = g_get_monotonic_time ();
+        gint created = 0;
 
         // If there are no instances, then skip; specifically, skip
         // re-setting SchedXaction fields, which will dirty the book
@@ -1416,11 +1708,17 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                     increment_sx_state(inst, &last_occur_date, &instance_count, &remain_occur_count);
                     break;
                 case SX_INSTANCE_STATE_TO_CREATE:
-                    create_transactions_for_instance (inst,
-                                                      created_transaction_guids,
-                                                      &instance_errors);
+                    if (batch)
+                        create_transactions_for_instance_batched (batch, inst,
+                                                                  created_transaction_guids,
+                                                                  &instance_errors);
+                    else
+                        create_transactions_for_instance (inst,
+                                                          created_transaction_guids,
+                                                          &instance_errors);
                     if (instance_errors == NULL)
                     {
+                        created++;
                         increment_sx_state (inst, &last_occur_date,
                                             &instance_count,
                                             &remain_occur_count);
@@ -1444,9 +1742,68 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         xaccSchedXactionSetLastOccurDate(instances->sx, last_occur_date);
         gnc_sx_set_instance_count(instances->sx, instance_count);
         xaccSchedXactionSetRemOccur(instances->sx, remain_occur_count);
+        if (batch)
+        {
+            batch->sxes = g_list_prepend (batch->sxes, instances->sx);
+            g_debug("SX [%s]: created %d instances in %" G_GINT64_FORMAT " us",
+                    xaccSchedXactionGetName(instances->sx), created,
+                    g_get_monotonic_time () - start_time);
+        }
     }
 }
 
+void
+gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
+                                    gboolean auto_create_only,
+                                    GList **created_transaction_guids,
+                                    GList **creation_errors)
+{
+    if (qof_book_is_readonly(gnc_get_current_book()))
+    {
+        /* Is the book read-only? Then don't change anything here. */
+        return;
+    }
+    effect_change_internal (model, auto_create_only,
+                            created_transaction_guids, creation_errors, NULL);
+}
+
+void
+gnc_sx_instance_model_effect_change_batched(GncSxInstanceModel *model,
+                                            gboolean auto_create_only,
+                                            GList **created_transaction_guids,
+                                            GList **creation_errors)
+{
+    SxBatch batch;
+    GList *node;
+    gint64 start_time;
+
+    if (qof_book_is_readonly(gnc_get_current_book()))
+    {
+        /* Is the book read-only? Then don't change anything here. */
+        return;
+    }
+
+    start_time = g_get_monotonic_time ();
+    batch.templates = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL, sx_template_txns_free);
+    batch.accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+    batch.sxes = NULL;
+    qof_event_suspend();
+    effect_change_internal (model, auto_create_only,
+                            created_transaction_guids, creation_errors, &batch);
+    g_hash_table_foreach (batch.accounts, sx_batch_commit_account, NULL);
+    qof_event_resume();
+    /* Let the other instance models, e.g. the Scheduled Transactions
+     * page, see the new state of the SXs. */
+    for (node = batch.sxes; node; node = node->next)
+        qof_event_gen (QOF_INSTANCE (node->data), QOF_EVENT_MODIFY, NULL);
+    g_list_free (batch.sxes);
+    g_hash_table_destroy (batch.accounts);
+    g_hash_table_destroy (batch.templates);
+    g_debug("Created the scheduled transactions in %" G_GINT64_FORMAT " us",
+            g_get_monotonic_time () - start_time);
+}
+
 void
 gnc_sx_instance_model_change_instance_state(GncSxInstanceModel *model,
                                             GncSxInstance *instance,
@@ -1617,14 +1974,6 @@ GHashTable* gnc_g_hash_new_guid_numeric()
                                   NULL, gnc_numeric_free);
 }
 
-typedef struct
-{
-    GHashTable *hash;
-    GList **creation_errors;
-    const SchedXaction *sx;
-    gnc_numeric count;
-} SxCashflowData;
-
 static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_numeric* amount)
 {
     /* Do we have a number belonging to this GUID in the hash? If yes,
@@ -1684,178 +2033,484 @@ static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_
             gnc_num_dbg_to_string(*elem));
 }
 
-static gboolean
-create_cashflow_helper(Transaction *template_txn, void *user_data)
+/* Cash flow projection.
+ *
+ * The cash flow of the SXes over a range takes the dates each SX occurs
+ * on and the amount each of its template splits moves. Without
+ * variable bindings the amounts are the same for every occurrence, so
+ * the template formulas are read and evaluated once per SX. The dates
+ * only depend on the SX's recurrence, so they are found for several
+ * SXes at once on different threads; the formulas are evaluated on the
+ * calling thread since the expression parser keeps global state and can
+ * call into Scheme. The flows are kept per account, merged by date with
+ * a running total, so the flow over part of the range or the lowest
+ * balance reached is found without going back to the SXes. */
+
+struct _GncSxCashflow
+{
+    GDate range_start;
+    GDate range_end;
+    GHashTable *flows;          /* Account* -> GArray* of GncSxCashflowItem */
+};
+
+typedef struct
+{
+    Account *account;
+    gnc_numeric amount;
+} SxCashflowSplit;
+
+typedef struct
+{
+    const SchedXaction *sx;
+    GArray *dates;              /* GDate, the occurrences in the range */
+} SxCashflowOccurrences;
+
+typedef struct
+{
+    SxCashflowOccurrences *sxes;
+    gint num_sxes;
+    gint next;                  /* The next SX for a thread to take */
+    const GDate *range_start;
+    const GDate *range_end;
+} SxCashflowDates;
+
+/* Fewer SXes than this per thread aren't worth starting a thread for. */
+#define SX_CASHFLOW_SXES_PER_THREAD 16
+
+static gpointer
+sx_cashflow_dates_worker (gpointer user_data)
+{
+    SxCashflowDates *work = (SxCashflowDates*)user_data;
+    gint i;
+
+    while ((i = g_atomic_int_add (&work->next, 1)) < work->num_sxes)
+        gnc_sx_get_occur_dates_daterange (work->sxes[i].sx, work->range_start,
+                                          work->range_end,
+                                          work->sxes[i].dates);
+    return NULL;
+}
+
+static void
+sx_cashflow_find_dates (SxCashflowDates *work)
+{
+    GPtrArray *threads = g_ptr_array_new ();
+    gint num_threads = MIN ((gint)g_get_num_processors (),
+                            work->num_sxes / SX_CASHFLOW_SXES_PER_THREAD);
+    gint i;
+
+    for (i = 1; i < num_threads; ++i)
+    {
+        GError *error = NULL;
+        GThread *thread = g_thread_try_new ("sx-cashflow",
+                                            sx_cashflow_dates_worker,
+                                            work, &error);
+        if (!thread)
+        {
+            g_warning ("Finding SX dates with %d threads: %s", i,
+                       error->message);
+            g_error_free (error);
+            break;
+        }
+        g_ptr_array_add (threads, thread);
+    }
+    sx_cashflow_dates_worker (work);
+    for (i = 0; i < (gint)threads->len; ++i)
+        g_thread_join ((GThread*)g_ptr_array_index (threads, i));
+    g_ptr_array_free (threads, TRUE);
+}
+
+static void
+sx_cashflow_add_template_txn (const SchedXaction *sx,
+                              const SxTemplateTxn *template_txn,
+                              GArray *splits, GList **creation_errors)
 {
-    SxCashflowData *creation_data = user_data;
-    GList *template_splits;
     const gnc_commodity *first_cmdty = NULL;
+    GHashTable *parser_vars = NULL;
+    GList *node;
 
     g_debug("Evaluating txn desc [%s] for sx [%s]",
-            xaccTransGetDescription(template_txn),
-            xaccSchedXactionGetName(creation_data->sx));
-
-    template_splits = xaccTransGetSplitList(template_txn);
+            xaccTransGetDescription(template_txn->txn),
+            xaccSchedXactionGetName(sx));
 
-    if (template_splits == NULL)
+    if (template_txn->splits == NULL)
     {
         g_critical("transaction w/o splits for sx [%s]",
-                   xaccSchedXactionGetName(creation_data->sx));
-        return FALSE;
+                   xaccSchedXactionGetName(sx));
+        return;
     }
 
-    for (;
-         template_splits;
-         template_splits = template_splits->next)
+    for (node = template_txn->splits; node; node = node->next)
     {
-        Account *split_acct;
-        const gnc_commodity *split_cmdty = NULL;
-        const Split *template_split = (const Split*) template_splits->data;
+        const SxTemplateSplit *template_split = (SxTemplateSplit*)node->data;
+        const gnc_commodity *split_cmdty;
+        gnc_numeric credit_num = gnc_numeric_zero();
+        gnc_numeric debit_num = gnc_numeric_zero();
+        SxCashflowSplit split;
+        gint gncn_error;
 
         /* Get the account that should be used for this split. */
-        if (!_get_template_split_account(creation_data->sx, template_split, &split_acct, creation_data->creation_errors))
+        if (!_get_template_split_account(sx, template_split->split,
+                                         &split.account, creation_errors))
         {
             g_debug("Could not find account for split");
             break;
         }
 
         /* The split's account also has some commodity */
-        split_cmdty = xaccAccountGetCommodity(split_acct);
+        split_cmdty = xaccAccountGetCommodity(split.account);
         if (first_cmdty == NULL)
-        {
             first_cmdty = split_cmdty;
-            //xaccTransSetCurrency(new_txn, first_cmdty);
+
+        sx_template_formula_value (&template_split->credit, sx, NULL,
+                                   &parser_vars, creation_errors, &credit_num);
+        sx_template_formula_value (&template_split->debit, sx, NULL,
+                                   &parser_vars, creation_errors, &debit_num);
+
+        /* The cash flow of each occurrence: debit minus credit. */
+        split.amount = gnc_numeric_sub_fixed (debit_num, credit_num);
+
+        gncn_error = gnc_numeric_check(split.amount);
+        if (gncn_error != GNC_ERROR_OK)
+        {
+            gchar* err = N_("Error %d in SX [%s] final gnc_numeric value, using 0 instead.");
+            REPORT_ERROR(creation_errors, err,
+                         gncn_error, xaccSchedXactionGetName(sx));
+            split.amount = gnc_numeric_zero();
         }
 
+        /* Print error message if we would have needed an exchange rate */
+        if (! gnc_commodity_equal(split_cmdty, first_cmdty))
         {
-            gnc_numeric credit_num = gnc_numeric_zero();
-            gnc_numeric debit_num = gnc_numeric_zero();
-            gnc_numeric final_once, final;
-            gint gncn_error;
-
-            /* Credit value */
-            _get_sx_formula_value(creation_data->sx, template_split,
-				  &credit_num, creation_data->creation_errors,
-				  "sx-credit-formula", "sx-credit-numeric",
-				  NULL);
-            /* Debit value */
-            _get_sx_formula_value(creation_data->sx, template_split,
-				  &debit_num, creation_data->creation_errors,
-				  "sx-debit-formula", "sx-debit-numeric", NULL);
-
-            /* The resulting cash flow number: debit minus credit,
-             * multiplied with the count factor. */
-            final_once = gnc_numeric_sub_fixed( debit_num, credit_num );
-            /* Multiply with the count factor. */
-            final = gnc_numeric_mul(final_once, creation_data->count,
-                                    gnc_numeric_denom(final_once),
-                                    GNC_HOW_RND_ROUND_HALF_UP);
-
-            gncn_error = gnc_numeric_check(final);
-            if (gncn_error != GNC_ERROR_OK)
-            {
-                gchar* err = N_("Error %d in SX [%s] final gnc_numeric value, using 0 instead.");
-                REPORT_ERROR(creation_data->creation_errors, err,
-                             gncn_error, xaccSchedXactionGetName(creation_data->sx));
-                final = gnc_numeric_zero();
-            }
+            gchar *err = N_("No exchange rate available in SX [%s] for %s -> %s, value is zero.");
+            REPORT_ERROR(creation_errors, err,
+                         xaccSchedXactionGetName(sx),
+                         gnc_commodity_get_mnemonic(split_cmdty),
+                         gnc_commodity_get_mnemonic(first_cmdty));
+            split.amount = gnc_numeric_zero();
+        }
 
-            /* Print error message if we would have needed an exchange rate */
-            if (! gnc_commodity_equal(split_cmdty, first_cmdty))
-            {
-                gchar *err = N_("No exchange rate available in SX [%s] for %s -> %s, value is zero.");
-                REPORT_ERROR(creation_data->creation_errors, err,
-                             xaccSchedXactionGetName(creation_data->sx),
-                             gnc_commodity_get_mnemonic(split_cmdty),
-                             gnc_commodity_get_mnemonic(first_cmdty));
-                final = gnc_numeric_zero();
-            }
+        g_array_append_val (splits, split);
+    }
+}
 
-            /* And add the resulting value to the hash */
-            add_to_hash_amount(creation_data->hash, xaccAccountGetGUID(split_acct), &final);
+/* The amounts one occurrence of sx moves, as a GArray of
+ * SxCashflowSplit. */
+static GArray*
+sx_cashflow_get_splits (const SchedXaction *sx, GList **creation_errors)
+{
+    GArray *splits = g_array_new (FALSE, FALSE, sizeof (SxCashflowSplit));
+    Account *sx_template_account = gnc_sx_get_template_transaction_account(sx);
+    GList *template_txns = NULL, *node;
+
+    if (!sx_template_account)
+    {
+        g_critical("Huh? No template account for the SX %s", xaccSchedXactionGetName(sx));
+        return splits;
+    }
+
+    /* The cash flow numbers are in the transactions of the template
+     * account. */
+    xaccAccountForEachTransaction (sx_template_account,
+                                   sx_batch_add_template_txn, &template_txns);
+    template_txns = g_list_reverse (template_txns);
+    for (node = template_txns; node; node = node->next)
+        sx_cashflow_add_template_txn (sx, (SxTemplateTxn*)node->data, splits,
+                                      creation_errors);
+    sx_template_txns_free (template_txns);
+    return splits;
+}
+
+static void
+sx_cashflow_add_flows (GncSxCashflow *cashflow, const GArray *splits,
+                       const GArray *dates)
+{
+    guint i, j;
+
+    for (i = 0; i < splits->len; ++i)
+    {
+        const SxCashflowSplit *split = &g_array_index (splits, SxCashflowSplit, i);
+        GArray *items = g_hash_table_lookup (cashflow->flows, split->account);
+
+        if (!items)
+        {
+            items = g_array_new (FALSE, FALSE, sizeof (GncSxCashflowItem));
+            g_hash_table_insert (cashflow->flows, split->account, items);
+        }
+        for (j = 0; j < dates->len; ++j)
+        {
+            GncSxCashflowItem item;
+            item.date = g_array_index (dates, GDate, j);
+            item.amount = split->amount;
+            item.total = gnc_numeric_zero ();
+            g_array_append_val (items, item);
         }
     }
+}
 
-    return FALSE;
+/* Don't use gnc_numeric_add_fixed, it refuses to add 1/5+1/10. */
+static gnc_numeric
+sx_cashflow_add (gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER);
+}
+
+static gint
+sx_cashflow_item_compare (gconstpointer a, gconstpointer b)
+{
+    return g_date_compare (&((const GncSxCashflowItem*)a)->date,
+                           &((const GncSxCashflowItem*)b)->date);
 }
 
+/* Sorts an account's flows by date, merges those on the same date and
+ * fills in the running totals. */
 static void
-instantiate_cashflow_internal(const SchedXaction* sx,
-                              GHashTable* map,
-                              GList **creation_errors, gint count)
+sx_cashflow_finish_items (gpointer key, gpointer value, gpointer user_data)
 {
-    SxCashflowData create_cashflow_data;
-    Account* sx_template_account = gnc_sx_get_template_transaction_account(sx);
+    GArray *items = (GArray*)value;
+    gnc_numeric total = gnc_numeric_zero ();
+    guint i, len = 0;
 
-    if (!sx_template_account)
+    g_array_sort (items, sx_cashflow_item_compare);
+    for (i = 0; i < items->len; ++i)
     {
-        g_critical("Huh? No template account for the SX %s", xaccSchedXactionGetName(sx));
-        return;
+        GncSxCashflowItem *item = &g_array_index (items, GncSxCashflowItem, i);
+        GncSxCashflowItem *prev =
+            len ? &g_array_index (items, GncSxCashflowItem, len - 1) : NULL;
+        if (prev && g_date_compare (&prev->date, &item->date) == 0)
+            prev->amount = sx_cashflow_add (prev->amount, item->amount);
+        else
+            g_array_index (items, GncSxCashflowItem, len++) = *item;
+    }
+    g_array_set_size (items, len);
+    for (i = 0; i < len; ++i)
+    {
+        GncSxCashflowItem *item = &g_array_index (items, GncSxCashflowItem, i);
+        total = sx_cashflow_add (total, item->amount);
+        item->total = total;
     }
+}
 
-    if (!xaccSchedXactionGetEnabled(sx))
+static void
+sx_cashflow_items_free (gpointer items)
+{
+    g_array_free ((GArray*)items, TRUE);
+}
+
+GncSxCashflow*
+gnc_sx_cashflow_new (GList *all_sxes, const GDate *range_start,
+                     const GDate *range_end, GList **creation_errors)
+{
+    GncSxCashflow *cashflow = g_new0 (GncSxCashflow, 1);
+    gint64 start_time = g_get_monotonic_time ();
+    SxCashflowDates work;
+    GList *node;
+    gint i;
+
+    cashflow->range_start = *range_start;
+    cashflow->range_end = *range_end;
+    cashflow->flows = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL, sx_cashflow_items_free);
+
+    work.sxes = g_new0 (SxCashflowOccurrences, g_list_length (all_sxes));
+    work.num_sxes = 0;
+    work.next = 0;
+    work.range_start = range_start;
+    work.range_end = range_end;
+    for (node = all_sxes; node; node = node->next)
     {
-        g_debug("Skipping non-enabled SX [%s]",
-                xaccSchedXactionGetName(sx));
+        const SchedXaction *sx = (const SchedXaction*)node->data;
+        if (!xaccSchedXactionGetEnabled(sx))
+        {
+            g_debug("Skipping non-enabled SX [%s]",
+                    xaccSchedXactionGetName(sx));
+            continue;
+        }
+        work.sxes[work.num_sxes].sx = sx;
+        work.sxes[work.num_sxes].dates = g_array_new (FALSE, FALSE, sizeof (GDate));
+        ++work.num_sxes;
+    }
+    sx_cashflow_find_dates (&work);
+
+    for (i = 0; i < work.num_sxes; ++i)
+    {
+        SxCashflowOccurrences *occurrences = &work.sxes[i];
+        if (occurrences->dates->len > 0)
+        {
+            GArray *splits = sx_cashflow_get_splits (occurrences->sx,
+                                                     creation_errors);
+            sx_cashflow_add_flows (cashflow, splits, occurrences->dates);
+            g_array_free (splits, TRUE);
+        }
+        g_array_free (occurrences->dates, TRUE);
+    }
+    g_free (work.sxes);
+    g_hash_table_foreach (cashflow->flows, sx_cashflow_finish_items, NULL);
+
+    g_debug ("Projected the cash flow of %d SXes in %" G_GINT64_FORMAT " us",
+             work.num_sxes, g_get_monotonic_time () - start_time);
+    return cashflow;
+}
+
+GncSxCashflow*
+gnc_sx_cashflow_new_all (GDate range_start, GDate range_end)
+{
+    GList *all_sxes = gnc_book_get_schedxactions(gnc_get_current_book())->sx_list;
+    return gnc_sx_cashflow_new (all_sxes, &range_start, &range_end, NULL);
+}
+
+void
+gnc_sx_cashflow_free (GncSxCashflow *cashflow)
+{
+    if (!cashflow)
         return;
+    g_hash_table_destroy (cashflow->flows);
+    g_free (cashflow);
+}
+
+const GncSxCashflowItem*
+gnc_sx_cashflow_get_flows (const GncSxCashflow *cashflow,
+                           const Account *account, guint *num_items)
+{
+    GArray *items = g_hash_table_lookup (cashflow->flows, account);
+
+    *num_items = items ? items->len : 0;
+    return items ? (const GncSxCashflowItem*)items->data : NULL;
+}
+
+/* The index of the first item dated after date, or on or after it if
+ * on is TRUE. */
+static guint
+sx_cashflow_find (const GArray *items, const GDate *date, gboolean on)
+{
+    guint lo = 0, hi = items->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        gint cmp = g_date_compare (&g_array_index (items, GncSxCashflowItem,
+                                                   mid).date, date);
+        if (cmp < 0 || (cmp == 0 && !on))
+            lo = mid + 1;
+        else
+            hi = mid;
     }
+    return lo;
+}
 
-    create_cashflow_data.hash = map;
-    create_cashflow_data.creation_errors = creation_errors;
-    create_cashflow_data.sx = sx;
-    create_cashflow_data.count = gnc_numeric_create(count, 1);
+/* The flow before the item at index. */
+static gnc_numeric
+sx_cashflow_total_before (const GArray *items, guint index)
+{
+    return index ? g_array_index (items, GncSxCashflowItem, index - 1).total
+        : gnc_numeric_zero ();
+}
 
-    /* The cash flow numbers are in the transactions of the template
-     * account, so run this foreach on the transactions. */
-    xaccAccountForEachTransaction(sx_template_account,
-                                  create_cashflow_helper,
-                                  &create_cashflow_data);
+/* Finds the items of account between start and end, inclusive, in
+ * [*first, *last). Returns FALSE if there are none. */
+static gboolean
+sx_cashflow_find_range (const GncSxCashflow *cashflow, const Account *account,
+                        const GDate *start, const GDate *end,
+                        const GArray **items, guint *first, guint *last)
+{
+    *items = g_hash_table_lookup (cashflow->flows, account);
+    if (!*items)
+        return FALSE;
+    *first = sx_cashflow_find (*items, start, TRUE);
+    *last = sx_cashflow_find (*items, end, FALSE);
+    return *first < *last;
 }
 
-typedef struct
+/* The flow from the item at first to the one before last. */
+static gnc_numeric
+sx_cashflow_range_amount (const GArray *items, guint first, guint last)
 {
-    GHashTable *hash;
-    GList **creation_errors;
-    const GDate *range_start;
-    const GDate *range_end;
-} SxAllCashflow;
+    return gnc_numeric_sub (sx_cashflow_total_before (items, last),
+                            sx_cashflow_total_before (items, first),
+                            GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER);
+}
 
-static void instantiate_cashflow_cb(gpointer data, gpointer _user_data)
+gnc_numeric
+gnc_sx_cashflow_get_amount (const GncSxCashflow *cashflow,
+                            const Account *account,
+                            const GDate *start, const GDate *end)
 {
-    const SchedXaction* sx = (const SchedXaction*) data;
-    SxAllCashflow* userdata = (SxAllCashflow*) _user_data;
-    gint count;
+    const GArray *items;
+    guint first, last;
 
-    g_assert(sx);
-    g_assert(userdata);
+    if (!sx_cashflow_find_range (cashflow, account, start, end,
+                                 &items, &first, &last))
+        return gnc_numeric_zero ();
+    return sx_cashflow_range_amount (items, first, last);
+}
+
+gnc_numeric
+gnc_sx_cashflow_get_minimum_balance (const GncSxCashflow *cashflow,
+                                     const Account *account,
+                                     gnc_numeric balance,
+                                     const GDate *start, const GDate *end)
+{
+    gnc_numeric minimum = balance;
+    const GArray *items;
+    guint first, last, i;
+
+    if (!sx_cashflow_find_range (cashflow, account, start, end,
+                                 &items, &first, &last))
+        return minimum;
+    for (i = first; i < last; ++i)
+    {
+        gnc_numeric running =
+            sx_cashflow_add (balance, sx_cashflow_range_amount (items, first,
+                                                                i + 1));
+        if (gnc_numeric_compare (running, minimum) < 0)
+            minimum = running;
+    }
+    return minimum;
+}
+
+static void
+sx_cashflow_add_amounts (const GncSxCashflow *cashflow,
+                         const GDate *start, const GDate *end,
+                         GHashTable *map)
+{
+    GHashTableIter iter;
+    gpointer account;
 
-    /* How often does this particular SX occur in the date range? */
-    count = gnc_sx_get_num_occur_daterange(sx, userdata->range_start,
-                                           userdata->range_end);
-    if (count > 0)
+    g_hash_table_iter_init (&iter, cashflow->flows);
+    while (g_hash_table_iter_next (&iter, &account, NULL))
     {
-        /* If it occurs at least once, calculate ("instantiate") its
-         * cash flow and add it to the result
-         * g_hash<GUID,gnc_numeric> */
-        instantiate_cashflow_internal(sx,
-                                      userdata->hash,
-                                      userdata->creation_errors,
-                                      count);
+        const GArray *items;
+        guint first, last;
+        gnc_numeric amount;
+
+        /* Like the SXes, an account that has no flows in the range
+         * isn't in the map at all. */
+        if (!sx_cashflow_find_range (cashflow, account, start, end,
+                                     &items, &first, &last))
+            continue;
+        amount = sx_cashflow_range_amount (items, first, last);
+        add_to_hash_amount (map, xaccAccountGetGUID (account), &amount);
     }
 }
 
+GHashTable*
+gnc_sx_cashflow_get_amounts (const GncSxCashflow *cashflow,
+                             GDate range_start, GDate range_end)
+{
+    GHashTable *result_map = gnc_g_hash_new_guid_numeric();
+    sx_cashflow_add_amounts (cashflow, &range_start, &range_end, result_map);
+    return result_map;
+}
+
 void gnc_sx_all_instantiate_cashflow(GList *all_sxes,
                                      const GDate *range_start, const GDate *range_end,
                                      GHashTable* map, GList **creation_errors)
 {
-    SxAllCashflow userdata;
-    userdata.hash = map;
-    userdata.creation_errors = creation_errors;
-    userdata.range_start = range_start;
-    userdata.range_end = range_end;
-
-    /* The work is done in the callback for each SX */
-    g_list_foreach(all_sxes, instantiate_cashflow_cb, &userdata);
+    GncSxCashflow *cashflow = gnc_sx_cashflow_new (all_sxes, range_start,
+                                                   range_end, creation_errors);
+    sx_cashflow_add_amounts (cashflow, range_start, range_end, map);
+    gnc_sx_cashflow_free (cashflow);
 }
 
 
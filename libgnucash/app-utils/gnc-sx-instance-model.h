@@ -204,6 +204,17 @@ void gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         GList **created_transaction_guids,
         GList **creation_errors);
 
+/** Like gnc_sx_instance_model_effect_change(), for creating many
+ * instances at once: each SX's template transactions and formulas are
+ * read only once, formulas without variables are evaluated only once,
+ * and the accounts the new transactions go to are held open for editing,
+ * with events suspended, until all of them are created. The time taken
+ * for each SX is logged at debug level. */
+void gnc_sx_instance_model_effect_change_batched(GncSxInstanceModel *model,
+        gboolean auto_create_only,
+        GList **created_transaction_guids,
+        GList **creation_errors);
+
 typedef struct _GncSxSummary
 {
     gboolean need_dialog; /**< If the dialog needs to be displayed. **/
@@ -256,6 +267,63 @@ void gnc_sx_all_instantiate_cashflow(GList *all_sxes,
  * g_hash_table_destroy. */
 GHashTable* gnc_sx_all_instantiate_cashflow_all(GDate range_start, GDate range_end);
 
+/** A projection of the cash flow of a set of SXs into the accounts over
+ * a date range, kept per account by date. Each SX's template
+ * transactions are evaluated once, without variables, as
+ * gnc_sx_all_instantiate_cashflow() does, so many queries on parts of
+ * the range cost much less than instantiating the cash flow for each. */
+typedef struct _GncSxCashflow GncSxCashflow;
+
+/** The cash flow into an account on one date of a GncSxCashflow. */
+typedef struct
+{
+    GDate date;
+    gnc_numeric amount;         /**< The flow on the date. */
+    gnc_numeric total;          /**< The flow from the start of the range
+                                     up to and including the date. */
+} GncSxCashflowItem;
+
+/** Projects the cash flow of the given GList<SchedXaction*> over the
+ * date range (inclusive). Errors are reported in creation_errors, if
+ * non-NULL, as by gnc_sx_all_instantiate_cashflow(). Free the result
+ * with gnc_sx_cashflow_free(). */
+GncSxCashflow* gnc_sx_cashflow_new(GList *all_sxes,
+                                   const GDate *range_start,
+                                   const GDate *range_end,
+                                   GList **creation_errors);
+
+/** gnc_sx_cashflow_new() for all SX of the current book, ignoring any
+ * errors. */
+GncSxCashflow* gnc_sx_cashflow_new_all(GDate range_start, GDate range_end);
+
+void gnc_sx_cashflow_free(GncSxCashflow *cashflow);
+
+/** The flows into the account, in date order, one per date with a
+ * flow. The array belongs to the cash flow. */
+const GncSxCashflowItem* gnc_sx_cashflow_get_flows(const GncSxCashflow *cashflow,
+                                                   const Account *account,
+                                                   guint *num_items);
+
+/** The cash flow into the account from start to end, inclusive. Only
+ * the part inside the projected range is counted. */
+gnc_numeric gnc_sx_cashflow_get_amount(const GncSxCashflow *cashflow,
+                                       const Account *account,
+                                       const GDate *start, const GDate *end);
+
+/** The lowest balance the account reaches from start to end, inclusive,
+ * given its balance before start, counting only the SX cash flow. */
+gnc_numeric gnc_sx_cashflow_get_minimum_balance(const GncSxCashflow *cashflow,
+                                                const Account *account,
+                                                gnc_numeric balance,
+                                                const GDate *start,
+                                                const GDate *end);
+
+/** The cash flow from start to end, inclusive, of every account with a
+ * flow in that range, as gnc_sx_all_instantiate_cashflow_all() returns
+ * it. The returned value must be free'd with g_hash_table_destroy. */
+GHashTable* gnc_sx_cashflow_get_amounts(const GncSxCashflow *cashflow,
+                                        GDate range_start, GDate range_end);
+
 G_END_DECLS
 
 
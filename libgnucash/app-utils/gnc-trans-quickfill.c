@@ -0,0 +1,276 @@
+/********************************************************************\
+ * gnc-trans-quickfill.c -- Create transaction text quick-fills     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include "gnc-trans-quickfill.h"
+#include "Transaction.h"
+#include "SX-book.h"
+
+/* This static indicates the debugging module that this .o belongs to. */
+static QofLogModule log_module = GNC_MOD_REGISTER;
+
+#define TRANS_QF_KEY "gnc-trans-quickfill"
+
+typedef struct
+{
+    QuickFill *qf[GNC_TRANS_QF_NUM_FIELDS];
+    /* The number of transactions (or splits, for memos) using each
+     * string of a quickfill. The keys are copies freed with their
+     * entries. */
+    GHashTable *uses[GNC_TRANS_QF_NUM_FIELDS];
+    /* The strings counted for each transaction: its description, its
+     * notes and then the memos of its splits, with NULL for an empty
+     * one. */
+    GHashTable *trans_texts;
+    QofBook *book;
+    gint  listener;
+} TransQF;
+
+/* Counts a use of text, adds it to the quickfill and returns the
+ * table's copy of it, or NULL if it's empty. */
+static const char *
+ref_text (TransQF *qfb, GncTransQuickFillField field, const char *text)
+{
+    gpointer key, count;
+
+    if (!text || !*text)
+        return NULL;
+
+    if (g_hash_table_lookup_extended (qfb->uses[field], text, &key, &count))
+        g_hash_table_insert (qfb->uses[field], key,
+                             GUINT_TO_POINTER (GPOINTER_TO_UINT (count) + 1));
+    else
+    {
+        key = g_strdup (text);
+        g_hash_table_insert (qfb->uses[field], key, GUINT_TO_POINTER (1));
+    }
+    gnc_quickfill_insert (qfb->qf[field], text, QUICKFILL_LIFO);
+    return key;
+}
+
+/* Drops a use of text, removing it from the quickfill with the last
+ * one. */
+static void
+unref_text (TransQF *qfb, GncTransQuickFillField field, const char *text)
+{
+    guint count;
+
+    if (!text)
+        return;
+
+    count = GPOINTER_TO_UINT (g_hash_table_lookup (qfb->uses[field], text));
+    if (count > 1)
+    {
+        g_hash_table_insert (qfb->uses[field], (gpointer)text,
+                             GUINT_TO_POINTER (count - 1));
+        return;
+    }
+    gnc_quickfill_remove (qfb->qf[field], text, QUICKFILL_LIFO);
+    g_hash_table_remove (qfb->uses[field], text);
+    g_free ((gpointer)text);
+}
+
+static void
+unref_trans_texts (TransQF *qfb, GPtrArray *texts)
+{
+    guint i;
+
+    if (!texts)
+        return;
+
+    for (i = 0; i < texts->len; i++)
+        unref_text (qfb, (GncTransQuickFillField) MIN (i, GNC_TRANS_QF_MEMO),
+                    g_ptr_array_index (texts, i));
+    g_ptr_array_free (texts, TRUE);
+}
+
+/* TRUE if trans is the template of a scheduled transaction. */
+static gboolean
+trans_is_template (Transaction *trans)
+{
+    Account *template_root =
+        gnc_book_get_template_root (xaccTransGetBook (trans));
+    GList *node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Account *account = xaccSplitGetAccount (node->data);
+
+        if (account && gnc_account_get_root (account) == template_root)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+trans_cb (gpointer data, gpointer user_data)
+{
+    Transaction *trans = data;
+    TransQF *qfb = user_data;
+    GPtrArray *texts;
+    GList *node;
+
+    if (trans_is_template (trans))
+        return;
+
+    texts = g_ptr_array_new ();
+    g_ptr_array_add (texts,
+                     (gpointer)ref_text (qfb, GNC_TRANS_QF_DESCRIPTION,
+                                         xaccTransGetDescription (trans)));
+    g_ptr_array_add (texts,
+                     (gpointer)ref_text (qfb, GNC_TRANS_QF_NOTES,
+                                         xaccTransGetNotes (trans)));
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+        g_ptr_array_add (texts,
+                         (gpointer)ref_text (qfb, GNC_TRANS_QF_MEMO,
+                                             xaccSplitGetMemo (node->data)));
+
+    /* Count the new texts before dropping the old ones, so those that
+     * didn't change stay in the quickfill. */
+    unref_trans_texts (qfb, g_hash_table_lookup (qfb->trans_texts, trans));
+    g_hash_table_insert (qfb->trans_texts, trans, texts);
+}
+
+static void
+listen_for_trans_events (QofInstance *entity, QofEventId event_type,
+                         gpointer user_data, gpointer event_data)
+{
+    TransQF *qfb = user_data;
+
+    /* We listen for changes of transactions of our book, new ones are
+     * changed as they are filled in, and for their destruction, which
+     * removes the texts no other transaction uses. */
+    if (!GNC_IS_TRANSACTION (entity) ||
+        !(event_type & (QOF_EVENT_MODIFY | QOF_EVENT_DESTROY)))
+        return;
+
+    if (qof_instance_get_book (entity) != qfb->book)
+        return;
+
+    if (event_type & QOF_EVENT_MODIFY)
+        trans_cb (entity, qfb);
+    else
+    {
+        unref_trans_texts (qfb, g_hash_table_lookup (qfb->trans_texts, entity));
+        g_hash_table_remove (qfb->trans_texts, entity);
+    }
+}
+
+static void
+free_text (gpointer key, gpointer value, gpointer user_data)
+{
+    g_free (key);
+}
+
+static void
+free_trans_texts (gpointer key, gpointer value, gpointer user_data)
+{
+    g_ptr_array_free (value, TRUE);
+}
+
+static void
+shared_quickfill_destroy (QofBook *book, gpointer key, gpointer user_data)
+{
+    TransQF *qfb = user_data;
+    int i;
+
+    qof_event_unregister_handler (qfb->listener);
+    g_hash_table_foreach (qfb->trans_texts, free_trans_texts, NULL);
+    g_hash_table_destroy (qfb->trans_texts);
+    for (i = 0; i < GNC_TRANS_QF_NUM_FIELDS; i++)
+    {
+        gnc_quickfill_destroy (qfb->qf[i]);
+        g_hash_table_foreach (qfb->uses[i], free_text, NULL);
+        g_hash_table_destroy (qfb->uses[i]);
+    }
+    g_free (qfb);
+}
+
+/** Creates a new query that searches for all the transactions in the
+ * book, earliest first. */
+static QofQuery *
+new_query_for_transactions (QofBook *book)
+{
+    QofQuery *query = qof_query_create_for (GNC_ID_TRANS);
+    GSList *primary_sort_params;
+    GSList *secondary_sort_params;
+
+    qof_query_set_book (query, book);
+
+    primary_sort_params = qof_query_build_param_list (TRANS_DATE_POSTED, NULL);
+    secondary_sort_params = qof_query_build_param_list (TRANS_DATE_ENTERED,
+                            NULL);
+    qof_query_set_sort_order (query, primary_sort_params,
+                              secondary_sort_params, NULL);
+    qof_query_set_sort_increasing (query, TRUE, TRUE, TRUE);
+
+    return query;
+}
+
+static TransQF *
+build_shared_quickfill (QofBook *book)
+{
+    QofQuery *query = new_query_for_transactions (book);
+    GList *transactions = qof_query_run (query);
+    TransQF *result;
+    int i;
+
+    ENTER("book=%p, %d transactions", book, g_list_length (transactions));
+
+    result = g_new0 (TransQF, 1);
+    result->book = book;
+    for (i = 0; i < GNC_TRANS_QF_NUM_FIELDS; i++)
+    {
+        result->qf[i] = gnc_quickfill_new ();
+        result->uses[i] = g_hash_table_new (g_str_hash, g_str_equal);
+    }
+    result->trans_texts = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    g_list_foreach (transactions, trans_cb, result);
+
+    qof_query_destroy (query);
+
+    result->listener =
+        qof_event_register_handler (listen_for_trans_events, result);
+
+    qof_book_set_data_fin (book, TRANS_QF_KEY, result,
+                           shared_quickfill_destroy);
+
+    LEAVE(" ");
+    return result;
+}
+
+QuickFill *
+gnc_get_shared_trans_quickfill (QofBook *book, GncTransQuickFillField field)
+{
+    TransQF *qfb;
+
+    g_return_val_if_fail (book, NULL);
+    g_return_val_if_fail (field < GNC_TRANS_QF_NUM_FIELDS, NULL);
+
+    qfb = qof_book_get_data (book, TRANS_QF_KEY);
+
+    if (!qfb)
+        qfb = build_shared_quickfill (book);
+
+    return qfb->qf[field];
+}
@@ -0,0 +1,67 @@
+/********************************************************************\
+ * gnc-trans-quickfill.h -- Create transaction text quick-fills     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup QuickFill Auto-complete typed user input.
+   @{
+*/
+/** Like the @ref Account_QuickFill account name quickfill, these are
+ * cached quickfills of the descriptions, notes and split memos of all
+ * the transactions of a book, shared by all the registers of the book.
+*/
+
+#ifndef GNC_TRANS_QUICKFILL_H
+#define GNC_TRANS_QUICKFILL_H
+
+#include "qof.h"
+#include "QuickFill.h"
+
+/** The transaction texts which have a shared quickfill. */
+typedef enum
+{
+    GNC_TRANS_QF_DESCRIPTION,
+    GNC_TRANS_QF_NOTES,
+    GNC_TRANS_QF_MEMO,
+    GNC_TRANS_QF_NUM_FIELDS
+} GncTransQuickFillField;
+
+/** Create/fetch the quickfill of one of the texts of the transactions
+ *  of a book.
+ *
+ *  The quickfills of a book are built together, on the first call,
+ *  from all its transactions in the order they were posted, so the
+ *  latest use of a string wins; scheduled transaction templates are
+ *  left out. This code then listens to transaction changes and adds
+ *  their texts to the quickfills. The uses of each string are counted
+ *  and it's removed when the last transaction using it is changed or
+ *  deleted.
+ *
+ * \param book The book
+ * \param field The text to complete
+ *
+ * \return The shared QuickFill object, which belongs to the book.
+ */
+QuickFill * gnc_get_shared_trans_quickfill (QofBook *book,
+        GncTransQuickFillField field);
+
+#endif
+
+/** @} */
+/** @} */
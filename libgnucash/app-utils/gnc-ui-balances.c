@@ -29,13 +29,330 @@
 #include "gnc-ui-util.h"
 
 #include <glib.h>
+#include <string.h>
 
 #include "Account.h"
+#include "gncInvoice.h"
 #include "gncOwner.h"
+#include "gnc-lot.h"
+#include "gnc-pricedb.h"
 #include "qof.h"
 
 G_GNUC_UNUSED static QofLogModule log_module = GNC_MOD_GUI;
 
+/********************************************************************
+ * Balance cache
+ *
+ * The account and owner trees, their sort functions and the
+ * reconcile window ask for the same balances over and over. The
+ * results are kept per book, keyed by the account or owner, the
+ * function computing the balance, the date, the target commodity and
+ * whether sub-accounts are included. Balances are stored before the
+ * sign is reversed for display, so the reverse balance preference
+ * needs no invalidation.
+ *
+ * An event on an account drops its balances and the recursive
+ * balances of its ancestors. An event on a lot drops the balances of
+ * its owner, as the owner's own balance cache does in the engine.
+ * Price changes drop the balances that were converted, and a new day
+ * drops everything because present and projected balances depend on
+ * the date. Changes made with events suspended are followed by a
+ * forced refresh, which flushes the cache.
+ ********************************************************************/
+
+#define BALANCE_CACHE_KEY "gnc-ui-balance-cache"
+
+typedef struct
+{
+    xaccGetBalanceInCurrencyFn fn;
+    xaccGetBalanceAsOfDateFn as_of_fn;
+    time64 date;
+    const gnc_commodity *commodity;
+    gboolean recurse;
+} BalanceKey;
+
+typedef struct
+{
+    BalanceKey key;
+    gnc_numeric balance;
+    /* TRUE if computing the balance used the price database */
+    gboolean converted;
+} BalanceEntry;
+
+typedef struct
+{
+    QofBook *book;
+    gint listener;
+    time64 today;
+    /* Account or owner instance -> hash table of BalanceEntry */
+    GHashTable *accounts;
+    GHashTable *owners;
+    guint hits;
+    guint misses;
+} BalanceCache;
+
+static guint
+balance_key_hash (gconstpointer data)
+{
+    const BalanceKey *key = data;
+    guint hash;
+
+    hash = (guint) (gsize) key->fn;
+    hash = hash * 31 + (guint) (gsize) key->as_of_fn;
+    hash = hash * 31 + (guint) key->date;
+    hash = hash * 31 + g_direct_hash (key->commodity);
+    return hash * 2 + (key->recurse ? 1 : 0);
+}
+
+static gboolean
+balance_key_equal (gconstpointer a, gconstpointer b)
+{
+    const BalanceKey *ka = a;
+    const BalanceKey *kb = b;
+
+    return (ka->fn == kb->fn && ka->as_of_fn == kb->as_of_fn &&
+            ka->date == kb->date && ka->commodity == kb->commodity &&
+            !ka->recurse == !kb->recurse);
+}
+
+static gboolean
+balance_entry_is_recursive (gpointer key, gpointer value, gpointer user_data)
+{
+    BalanceEntry *entry = value;
+    return entry->key.recurse;
+}
+
+static gboolean
+balance_entry_is_converted (gpointer key, gpointer value, gpointer user_data)
+{
+    BalanceEntry *entry = value;
+    return entry->converted;
+}
+
+static void
+balance_table_drop_converted (gpointer key, gpointer value, gpointer user_data)
+{
+    g_hash_table_foreach_remove (value, balance_entry_is_converted, NULL);
+}
+
+static void
+balance_cache_flush (BalanceCache *cache)
+{
+    g_hash_table_remove_all (cache->accounts);
+    g_hash_table_remove_all (cache->owners);
+}
+
+static void
+balance_cache_drop_lot_owner (BalanceCache *cache, GNCLot *lot)
+{
+    GncOwner lot_owner;
+    const GncOwner *owner = NULL;
+    GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
+
+    if (invoice)
+        owner = gncInvoiceGetOwner (invoice);
+    else if (gncOwnerGetOwnerFromLot (lot, &lot_owner))
+        owner = &lot_owner;
+
+    if (!owner || !gncOwnerIsValid (owner))
+    {
+        /* A lot being destroyed may have lost its owner already. */
+        g_hash_table_remove_all (cache->owners);
+        return;
+    }
+
+    /* A job's lots count for the job and for its customer or vendor. */
+    g_hash_table_remove (cache->owners, qofOwnerGetOwner (owner));
+    g_hash_table_remove (cache->owners,
+                         qofOwnerGetOwner (gncOwnerGetEndOwner (owner)));
+}
+
+static void
+balance_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                             gpointer user_data, gpointer event_data)
+{
+    BalanceCache *cache = user_data;
+
+    if (event_type == QOF_EVENT_CREATE ||
+        qof_instance_get_book (entity) != cache->book)
+        return;
+
+    if (GNC_IS_PRICE (entity))
+    {
+        g_hash_table_foreach (cache->accounts, balance_table_drop_converted,
+                              NULL);
+        g_hash_table_foreach (cache->owners, balance_table_drop_converted,
+                              NULL);
+        return;
+    }
+
+    if (GNC_IS_LOT (entity))
+    {
+        balance_cache_drop_lot_owner (cache, GNC_LOT (entity));
+        return;
+    }
+
+    if (g_hash_table_remove (cache->owners, entity))
+        return;
+
+    if (GNC_IS_ACCOUNT (entity))
+    {
+        Account *parent;
+
+        g_hash_table_remove (cache->accounts, entity);
+
+        /* A destroyed account was removed from its parent before. */
+        if (event_type & QOF_EVENT_DESTROY)
+            return;
+
+        for (parent = gnc_account_get_parent (GNC_ACCOUNT (entity)); parent;
+             parent = gnc_account_get_parent (parent))
+        {
+            GHashTable *table = g_hash_table_lookup (cache->accounts, parent);
+            if (table)
+                g_hash_table_foreach_remove (table, balance_entry_is_recursive,
+                                             NULL);
+        }
+    }
+}
+
+static void
+balance_cache_destroy (QofBook *book, gpointer key, gpointer user_data)
+{
+    BalanceCache *cache = user_data;
+
+    PINFO ("balance cache of book %p: %u hits, %u misses", book,
+           cache->hits, cache->misses);
+    qof_event_unregister_handler (cache->listener);
+    g_hash_table_destroy (cache->accounts);
+    g_hash_table_destroy (cache->owners);
+    g_free (cache);
+}
+
+static BalanceCache *
+balance_cache_get (QofBook *book, gboolean create)
+{
+    BalanceCache *cache;
+    time64 today;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    cache = qof_book_get_data (book, BALANCE_CACHE_KEY);
+    if (!cache)
+    {
+        if (!create)
+            return NULL;
+
+        cache = g_new0 (BalanceCache, 1);
+        cache->book = book;
+        cache->accounts = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                          NULL, (GDestroyNotify) g_hash_table_destroy);
+        cache->owners = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                        NULL, (GDestroyNotify) g_hash_table_destroy);
+        cache->listener =
+            qof_event_register_handler (balance_cache_event_handler, cache);
+        qof_book_set_data_fin (book, BALANCE_CACHE_KEY, cache,
+                               balance_cache_destroy);
+    }
+
+    today = gnc_time64_get_today_start ();
+    if (cache->today != today)
+    {
+        balance_cache_flush (cache);
+        cache->today = today;
+    }
+
+    return cache;
+}
+
+static gboolean
+balance_cache_lookup (BalanceCache *cache, gboolean owner,
+                      gconstpointer entity, const BalanceKey *key,
+                      gnc_numeric *balance)
+{
+    GHashTable *table;
+    BalanceEntry *entry = NULL;
+
+    if (!cache)
+        return FALSE;
+
+    table = g_hash_table_lookup (owner ? cache->owners : cache->accounts,
+                                 entity);
+    if (table)
+        entry = g_hash_table_lookup (table, key);
+
+    if (!entry)
+    {
+        cache->misses++;
+        return FALSE;
+    }
+
+    cache->hits++;
+    *balance = entry->balance;
+    return TRUE;
+}
+
+static void
+balance_cache_insert (BalanceCache *cache, gboolean owner,
+                      gpointer entity, const BalanceKey *key,
+                      gnc_numeric balance, gboolean converted)
+{
+    GHashTable *entities, *table;
+    BalanceEntry *entry;
+
+    if (!cache)
+        return;
+
+    entities = owner ? cache->owners : cache->accounts;
+    table = g_hash_table_lookup (entities, entity);
+    if (!table)
+    {
+        table = g_hash_table_new_full (balance_key_hash, balance_key_equal,
+                                       NULL, g_free);
+        g_hash_table_insert (entities, entity, table);
+    }
+
+    entry = g_new (BalanceEntry, 1);
+    entry->key = *key;
+    entry->balance = balance;
+    entry->converted = converted;
+    g_hash_table_replace (table, &entry->key, entry);
+}
+
+static void
+count_entries (gpointer key, gpointer value, gpointer user_data)
+{
+    guint *entries = user_data;
+    *entries += g_hash_table_size (value);
+}
+
+void
+gnc_ui_balances_get_cache_stats (QofBook *book, GncBalanceCacheStats *stats)
+{
+    BalanceCache *cache = balance_cache_get (book, FALSE);
+
+    g_return_if_fail (stats);
+
+    memset (stats, 0, sizeof (*stats));
+    if (!cache)
+        return;
+
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    g_hash_table_foreach (cache->accounts, count_entries, &stats->entries);
+    g_hash_table_foreach (cache->owners, count_entries, &stats->entries);
+}
+
+void
+gnc_ui_balances_flush_cache (QofBook *book)
+{
+    BalanceCache *cache = balance_cache_get (book, FALSE);
+
+    if (cache)
+        balance_cache_flush (cache);
+}
+
 /********************************************************************
  * Balance calculations related to accounts
  ********************************************************************/
@@ -65,9 +382,20 @@ gnc_ui_account_get_balance_full (xaccGetBalanceInCurrencyFn fn,
                                  gboolean *negative,
                                  const gnc_commodity *commodity)
 {
+    BalanceCache *cache;
+    BalanceKey key = { fn, NULL, 0, commodity, recurse };
     gnc_numeric balance;
 
-    balance = fn(account, commodity, recurse);
+    cache = balance_cache_get (gnc_account_get_book (account), TRUE);
+    if (!balance_cache_lookup (cache, FALSE, account, &key, &balance))
+    {
+        const gnc_commodity *acc_commodity = xaccAccountGetCommodity (account);
+
+        balance = fn(account, commodity, recurse);
+        balance_cache_insert (cache, FALSE, (gpointer) account, &key, balance,
+                              recurse || (commodity && !gnc_commodity_equiv
+                                          (commodity, acc_commodity)));
+    }
 
     /* reverse sign if needed */
     if (gnc_reverse_balance (account))
@@ -180,19 +508,16 @@ gnc_ui_account_get_print_report_balance (xaccGetBalanceInCurrencyFn fn,
 }
 
 static gnc_numeric
-account_get_balance_as_of_date (Account *account,
-                                time64 date,
-                                gboolean include_children,
-                                xaccGetBalanceAsOfDateFn fn)
+account_compute_balance_as_of_date (Account *account,
+                                    time64 date,
+                                    gboolean include_children,
+                                    xaccGetBalanceAsOfDateFn fn)
 {
     QofBook *book = gnc_account_get_book (account);
     GNCPriceDB *pdb = gnc_pricedb_get_db (book);
     gnc_numeric balance;
     gnc_commodity *currency;
 
-    if (account == NULL)
-        return gnc_numeric_zero ();
-
     currency = xaccAccountGetCommodity (account);
     balance = fn (account, date);
 
@@ -221,6 +546,31 @@ account_get_balance_as_of_date (Account *account,
         g_list_free(children);
     }
 
+    return balance;
+}
+
+static gnc_numeric
+account_get_balance_as_of_date (Account *account,
+                                time64 date,
+                                gboolean include_children,
+                                xaccGetBalanceAsOfDateFn fn)
+{
+    BalanceCache *cache;
+    BalanceKey key = { NULL, fn, date, NULL, include_children };
+    gnc_numeric balance;
+
+    if (account == NULL)
+        return gnc_numeric_zero ();
+
+    cache = balance_cache_get (gnc_account_get_book (account), TRUE);
+    if (!balance_cache_lookup (cache, FALSE, account, &key, &balance))
+    {
+        balance = account_compute_balance_as_of_date (account, date,
+                                                      include_children, fn);
+        balance_cache_insert (cache, FALSE, account, &key, balance,
+                              include_children);
+    }
+
     /* reverse sign if needed */
     if (gnc_reverse_balance (account))
         balance = gnc_numeric_neg (balance);
@@ -271,12 +621,23 @@ gnc_ui_owner_get_balance_full (GncOwner *owner,
                                gboolean *negative,
                                const gnc_commodity *commodity)
 {
+    QofInstance *inst;
+    BalanceCache *cache;
+    BalanceKey key = { NULL, NULL, 0, commodity, FALSE };
     gnc_numeric balance;
 
     if (!owner)
         return gnc_numeric_zero ();
 
-    balance = gncOwnerGetBalanceInCurrency (owner, commodity);
+    inst = qofOwnerGetOwner (owner);
+    cache = inst ? balance_cache_get (qof_instance_get_book (inst), TRUE) : NULL;
+    if (!balance_cache_lookup (cache, TRUE, inst, &key, &balance))
+    {
+        balance = gncOwnerGetBalanceInCurrency (owner, commodity);
+        balance_cache_insert (cache, TRUE, inst, &key,
+                              balance, commodity && !gnc_commodity_equiv
+                              (commodity, gncOwnerGetCurrency (owner)));
+    }
 
     /* reverse sign if needed */
     if ((gncOwnerGetType (owner) != GNC_OWNER_CUSTOMER))
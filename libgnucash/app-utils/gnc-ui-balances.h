@@ -34,6 +34,37 @@
 #include "gncOwner.h"
 #include "qof.h"
 
+/********************************************************************
+ * Balance cache
+ ********************************************************************/
+
+/** Usage statistics of the balance cache of a book. */
+typedef struct
+{
+    guint hits;
+    guint misses;
+    guint entries;
+} GncBalanceCacheStats;
+
+/** Retrieve the usage statistics of the balances cached for a book.
+ *  The account and owner balance functions below share one cache per
+ *  book, which is kept up to date from engine events.
+ *
+ * @param book   The book the balances belong to.
+ * @param stats  Filled in with the number of lookups answered from the
+ *               cache, the number computed and the number of cached
+ *               balances.
+ */
+void gnc_ui_balances_get_cache_stats (QofBook *book,
+                                      GncBalanceCacheStats *stats);
+
+/** Drop all the balances cached for a book. This is needed after
+ *  changes made while engine events were suspended.
+ *
+ * @param book   The book the balances belong to.
+ */
+void gnc_ui_balances_flush_cache (QofBook *book);
+
 /********************************************************************
  * Balance calculations related to accounts
  ********************************************************************/
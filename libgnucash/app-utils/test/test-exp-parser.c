@@ -246,12 +246,55 @@ test_variable_expressions()
     success("variable found");
 }
 
+static void
+test_compiled_expressions()
+{
+    gnc_numeric num, a = gnc_numeric_create(3, 1);
+    gchar *errLoc = NULL;
+    GHashTable *vars = g_hash_table_new(g_str_hash, g_str_equal);
+    GNCExpression *expr = gnc_exp_parser_compile("2 * a + b / 2");
+
+    do_test(expr != NULL, "compiled");
+    do_test(gnc_exp_expression_get_num_variables(expr) == 2, "two variables");
+    do_test(g_strcmp0(gnc_exp_expression_get_variable(expr, 0), "a") == 0,
+            "first variable");
+    g_hash_table_insert(vars, "a", &a);
+    do_test(gnc_exp_parser_evaluate(expr, &num, &errLoc, vars), "evaluated");
+    do_test(gnc_numeric_equal(num, gnc_numeric_create(6, 1)), "with b unset");
+    do_test(g_hash_table_size(vars) == 2, "b is found");
+    g_free(g_hash_table_lookup(vars, "b"));
+    g_hash_table_remove(vars, "b");
+    a = gnc_numeric_create(5, 1);
+    do_test(gnc_exp_parser_evaluate(expr, &num, &errLoc, vars)
+            && gnc_numeric_equal(num, gnc_numeric_create(10, 1)),
+            "evaluated again");
+    gnc_exp_expression_unref(expr);
+    g_free(g_hash_table_lookup(vars, "b"));
+    g_hash_table_remove(vars, "b");
+
+    do_test(gnc_exp_parser_compile("(a = 42) + a") == NULL,
+            "assignments are only parsed");
+    do_test(gnc_exp_parser_compile("1 +") == NULL, "errors are only parsed");
+
+    /* A negated variable stays negated, as it does in the parser. */
+    expr = gnc_exp_parser_compile("a + -a + a");
+    do_test(gnc_exp_parser_evaluate(expr, &num, &errLoc, vars)
+            && gnc_numeric_equal(num, gnc_numeric_create(-15, 1)),
+            "negated variable");
+    gnc_exp_expression_unref(expr);
+    do_test(gnc_numeric_equal(a, gnc_numeric_create(5, 1)),
+            "the caller's variable is left alone");
+    g_hash_table_destroy(vars);
+    success("compiled expressions");
+}
+
 static void
 real_main (void *closure, int argc, char **argv)
 {
     /* set_should_print_success (TRUE); */
     test_parser();
     test_variable_expressions();
+    test_compiled_expressions();
     print_test_results();
     exit(get_rv());
 }
@@ -0,0 +1,156 @@
+/********************************************************************\
+ * test-quickfill.c -- test and time the quickfill tree             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+
+#include <config.h>
+#include <glib.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "QuickFill.h"
+#include "test-stuff.h"
+
+static const char *
+match_string (QuickFill *qf, const char *prefix)
+{
+    return gnc_quickfill_string (gnc_quickfill_get_string_match (qf, prefix));
+}
+
+static gboolean
+str_equal (const char *a, const char *b)
+{
+    return a && b ? strcmp (a, b) == 0 : a == b;
+}
+
+static void
+test_lifo (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+    QuickFill *match;
+    int len;
+
+    gnc_quickfill_insert (qf, "Groceries", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "Gas", QUICKFILL_LIFO);
+    do_test (str_equal (match_string (qf, "g"), "Gas"), "latest wins");
+    do_test (str_equal (match_string (qf, "GR"), "Groceries"),
+             "case insensitive match");
+    do_test (match_string (qf, "Gx") == NULL, "no match");
+
+    /* A longer string doesn't replace its prefix. */
+    gnc_quickfill_insert (qf, "Gasoline", QUICKFILL_LIFO);
+    do_test (str_equal (match_string (qf, "Ga"), "Gas"), "prefix kept");
+    do_test (str_equal (match_string (qf, "Gaso"), "Gasoline"),
+             "longer string below prefix");
+
+    /* A shorter string does, without losing the longer one. */
+    gnc_quickfill_insert (qf, "Gro", QUICKFILL_LIFO);
+    do_test (str_equal (match_string (qf, "Gr"), "Gro"), "shorter replaces");
+    do_test (str_equal (match_string (qf, "Groc"), "Groceries"),
+             "longer string kept");
+
+    match = gnc_quickfill_get_string_match (qf, "Groc");
+    match = gnc_quickfill_get_unique_len_match (match, &len);
+    do_test (len == 5 && str_equal (gnc_quickfill_string (match), "Groceries"),
+             "unique match");
+    do_test (gnc_quickfill_get_char_match (match, 'x') == NULL,
+             "nothing after the end");
+
+    match = gnc_quickfill_get_string_match (qf, "G");
+    match = gnc_quickfill_get_unique_len_match (match, &len);
+    do_test (len == 0, "no unique match");
+
+    gnc_quickfill_remove (qf, "Gro", QUICKFILL_LIFO);
+    do_test (str_equal (match_string (qf, "Gr"), "Groceries"),
+             "removed string replaced");
+    gnc_quickfill_remove (qf, "Groceries", QUICKFILL_LIFO);
+    do_test (match_string (qf, "Gr") == NULL, "removed string gone");
+    do_test (str_equal (match_string (qf, "G"), "Gas"), "others kept");
+
+    gnc_quickfill_purge (qf);
+    do_test (match_string (qf, "G") == NULL, "purged");
+    gnc_quickfill_destroy (qf);
+}
+
+static void
+test_alpha (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+
+    gnc_quickfill_insert (qf, "Rent", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (qf, "Rebate", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (qf, "Repairs", QUICKFILL_ALPHA);
+    do_test (str_equal (match_string (qf, "Re"), "Rebate"), "first in order");
+    do_test (str_equal (match_string (qf, "Rep"), "Repairs"), "alpha subtree");
+    gnc_quickfill_destroy (qf);
+}
+
+/* Builds a quickfill of many strings sharing prefixes, as descriptions
+ * do, and reports the time and memory taken. */
+static void
+test_benchmark (void)
+{
+    const int count = 100000;
+    QuickFill *qf = gnc_quickfill_new ();
+    QuickFillStats stats;
+    gint64 start;
+    gsize chars = 0;
+    int i;
+
+    start = g_get_monotonic_time ();
+    for (i = 0; i < count; i++)
+    {
+        gchar *desc = g_strdup_printf ("Payment to vendor %d for invoice %d",
+                                       i % 5000, i);
+        chars += strlen (desc);
+        gnc_quickfill_insert (qf, desc, QUICKFILL_LIFO);
+        g_free (desc);
+    }
+    gnc_quickfill_get_stats (qf, &stats);
+    printf ("Inserted %d strings, %" G_GSIZE_FORMAT " chars, in %"
+            G_GINT64_FORMAT " ms: %u nodes, %u strings, %" G_GSIZE_FORMAT
+            " bytes\n", count, chars,
+            (g_get_monotonic_time () - start) / 1000,
+            stats.nodes, stats.texts, stats.bytes);
+
+    do_test (stats.texts == (guint) count, "strings stored once");
+    do_test (stats.nodes < chars / 4, "unshared tails not expanded");
+    do_test (str_equal (match_string (qf, "Payment to vendor 12 for invoice 99012"),
+                        "Payment to vendor 12 for invoice 99012"),
+             "lookup in large tree");
+
+    start = g_get_monotonic_time ();
+    gnc_quickfill_destroy (qf);
+    printf ("Destroyed in %" G_GINT64_FORMAT " ms\n",
+            (g_get_monotonic_time () - start) / 1000);
+}
+
+int
+main (int argc, char **argv)
+{
+    test_lifo ();
+    test_alpha ();
+    test_benchmark ();
+
+    print_test_results ();
+    exit (get_rv ());
+}
@@ -23,7 +23,9 @@ extern "C"
 #include <config.h>
 #include <stdlib.h>
 #include <glib.h>
+#include "Account.h"
 #include "SX-book.h"
+#include "Transaction.h"
 #include "gnc-date.h"
 #include "gnc-sx-instance-model.h"
 #include "gnc-ui-util.h"
@@ -213,6 +215,162 @@ test_state_changes()
     remove_sx(foo);
 }
 
+static Account*
+_make_account(QofBook *book, const char *name, gnc_commodity *currency)
+{
+    Account *acc = xaccMallocAccount(book);
+    xaccAccountBeginEdit(acc);
+    xaccAccountSetName(acc, name);
+    xaccAccountSetCommodity(acc, currency);
+    xaccAccountCommitEdit(acc);
+    gnc_account_append_child(gnc_book_get_root_account(book), acc);
+    return acc;
+}
+
+static void
+_add_template_split(Transaction *txn, Account *template_acct, Account *acc,
+                    const char *formula_key, const char *formula)
+{
+    QofBook *book = gnc_get_current_book();
+    Split *split = xaccMallocSplit(book);
+    xaccSplitSetParent(split, txn);
+    xaccSplitSetAccount(split, template_acct);
+    qof_instance_set(QOF_INSTANCE(split),
+                     "sx-account", xaccAccountGetGUID(acc),
+                     formula_key, formula,
+                     NULL);
+}
+
+static void
+test_batched_creation()
+{
+    QofBook *book = gnc_get_current_book();
+    gnc_commodity *usd =
+        gnc_commodity_table_lookup(gnc_commodity_table_get_table(book),
+                                   "ISO4217", "USD");
+    Account *bank = _make_account(book, "Bank", usd);
+    Account *rent = _make_account(book, "Rent", usd);
+    Account *template_acct;
+    Transaction *template_txn;
+    SchedXaction *sx;
+    GDate start, today;
+    GncSxInstanceModel *model;
+    GList *created = NULL, *errors = NULL;
+
+    g_date_clear(&today, 1);
+    gnc_gdate_set_today(&today);
+    start = today;
+    g_date_subtract_days(&start, 4);
+    sx = add_daily_sx("rent", &start, NULL, NULL);
+
+    template_acct = gnc_sx_get_template_transaction_account(sx);
+    template_txn = xaccMallocTransaction(book);
+    xaccTransBeginEdit(template_txn);
+    xaccTransSetCurrency(template_txn, usd);
+    xaccTransSetDescription(template_txn, "Rent");
+    _add_template_split(template_txn, template_acct, bank,
+                        "sx-credit-formula", "12.5 * 2");
+    _add_template_split(template_txn, template_acct, rent,
+                        "sx-debit-formula", "25");
+    xaccTransCommitEdit(template_txn);
+
+    model = gnc_sx_get_instances(&today, TRUE);
+    gnc_sx_instance_model_effect_change_batched(model, FALSE, &created, &errors);
+    do_test(errors == NULL, "no creation errors");
+    do_test(g_list_length(created) == 5, "one transaction a day");
+    do_test(gnc_numeric_equal(xaccAccountGetBalance(rent),
+                              gnc_numeric_create(125, 1)), "rent paid");
+    do_test(gnc_numeric_equal(xaccAccountGetBalance(bank),
+                              gnc_numeric_create(-125, 1)), "from the bank");
+
+    g_list_free(created);
+    g_object_unref(model);
+    remove_sx(sx);
+}
+
+static void
+test_cashflow()
+{
+    QofBook *book = gnc_get_current_book();
+    gnc_commodity *usd =
+        gnc_commodity_table_lookup(gnc_commodity_table_get_table(book),
+                                   "ISO4217", "USD");
+    Account *bank = _make_account(book, "Savings", usd);
+    Account *fees = _make_account(book, "Fees", usd);
+    const int num_sxes = 40;
+    GList *sxes = NULL, *node, *errors = NULL;
+    GDate start, end, third;
+    GncSxCashflow *cashflow;
+    const GncSxCashflowItem *items;
+    GHashTable *map;
+    gnc_numeric *amount;
+    guint num_items;
+    int i;
+
+    g_date_clear(&start, 1);
+    gnc_gdate_set_today(&start);
+    end = start;
+    g_date_add_days(&end, 9);
+    third = start;
+    g_date_add_days(&third, 2);
+
+    /* Enough SXes to be spread over several threads. */
+    for (i = 0; i < num_sxes; i++)
+    {
+        SchedXaction *sx = add_daily_sx("fee", &start, NULL, NULL);
+        Transaction *template_txn = xaccMallocTransaction(book);
+        Account *template_acct = gnc_sx_get_template_transaction_account(sx);
+        xaccTransBeginEdit(template_txn);
+        xaccTransSetCurrency(template_txn, usd);
+        xaccTransSetDescription(template_txn, "Fee");
+        _add_template_split(template_txn, template_acct, bank,
+                            "sx-credit-formula", "2 * 5");
+        _add_template_split(template_txn, template_acct, fees,
+                            "sx-debit-formula", "10");
+        xaccTransCommitEdit(template_txn);
+        sxes = g_list_prepend(sxes, sx);
+    }
+
+    cashflow = gnc_sx_cashflow_new(sxes, &start, &end, &errors);
+    do_test(errors == NULL, "no cash flow errors");
+    items = gnc_sx_cashflow_get_flows(cashflow, fees, &num_items);
+    do_test(num_items == 10, "one flow a day");
+    do_test(gnc_numeric_equal(items[0].amount, gnc_numeric_create(400, 1)),
+            "flows of a day are merged");
+    do_test(gnc_numeric_equal(items[9].total, gnc_numeric_create(4000, 1)),
+            "running total");
+    do_test(gnc_numeric_equal(gnc_sx_cashflow_get_amount(cashflow, fees,
+                                                         &start, &third),
+                              gnc_numeric_create(1200, 1)),
+            "amount over three days");
+    do_test(gnc_numeric_equal(gnc_sx_cashflow_get_amount(cashflow, bank,
+                                                         &third, &end),
+                              gnc_numeric_create(-3200, 1)),
+            "amount over the last eight days");
+    do_test(gnc_numeric_equal(gnc_sx_cashflow_get_minimum_balance(
+                                  cashflow, bank, gnc_numeric_create(1000, 1),
+                                  &start, &third),
+                              gnc_numeric_create(-200, 1)),
+            "minimum balance");
+    do_test(gnc_numeric_equal(gnc_sx_cashflow_get_minimum_balance(
+                                  cashflow, fees, gnc_numeric_create(1000, 1),
+                                  &start, &end),
+                              gnc_numeric_create(1000, 1)),
+            "minimum balance of a growing account");
+    gnc_sx_cashflow_free(cashflow);
+
+    map = gnc_g_hash_new_guid_numeric();
+    gnc_sx_all_instantiate_cashflow(sxes, &start, &end, map, NULL);
+    amount = (gnc_numeric*)g_hash_table_lookup(map, xaccAccountGetGUID(bank));
+    do_test(amount && gnc_numeric_equal(*amount, gnc_numeric_create(-4000, 1)),
+            "instantiated cash flow");
+    g_hash_table_destroy(map);
+
+    for (node = sxes; node; node = node->next)
+        remove_sx((SchedXaction*)node->data);
+    g_list_free(sxes);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -228,6 +386,8 @@ main(int argc, char **argv)
     }
     test_basic();
     test_state_changes();
+    test_batched_creation();
+    test_cashflow();
 
     print_test_results();
     exit(get_rv());
@@ -0,0 +1,137 @@
+/********************************************************************\
+ * test-ui-balances.c -- test the cached UI balance functions        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <stdlib.h>
+#include <glib.h>
+
+#include "Account.h"
+#include "Transaction.h"
+#include "gnc-engine.h"
+#include "gnc-ui-balances.h"
+#include "gnc-ui-util.h"
+
+#include "test-stuff.h"
+
+static Account *
+make_account (QofBook *book, Account *parent, const char *name,
+              gnc_commodity *currency)
+{
+    Account *acc = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, name);
+    xaccAccountSetType (acc, ACCT_TYPE_BANK);
+    xaccAccountSetCommodity (acc, currency);
+    xaccAccountCommitEdit (acc);
+    gnc_account_append_child (parent, acc);
+    return acc;
+}
+
+static void
+add_split (QofBook *book, Transaction *trans, Account *acc, gint64 amount)
+{
+    Split *split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+    xaccSplitSetValue (split, gnc_numeric_create (amount, 1));
+}
+
+static void
+transfer (QofBook *book, gnc_commodity *currency, Account *from, Account *to,
+          gint64 amount)
+{
+    Transaction *trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_time (NULL));
+    add_split (book, trans, from, -amount);
+    add_split (book, trans, to, amount);
+    xaccTransCommitEdit (trans);
+}
+
+static gboolean
+balance_is (Account *acc, gboolean recurse, gint64 amount)
+{
+    gnc_numeric balance =
+        gnc_ui_account_get_balance_full (xaccAccountGetBalanceInCurrency,
+                                         acc, recurse, NULL, NULL);
+    return gnc_numeric_equal (balance, gnc_numeric_create (amount, 1));
+}
+
+static void
+test_account_balances (void)
+{
+    QofBook *book = gnc_get_current_book ();
+    gnc_commodity *usd =
+        gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                    "ISO4217", "USD");
+    Account *root = gnc_book_get_root_account (book);
+    Account *bank = make_account (book, root, "Bank", usd);
+    Account *savings = make_account (book, bank, "Savings", usd);
+    Account *other = make_account (book, root, "Other", usd);
+    GncBalanceCacheStats stats;
+
+    transfer (book, usd, other, savings, 100);
+    gnc_ui_balances_flush_cache (book);
+
+    do_test (balance_is (bank, TRUE, 100), "recursive balance");
+    do_test (balance_is (bank, FALSE, 0), "own balance");
+    do_test (balance_is (bank, TRUE, 100), "recursive balance again");
+    gnc_ui_balances_get_cache_stats (book, &stats);
+    do_test (stats.misses == 2 && stats.hits == 1 && stats.entries == 2,
+             "second lookup is cached");
+
+    /* A change in a sub-account drops only the recursive balances of
+     * its ancestors. */
+    transfer (book, usd, other, savings, 50);
+    do_test (balance_is (bank, TRUE, 150), "recursive balance updated");
+    do_test (balance_is (bank, FALSE, 0), "own balance still cached");
+    gnc_ui_balances_get_cache_stats (book, &stats);
+    do_test (stats.misses == 3 && stats.hits == 2, "only the total recomputed");
+
+    do_test (gnc_numeric_equal (gnc_ui_account_get_balance_as_of_date
+                                (savings, gnc_time (NULL) + 86400, FALSE),
+                                gnc_numeric_create (150, 1)),
+             "balance as of date");
+    transfer (book, usd, savings, other, 20);
+    do_test (gnc_numeric_equal (gnc_ui_account_get_balance_as_of_date
+                                (savings, gnc_time (NULL) + 86400, FALSE),
+                                gnc_numeric_create (130, 1)),
+             "balance as of date updated");
+
+    gnc_ui_balances_flush_cache (book);
+    gnc_ui_balances_get_cache_stats (book, &stats);
+    do_test (stats.entries == 0, "cache flushed");
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    gnc_engine_init (0, NULL);
+
+    test_account_balances ();
+
+    print_test_results ();
+    exit (get_rv ());
+}
@@ -103,8 +103,12 @@ GncSqlColumnTableEntry::add_objectref_guid_to_query (QofIdTypeConst obj_name,
     if (inst == nullptr) return;
     auto guid = qof_instance_get_guid (inst);
     if (guid != nullptr)
+    {
+        gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+        (void)guid_to_string_buff (guid, guid_buf);
         vec.emplace_back (std::make_pair (std::string{m_col_name},
-                                          quote_string(guid_to_string(guid))));
+                                          quote_string(guid_buf)));
+    }
 }
 
 void
@@ -344,6 +348,11 @@ GncSqlColumnTableEntryImpl<CT_GUID>::load (const GncSqlBackend* sql_be,
         set_parameter(pObject, &guid, get_setter(obj_name), m_gobj_param_name);
 }
 
+/* GUIDs are stored as their 32 hex digits. Every table definition,
+ * object-reference column, slot guid_val and generated WHERE clause relies
+ * on that, so storing them as 16-byte binary would need a new table
+ * version and a migration of existing books; it isn't supported.
+ */
 template<> void
 GncSqlColumnTableEntryImpl<CT_GUID>::add_to_table(ColVec& vec) const noexcept
 {
@@ -360,9 +369,10 @@ GncSqlColumnTableEntryImpl<CT_GUID>::add_to_query(QofIdTypeConst obj_name,
 
     if (s != nullptr)
     {
-
+        gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+        (void)guid_to_string_buff (s, guid_buf);
         vec.emplace_back (std::make_pair (std::string{m_col_name},
-                                          quote_string(guid_to_string(s))));
+                                          quote_string(guid_buf)));
         return;
     }
 }
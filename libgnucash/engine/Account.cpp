@@ -43,7 +43,12 @@
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
 #include <numeric>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
@@ -277,6 +282,8 @@ gnc_account_init(Account* acc)
 
     priv->policy = xaccGetFIFOPolicy();
     priv->lots = NULL;
+    priv->open_lots = NULL;
+    priv->lot_work = NULL;
 
     priv->commodity = NULL;
     priv->commodity_scu = 0;
@@ -294,6 +301,8 @@ gnc_account_init(Account* acc)
 
     priv->splits = NULL;
     priv->sort_dirty = FALSE;
+    priv->placeholder_cached = FALSE;
+    priv->placeholder_stamp = 0;
 }
 
 static void
@@ -302,9 +311,15 @@ gnc_account_dispose (GObject *acctp)
     G_OBJECT_CLASS(gnc_account_parent_class)->dispose(acctp);
 }
 
+static void free_open_lot_index (AccountPrivate *priv);
+static void free_lot_work (AccountPrivate *priv);
+static void lot_work_remove_split (AccountPrivate *priv, Split *split);
+
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    free_open_lot_index (GET_PRIVATE(acctp));
+    free_lot_work (GET_PRIVATE(acctp));
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1271,6 +1286,8 @@ xaccFreeAccount (Account *acc)
         }
         g_list_free (priv->lots);
         priv->lots = NULL;
+        free_open_lot_index (priv);
+        free_lot_work (priv);
     }
 
     /* Next, clean up the splits */
@@ -1437,6 +1454,8 @@ xaccAccountCommitEdit (Account *acc)
         }
         g_list_free(priv->lots);
         priv->lots = NULL;
+        free_open_lot_index (priv);
+        free_lot_work (priv);
 
         qof_instance_set_dirty(&acc->inst);
         qof_instance_decrease_editlevel(acc);
@@ -1831,6 +1850,8 @@ gnc_account_insert_split (Account *acc, Split *s)
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
     priv->balance_dirty = TRUE;
+    if (!s->lot)
+        xaccAccountMarkSplitUnassigned (acc, s);
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1851,6 +1872,7 @@ gnc_account_remove_split (Account *acc, Split *s)
         return FALSE;
 
     priv->splits = g_list_delete_link(priv->splits, node);
+    lot_work_remove_split (priv, s);
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
@@ -1982,6 +2004,315 @@ gnc_account_set_policy (Account *acc, GNCPolicy *policy)
 /********************************************************************\
 \********************************************************************/
 
+/* Finding the earliest or latest open lot, as the FIFO and LIFO policies
+ * do for every split they assign, would otherwise mean looking at every
+ * lot the account ever had. Lots are marked dirty whenever their splits
+ * change and re-filed the next time the index is used.
+ */
+struct OpenLotIndex
+{
+    struct Key
+    {
+        time64 date;
+        uint64_t seq;   // Later insertions have higher numbers.
+        GNCLot *lot;
+    };
+    struct KeyOrder
+    {
+        bool operator()(const Key& a, const Key& b) const noexcept
+        {
+            return a.date != b.date ? a.date < b.date : a.seq > b.seq;
+        }
+    };
+    struct Entry
+    {
+        uint64_t seq;
+        time64 date;
+        bool open;
+        bool dirty;
+        GncGUID owner;  // Only valid while the lot is open.
+    };
+    struct GuidHash
+    {
+        size_t operator()(const GncGUID& guid) const noexcept
+        {
+            return guid_hash_to_guint (&guid);
+        }
+    };
+    struct GuidEqual
+    {
+        bool operator()(const GncGUID& a, const GncGUID& b) const noexcept
+        {
+            return guid_equal (&a, &b);
+        }
+    };
+    using LotSet = std::unordered_set<GNCLot*>;
+
+    std::set<Key, KeyOrder> open;
+    /* The open lots by the owner gncOwnerAttachToLot recorded, with the
+     * lots that have none under the null GUID. */
+    std::unordered_map<GncGUID, LotSet, GuidHash, GuidEqual> by_owner;
+    std::unordered_map<GNCLot*, Entry> entries;
+    std::vector<GNCLot*> dirty;
+    uint64_t next_seq;
+};
+
+static void
+free_open_lot_index (AccountPrivate *priv)
+{
+    delete priv->open_lots;
+    priv->open_lots = nullptr;
+}
+
+static void
+open_lot_index_insert (AccountPrivate *priv, GNCLot *lot)
+{
+    auto index = priv->open_lots;
+    if (!index) return;
+    index->entries[lot] = {index->next_seq++, 0, false, true};
+    index->dirty.push_back (lot);
+}
+
+static void
+open_lot_index_unfile (OpenLotIndex *index, GNCLot *lot,
+                       const OpenLotIndex::Entry& entry)
+{
+    index->open.erase ({entry.date, entry.seq, lot});
+    auto owned = index->by_owner.find (entry.owner);
+    if (owned == index->by_owner.end()) return;
+    owned->second.erase (lot);
+    if (owned->second.empty())
+        index->by_owner.erase (owned);
+}
+
+static void
+open_lot_index_remove (AccountPrivate *priv, GNCLot *lot)
+{
+    auto index = priv->open_lots;
+    if (!index) return;
+    auto entry = index->entries.find (lot);
+    if (entry == index->entries.end()) return;
+    if (entry->second.open)
+        open_lot_index_unfile (index, lot, entry->second);
+    index->entries.erase (entry);
+}
+
+static GncGUID
+lot_owner_guid (GNCLot *lot)
+{
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (lot));
+    auto slot = frame->get_slot ({GNC_OWNER_ID, GNC_OWNER_GUID});
+    if (slot && slot->get_type () == KvpValue::Type::GUID)
+        return *slot->get<GncGUID*> ();
+    return *guid_null ();
+}
+
+/* Lots and splits are kept in the order they were marked so that
+ * scrubbing them is repeatable. Removing an item only drops it from the
+ * set; the vectors can hold stale entries and are filtered when the work
+ * is taken. Accounts without trades don't record anything. */
+struct LotWork
+{
+    bool recording = true;
+    std::vector<GNCLot*> lots;
+    std::unordered_set<GNCLot*> lot_set;
+    std::vector<Split*> splits;
+    std::unordered_set<Split*> split_set;
+};
+
+static void
+free_lot_work (AccountPrivate *priv)
+{
+    delete priv->lot_work;
+    priv->lot_work = nullptr;
+}
+
+template <typename T> static void
+lot_work_add (std::vector<T*>& items, std::unordered_set<T*>& item_set,
+              T* item)
+{
+    if (item_set.insert (item).second)
+        items.push_back (item);
+}
+
+template <typename T> static GList*
+lot_work_take (std::vector<T*>& items, std::unordered_set<T*>& item_set)
+{
+    GList *list = NULL;
+    for (auto item : items)
+        if (item_set.erase (item))
+            list = g_list_prepend (list, item);
+    items.clear();
+    return g_list_reverse (list);
+}
+
+static void
+lot_work_remove_split (AccountPrivate *priv, Split *split)
+{
+    if (priv->lot_work)
+        priv->lot_work->split_set.erase (split);
+}
+
+static void
+lot_work_remove_lot (AccountPrivate *priv, GNCLot *lot)
+{
+    if (priv->lot_work)
+        priv->lot_work->lot_set.erase (lot);
+}
+
+void
+xaccAccountResetLotWork (Account *acc)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    auto priv = GET_PRIVATE(acc);
+    free_lot_work (priv);
+    priv->lot_work = new LotWork;
+}
+
+void
+xaccAccountStopLotWork (Account *acc)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    auto priv = GET_PRIVATE(acc);
+    free_lot_work (priv);
+    priv->lot_work = new LotWork;
+    priv->lot_work->recording = false;
+}
+
+gboolean
+xaccAccountTakeLotWork (Account *acc, SplitList **splits, LotList **lots)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    g_return_val_if_fail(splits && lots, FALSE);
+
+    auto work = GET_PRIVATE(acc)->lot_work;
+    *splits = NULL;
+    *lots = NULL;
+    if (!work || !work->recording) return FALSE;
+    *splits = lot_work_take (work->splits, work->split_set);
+    *lots = lot_work_take (work->lots, work->lot_set);
+    return TRUE;
+}
+
+void
+xaccAccountForgetLotWork (Account *acc, LotList *lots)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    auto priv = GET_PRIVATE(acc);
+    for (auto node = lots; node; node = node->next)
+        lot_work_remove_lot (priv, static_cast<GNCLot*>(node->data));
+}
+
+gboolean
+xaccAccountHasLotWork (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    auto work = GET_PRIVATE(acc)->lot_work;
+    return !work || !work->lot_set.empty() || !work->split_set.empty();
+}
+
+void
+xaccAccountMarkSplitUnassigned (Account *acc, Split *split)
+{
+    if (!acc) return;
+    auto priv = GET_PRIVATE(acc);
+    auto work = priv->lot_work;
+    if (!work) return;
+    if (work->recording)
+        lot_work_add (work->splits, work->split_set, split);
+    /* A split in another currency than the account's is a trade, so the
+     * account needs a full scrub after all. */
+    else if (split->parent &&
+             split->parent->common_currency != priv->commodity)
+        free_lot_work (priv);
+}
+
+void
+xaccAccountMarkLotDirty (Account *acc, GNCLot *lot)
+{
+    if (!acc) return;
+    auto priv = GET_PRIVATE(acc);
+    if (priv->lot_work && priv->lot_work->recording)
+        lot_work_add (priv->lot_work->lots, priv->lot_work->lot_set, lot);
+    auto index = priv->open_lots;
+    if (!index) return;
+    auto entry = index->entries.find (lot);
+    if (entry == index->entries.end() || entry->second.dirty) return;
+    entry->second.dirty = true;
+    index->dirty.push_back (lot);
+}
+
+static OpenLotIndex&
+get_open_lot_index (AccountPrivate *priv)
+{
+    if (!priv->open_lots)
+    {
+        priv->open_lots = new OpenLotIndex;
+        auto index = priv->open_lots;
+        /* priv->lots has the most recently inserted lot first. */
+        index->next_seq = g_list_length (priv->lots) + 1;
+        auto seq = index->next_seq;
+        for (auto node = priv->lots; node; node = node->next)
+        {
+            auto lot = static_cast<GNCLot*>(node->data);
+            index->entries[lot] = {--seq, 0, false, true};
+            index->dirty.push_back (lot);
+        }
+    }
+    auto index = priv->open_lots;
+    for (auto lot : index->dirty)
+    {
+        auto found = index->entries.find (lot);
+        if (found == index->entries.end()) continue;
+        auto& entry = found->second;
+        if (!entry.dirty) continue;
+        entry.dirty = false;
+        if (entry.open)
+            open_lot_index_unfile (index, lot, entry);
+        entry.open = !gnc_lot_is_closed (lot);
+        if (!entry.open) continue;
+        /* An empty lot isn't closed but has no date; file it last. */
+        auto split = gnc_lot_get_earliest_split (lot);
+        entry.date = split ? xaccTransGetDate (xaccSplitGetParent (split)) :
+            G_MAXINT64;
+        entry.owner = lot_owner_guid (lot);
+        index->open.insert ({entry.date, entry.seq, lot});
+        index->by_owner[entry.owner].insert (lot);
+    }
+    index->dirty.clear();
+    return *index;
+}
+
+gpointer
+xaccAccountForEachOpenLotByDate (Account *acc, gboolean reverse,
+                                 gpointer (*proc)(GNCLot *lot, gpointer data),
+                                 gpointer data)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    g_return_val_if_fail(proc, NULL);
+
+    auto& open = get_open_lot_index (GET_PRIVATE(acc)).open;
+    if (!reverse)
+    {
+        for (auto const& key : open)
+            if (auto result = proc (key.lot, data))
+                return result;
+        return NULL;
+    }
+    /* Walk the dates backwards but each date's lots forwards. */
+    auto end = open.end();
+    while (end != open.begin())
+    {
+        auto first = open.lower_bound ({std::prev (end)->date, UINT64_MAX,
+                                        nullptr});
+        for (auto key = first; key != end; ++key)
+            if (auto result = proc (key->lot, data))
+                return result;
+        end = first;
+    }
+    return NULL;
+}
+
 void
 xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 {
@@ -1995,6 +2326,8 @@ xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 
     ENTER ("(acc=%p, lot=%p)", acc, lot);
     priv->lots = g_list_remove(priv->lots, lot);
+    open_lot_index_remove (priv, lot);
+    lot_work_remove_lot (priv, lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_REMOVE, NULL);
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
@@ -2024,11 +2357,15 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
         old_acc = lot_account;
         opriv = GET_PRIVATE(old_acc);
         opriv->lots = g_list_remove(opriv->lots, lot);
+        open_lot_index_remove (opriv, lot);
+        lot_work_remove_lot (opriv, lot);
     }
 
     priv = GET_PRIVATE(acc);
     priv->lots = g_list_prepend(priv->lots, lot);
+    open_lot_index_insert (priv, lot);
     gnc_lot_set_account(lot, acc);
+    xaccAccountMarkLotDirty (acc, lot);
 
     /* Don't move the splits to the new account.  The caller will do this
      * if appropriate, and doing it here will not work if we are being
@@ -2393,10 +2730,8 @@ set_kvp_string_tag (Account *acc, const char *tag, const char *value)
 static const char*
 get_kvp_string_tag (const Account *acc, const char *tag)
 {
-    GValue v = G_VALUE_INIT;
     if (acc == NULL || tag == NULL) return NULL;
-    qof_instance_get_path_kvp (QOF_INSTANCE (acc), &v, {tag});
-    return G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : NULL;
+    return qof_instance_get_slot_string (QOF_INSTANCE (acc), tag);
 }
 
 void
@@ -3812,16 +4147,19 @@ xaccAccountFindOpenLots (const Account *acc,
                                  gpointer user_data),
                          gpointer user_data, GCompareFunc sort_func)
 {
-    AccountPrivate *priv;
-    GList *lot_list;
     GList *retval = NULL;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
 
-    priv = GET_PRIVATE(acc);
-    for (lot_list = priv->lots; lot_list; lot_list = lot_list->next)
+    /* Only look at the open lots, but in the account's order. */
+    auto& index = get_open_lot_index (GET_PRIVATE(acc));
+    std::vector<OpenLotIndex::Key> open (index.open.begin(), index.open.end());
+    std::sort (open.begin(), open.end(),
+               [](const OpenLotIndex::Key& a, const OpenLotIndex::Key& b)
+               { return a.seq > b.seq; });
+    for (auto const& key : open)
     {
-        GNCLot *lot = static_cast<GNCLot*>(lot_list->data);
+        GNCLot *lot = key.lot;
 
         /* If this lot is closed, then ignore it */
         if (gnc_lot_is_closed (lot))
@@ -3840,6 +4178,54 @@ xaccAccountFindOpenLots (const Account *acc,
     return retval;
 }
 
+LotList *
+xaccAccountFindOpenLotsByOwner (const Account *acc, const GList *owner_guids,
+                                gboolean (*match_func)(GNCLot *lot,
+                                                       gpointer user_data),
+                                gpointer user_data, GCompareFunc sort_func)
+{
+    GList *retval = NULL;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+
+    auto& index = get_open_lot_index (GET_PRIVATE(acc));
+    std::vector<std::pair<uint64_t, GNCLot*>> candidates;
+    auto add_owned = [&index, &candidates](const GncGUID *guid)
+    {
+        auto owned = index.by_owner.find (*guid);
+        if (owned == index.by_owner.end()) return;
+        for (auto lot : owned->second)
+            candidates.emplace_back (index.entries[lot].seq, lot);
+    };
+    add_owned (guid_null ());
+    for (auto node = owner_guids; node; node = node->next)
+    {
+        auto guid = static_cast<const GncGUID*>(node->data);
+        if (guid && !guid_equal (guid, guid_null ()))
+            add_owned (guid);
+    }
+    /* The same order as xaccAccountFindOpenLots, dropping any owner
+     * given twice. */
+    std::sort (candidates.begin(), candidates.end(),
+               [](const std::pair<uint64_t, GNCLot*>& a,
+                  const std::pair<uint64_t, GNCLot*>& b)
+               { return a.first > b.first; });
+    candidates.erase (std::unique (candidates.begin(), candidates.end()),
+                      candidates.end());
+    for (auto const& candidate : candidates)
+    {
+        GNCLot *lot = candidate.second;
+        if (match_func && !(match_func)(lot, user_data))
+            continue;
+        if (sort_func)
+            retval = g_list_insert_sorted (retval, lot, sort_func);
+        else
+            retval = g_list_prepend (retval, lot);
+    }
+
+    return retval;
+}
+
 gpointer
 xaccAccountForEachLot(const Account *acc,
                       gpointer (*proc)(GNCLot *lot, void *data), void *data)
@@ -3888,6 +4274,20 @@ boolean_from_key (const Account *acc, std::vector<std::string> const & path)
     return FALSE;
 }
 
+static gboolean
+boolean_from_slot (const Account *acc, const char *key)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    auto slot = qof_instance_get_slot (QOF_INSTANCE(acc), key);
+    if (slot == nullptr)
+        return FALSE;
+    if (slot->get_type () == KvpValue::Type::INT64)
+        return slot->get<int64_t> () != 0;
+    if (slot->get_type () == KvpValue::Type::STRING)
+        return strcmp (slot->get<const char*> (), "true") == 0;
+    return FALSE;
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -3895,7 +4295,7 @@ boolean_from_key (const Account *acc, std::vector<std::string> const & path)
 gboolean
 xaccAccountGetTaxRelated (const Account *acc)
 {
-    return boolean_from_key(acc, {"tax-related"});
+    return boolean_from_slot(acc, "tax-related");
 }
 
 void
@@ -3989,7 +4389,17 @@ xaccAccountSetTaxUSCopyNumber (Account *acc, gint64 copy_number)
 gboolean
 xaccAccountGetPlaceholder (const Account *acc)
 {
-    return boolean_from_key(acc, {"placeholder"});
+    AccountPrivate *priv;
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    priv = GET_PRIVATE(acc);
+    /* Whoever writes the slot, setting it changes the frame's stamp. */
+    auto stamp = qof_instance_get_slots (QOF_INSTANCE (acc))->get_change_stamp ();
+    if (priv->placeholder_stamp != stamp)
+    {
+        priv->placeholder_cached = boolean_from_slot (acc, "placeholder");
+        priv->placeholder_stamp = stamp;
+    }
+    return priv->placeholder_cached;
 }
 
 void
@@ -4025,7 +4435,7 @@ xaccAccountGetDescendantPlaceholder (const Account *acc)
 gboolean
 xaccAccountGetHidden (const Account *acc)
 {
-    return boolean_from_key (acc, {"hidden"});
+    return boolean_from_slot (acc, "hidden");
 }
 
 void
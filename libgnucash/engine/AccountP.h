@@ -116,11 +116,24 @@ typedef struct AccountPrivate
 
     gboolean balance_dirty;     /* balances in splits incorrect */
 
+    /* The placeholder flag lives in KVP but is read for every account
+     * whenever a register or account tree is drawn. placeholder_cached is
+     * valid while the KVP frame's change stamp is placeholder_stamp; a
+     * frame which was never changed is empty, so FALSE and 0 agree. */
+    gboolean placeholder_cached;
+    guint64 placeholder_stamp;
+
     GList *splits;              /* list of split pointers */
     gboolean sort_dirty;        /* sort order of splits is bad */
 
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
+    /* The open lots ordered by opening date, built the first time lots
+     * are looked up by date and then kept up to date. */
+    struct OpenLotIndex *open_lots;
+    /* The lots and splits changed since the lots were last scrubbed, or
+     * NULL if they haven't been scrubbed yet. */
+    struct LotWork *lot_work;
 
     /* The "mark" flag can be used by the user to mark this account
      * in any way desired.  Handy for specialty traversals of the
@@ -141,6 +154,55 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that the balance, splits or split dates of one of its
+ * lots may have changed, so whether it's open and its opening date need
+ * to be checked again. */
+void xaccAccountMarkLotDirty (Account *acc, GNCLot *lot);
+
+/* The capital gains worklist. Once the account's lots have been scrubbed
+ * in full, xaccAccountResetLotWork() starts recording the lots marked
+ * dirty and the splits that were left without a lot, so that later
+ * scrubs can be limited to those.
+ *
+ * xaccAccountStopLotWork() is for accounts without trades instead: it
+ * records nothing until a split in another currency is added, which
+ * makes the account wait for a full scrub again.
+ *
+ * xaccAccountTakeLotWork() hands over and clears the recorded work; it
+ * returns FALSE if nothing is being recorded.
+ * xaccAccountForgetLotWork() drops lots again that were marked dirty
+ * only because they were scrubbed themselves.
+ * xaccAccountHasLotWork() is TRUE if there's recorded work or if the
+ * account is waiting for a full scrub. */
+void xaccAccountResetLotWork (Account *acc);
+void xaccAccountStopLotWork (Account *acc);
+gboolean xaccAccountTakeLotWork (Account *acc, SplitList **splits,
+                                 LotList **lots);
+void xaccAccountForgetLotWork (Account *acc, LotList *lots);
+gboolean xaccAccountHasLotWork (const Account *acc);
+void xaccAccountMarkSplitUnassigned (Account *acc, Split *split);
+
+/* Call proc on each of the account's open lots in order of the posted
+ * date of their earliest split, the latest first if reverse is TRUE,
+ * until it returns non-NULL, and return that. Lots with the same date
+ * are visited in the order xaccAccountForEachLot() would visit them.
+ * proc must not add lots to or remove them from the account. */
+gpointer xaccAccountForEachOpenLotByDate (Account *acc, gboolean reverse,
+                                          gpointer (*proc)(GNCLot *lot,
+                                                           gpointer data),
+                                          gpointer data);
+
+/* Like xaccAccountFindOpenLots(), but only the open lots attached by
+ * gncOwnerAttachToLot() to one of the owners whose GncGUID pointers are
+ * in owner_guids, or attached to no owner at all, are passed to
+ * match_func, so it must still decide whether a lot is wanted. */
+LotList *xaccAccountFindOpenLotsByOwner (const Account *acc,
+                                         const GList *owner_guids,
+                                         gboolean (*match_func)(GNCLot *lot,
+                                                 gpointer user_data),
+                                         gpointer user_data,
+                                         GCompareFunc sort_func);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
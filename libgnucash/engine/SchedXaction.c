@@ -773,6 +773,13 @@ xaccSchedXactionSetRemOccur(SchedXaction *sx, gint num_remain)
 }
 
 gint gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_date, const GDate* end_date)
+{
+    return gnc_sx_get_occur_dates_daterange (sx, start_date, end_date, NULL);
+}
+
+gint gnc_sx_get_occur_dates_daterange(const SchedXaction *sx,
+                                      const GDate* start_date,
+                                      const GDate* end_date, GArray *dates)
 {
     gint result = 0;
     SXTmpStateData *tmpState;
@@ -834,6 +841,8 @@ gint gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_d
                  * limited by num_occur */
                 || tmpState->num_occur_rem >= 0))
     {
+        if (dates)
+            g_array_append_val (dates, tmpState->last_date);
         ++result;
         gnc_sx_incr_temporal_state (sx, tmpState);
     }
@@ -841,7 +850,11 @@ gint gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_d
     /* If the first valid date shouldn't be counted, decrease the
      * result number by one. */
     if (!countFirstDate && result > 0)
+    {
         --result;
+        if (dates)
+            g_array_remove_index (dates, dates->len - result - 1);
+    }
 
     gnc_sx_destroy_temporal_state (tmpState);
     return result;
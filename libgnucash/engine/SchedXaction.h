@@ -197,6 +197,14 @@ void xaccSchedXactionSetRemOccur( SchedXaction *sx, gint numRemain );
  * in the given date range (inclusive). */
 gint gnc_sx_get_num_occur_daterange(const SchedXaction *sx, const GDate* start_date, const GDate* end_date);
 
+/** Like gnc_sx_get_num_occur_daterange(), but also appends the dates of
+ * the occurrences to dates, a GArray of GDate, if it isn't NULL. Only
+ * reads the SX, so it can be called for different SXes from several
+ * threads at once. */
+gint gnc_sx_get_occur_dates_daterange(const SchedXaction *sx,
+                                      const GDate* start_date,
+                                      const GDate* end_date, GArray *dates);
+
 /** \brief Get the instance count.
  *
  *   This is incremented by one for every created
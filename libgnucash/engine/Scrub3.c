@@ -160,7 +160,11 @@ xaccAccountScrubLots (Account *acc)
 {
     LotList *lots, *node;
     if (!acc) return;
-    if (FALSE == xaccAccountHasTrades (acc)) return;
+    if (FALSE == xaccAccountHasTrades (acc))
+    {
+        xaccAccountStopLotWork (acc);
+        return;
+    }
 
     ENTER ("(acc=%s)", xaccAccountGetName(acc));
     xaccAccountBeginEdit(acc);
@@ -174,11 +178,80 @@ xaccAccountScrubLots (Account *acc)
     }
     g_list_free(lots);
     xaccAccountCommitEdit(acc);
+
+    /* Everything is clean now; from here on only track what changes. */
+    xaccAccountResetLotWork (acc);
     LEAVE ("(acc=%s)", xaccAccountGetName(acc));
 }
 
 /* ============================================================== */
 
+guint
+xaccAccountScrubDirtyLots (Account *acc)
+{
+    SplitList *splits, *snode;
+    LotList *lots, *node;
+    GHashTable *seen;
+    guint count = 0;
+
+    if (!acc) return 0;
+    if (!xaccAccountTakeLotWork (acc, &splits, &lots))
+    {
+        xaccAccountScrubLots (acc);
+        lots = xaccAccountGetLotList (acc);
+        count = g_list_length (lots);
+        g_list_free (lots);
+        return count;
+    }
+    if (!splits && !lots) return 0;
+    if (FALSE == xaccAccountHasTrades (acc))
+    {
+        g_list_free (splits);
+        g_list_free (lots);
+        return 0;
+    }
+
+    ENTER ("(acc=%s)", xaccAccountGetName(acc));
+    xaccAccountBeginEdit(acc);
+
+    /* Give the new and orphaned splits a lot first, the lots they end up
+     * in need scrubbing too. */
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (node = lots; node; node = node->next)
+        g_hash_table_add (seen, node->data);
+    lots = g_list_reverse (lots);
+    for (snode = splits; snode; snode = snode->next)
+    {
+        Split *split = snode->data;
+        if (split->lot || split->acc != acc) continue;
+        if (gnc_numeric_zero_p (split->amount) &&
+                xaccTransGetVoidStatus (split->parent)) continue;
+        xaccSplitAssign (split);
+        if (split->lot && g_hash_table_add (seen, split->lot))
+            lots = g_list_prepend (lots, split->lot);
+    }
+    lots = g_list_reverse (lots);
+    g_hash_table_destroy (seen);
+
+    for (node = lots; node; node = node->next)
+    {
+        GNCLot *lot = node->data;
+        if (gnc_lot_get_account (lot) != acc) continue;
+        xaccScrubLot (lot);
+        ++count;
+    }
+    xaccAccountCommitEdit(acc);
+
+    /* Scrubbing the lots marked them dirty again. */
+    xaccAccountForgetLotWork (acc, lots);
+    g_list_free (splits);
+    g_list_free (lots);
+    LEAVE ("(acc=%s) scrubbed %u lots", xaccAccountGetName(acc), count);
+    return count;
+}
+
+/* ============================================================== */
+
 static void
 lot_scrub_cb (Account *acc, gpointer data)
 {
@@ -195,4 +268,66 @@ xaccAccountTreeScrubLots (Account *acc)
     xaccAccountScrubLots (acc);
 }
 
+static void
+start_lot_work_cb (Account *acc, gpointer data)
+{
+    if (xaccAccountHasTrades (acc))
+        xaccAccountResetLotWork (acc);
+    else
+        xaccAccountStopLotWork (acc);
+}
+
+void
+xaccAccountTreeStartLotWork (Account *acc)
+{
+    if (!acc) return;
+
+    gnc_account_foreach_descendant (acc, start_lot_work_cb, NULL);
+    start_lot_work_cb (acc, NULL);
+}
+
+struct dirty_scrub_s
+{
+    guint max_lots;
+    guint count;
+};
+
+static gpointer
+dirty_lot_scrub_cb (Account *acc, gpointer data)
+{
+    struct dirty_scrub_s *ds = data;
+    if (ds->max_lots && ds->count >= ds->max_lots)
+        return xaccAccountHasLotWork (acc) ? acc : NULL;
+    if (xaccAccountHasLotWork (acc))
+        ds->count += xaccAccountScrubDirtyLots (acc);
+    return NULL;
+}
+
+guint
+xaccAccountTreeScrubDirtyLots (Account *acc)
+{
+    struct dirty_scrub_s ds = {0, 0};
+    gint64 start = g_get_monotonic_time ();
+
+    if (!acc) return 0;
+    ENTER ("(acc=%s)", xaccAccountGetName(acc));
+    gnc_account_foreach_descendant_until (acc, dirty_lot_scrub_cb, &ds);
+    dirty_lot_scrub_cb (acc, &ds);
+    LEAVE ("(acc=%s) scrubbed %u lots in %" G_GINT64_FORMAT " us",
+           xaccAccountGetName(acc), ds.count,
+           g_get_monotonic_time () - start);
+    return ds.count;
+}
+
+gboolean
+xaccAccountTreeScrubDirtyLotsStep (Account *acc, guint max_lots)
+{
+    struct dirty_scrub_s ds = {max_lots ? max_lots : 1, 0};
+
+    if (!acc) return FALSE;
+    if (gnc_account_foreach_descendant_until (acc, dirty_lot_scrub_cb, &ds))
+        return TRUE;
+    return dirty_lot_scrub_cb (acc, &ds) != NULL || xaccAccountHasLotWork (acc);
+}
+
 /* ========================== END OF FILE  ========================= */
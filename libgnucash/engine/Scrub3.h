@@ -69,6 +69,34 @@ gboolean xaccScrubLot (GNCLot *lot);
 void xaccAccountScrubLots (Account *acc);
 void xaccAccountTreeScrubLots (Account *acc);
 
+/** The xaccAccountScrubDirtyLots() routine scrubs only the lots that
+ *    have changed, and assigns only the splits that were added to the
+ *    account or taken out of a lot, since the account's lots were last
+ *    scrubbed. Other lots are left alone: their gains can only have
+ *    changed if one of their splits, or the gains transactions made for
+ *    them, did. The first call for an account scrubs all of its lots.
+ *
+ *    Returns the number of lots scrubbed.
+ */
+guint xaccAccountScrubDirtyLots (Account *acc);
+guint xaccAccountTreeScrubDirtyLots (Account *acc);
+
+/** The xaccAccountTreeScrubDirtyLotsStep() routine does the work of
+ *    xaccAccountTreeScrubDirtyLots() a piece at a time, stopping after
+ *    the account in which the count of scrubbed lots reached max_lots.
+ *    It returns TRUE while there is work left, so it can be driven from
+ *    an idle handler.
+ */
+gboolean xaccAccountTreeScrubDirtyLotsStep (Account *acc, guint max_lots);
+
+/** The xaccAccountTreeStartLotWork() routine takes the lots of acc and
+ *    its descendants as they are as scrubbed, so that the routines
+ *    above only look at what changes from now on instead of scrubbing
+ *    every account in full first. Use it on a book that was just
+ *    opened, whose lots are as they were last saved.
+ */
+void xaccAccountTreeStartLotWork (Account *acc);
+
 /** @} */
 #endif /* XACC_SCRUB3_H */
 /** @} */
@@ -0,0 +1,437 @@
+/********************************************************************\
+ * ScrubPlan.cpp -- Find what needs scrubbing, then fix it          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "AccountP.h"
+#include "Scrub.h"
+#include "Scrub3.h"
+#include "ScrubPlan.h"
+#include "SplitP.h"
+#include "Transaction.h"
+#include "TransactionP.h"
+#include "cap-gains.h"
+#include "gnc-commodity.h"
+#include "gnc-date.h"
+}
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "gnc.engine.scrub"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+/* What each fix applies to, by GUID. Applying a plan reports progress,
+ * which can let the GUI change the book, so the fixes look their objects
+ * up again instead of trusting the pointers. */
+struct ScrubTarget
+{
+    GncGUID account;
+    GncGUID trans;
+    GncGUID split;
+};
+
+struct ScrubPlan
+{
+    QofBook *book;
+    std::vector<ScrubFix> fixes;
+    std::vector<ScrubTarget> targets;
+};
+
+/* Transactions are handed to the threads in chunks of this many. */
+static const size_t chunk_size = 256;
+
+static ScrubFix
+make_fix (ScrubFixType type, Account *account, Transaction *trans,
+          Split *split)
+{
+    return {type, account, trans, split, gnc_numeric_zero()};
+}
+
+/* ================================================================ */
+/* The analysis runs on several threads at once, so it must only read.
+ * It looks at the fields directly and sticks to getters that neither
+ * log nor cache anything. */
+
+static bool
+has_currency (const Transaction *trans)
+{
+    return trans->common_currency &&
+        gnc_commodity_is_currency (trans->common_currency);
+}
+
+static void
+check_transaction (Transaction *trans, bool trading,
+                   std::vector<ScrubFix>& fixes)
+{
+    auto currency = trans->common_currency;
+    auto imbalance = gnc_numeric_zero();
+    bool multi_commodity = false;
+    bool currency_known = has_currency (trans);
+
+    if (!currency_known)
+        fixes.push_back (make_fix (SCRUB_FIX_CURRENCY, NULL, trans, NULL));
+
+    for (auto node = trans->splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        if (split->parent != trans ||
+            qof_instance_get_destroying (QOF_INSTANCE (split)))
+            continue;
+
+        auto value = split->value, amount = split->amount;
+        bool valid = !gnc_numeric_check (value) && !gnc_numeric_check (amount);
+        if (!valid)
+            fixes.push_back (make_fix (SCRUB_FIX_SPLIT, split->acc, trans,
+                                       split));
+        /* The split scrub will zero an invalid value. */
+        if (!gnc_numeric_check (value))
+            imbalance = gnc_numeric_add (imbalance, value, GNC_DENOM_AUTO,
+                                         GNC_HOW_DENOM_EXACT);
+
+        if (!split->acc)
+        {
+            fixes.push_back (make_fix (SCRUB_FIX_ORPHAN, NULL, trans, split));
+            continue;
+        }
+        /* The splits can only be compared with the currency the currency
+         * fix chooses, so leave them to the split scrub, which runs
+         * after it. */
+        if (!currency_known)
+        {
+            if (valid)
+                fixes.push_back (make_fix (SCRUB_FIX_SPLIT, split->acc, trans,
+                                           split));
+            continue;
+        }
+
+        auto commodity = xaccAccountGetCommodity (split->acc);
+        if (!commodity || !gnc_commodity_equiv (commodity, currency))
+        {
+            multi_commodity = true;
+            continue;
+        }
+        if (!gnc_numeric_equal (amount, value))
+            multi_commodity = true;
+        if (!valid) continue;
+        auto scu = MIN (xaccAccountGetCommoditySCU (split->acc),
+                        gnc_commodity_get_fraction (currency));
+        if (!gnc_numeric_same (amount, value, scu, GNC_HOW_RND_ROUND_HALF_UP))
+            fixes.push_back (make_fix (SCRUB_FIX_SPLIT, split->acc, trans,
+                                       split));
+    }
+
+    /* With trading accounts a transaction in several commodities has to
+     * be checked further; that's done after the threads finish. Without
+     * a currency the balance isn't known until the currency is fixed. */
+    if (!currency_known || !gnc_numeric_zero_p (imbalance) ||
+        (trading && multi_commodity))
+    {
+        auto fix = make_fix (SCRUB_FIX_IMBALANCE, NULL, trans, NULL);
+        fix.imbalance = trading || !currency_known ?
+            gnc_numeric_error (GNC_ERROR_ARG) : imbalance;
+        fixes.push_back (fix);
+    }
+}
+
+static GncGUID
+guid_of (gconstpointer inst)
+{
+    return inst ? *qof_instance_get_guid (inst) : *guid_null ();
+}
+
+static void
+check_accounts (Account *acc, gboolean scrub_lots, ScrubPlan& plan,
+                std::vector<Transaction*>& transactions)
+{
+    std::unordered_set<Transaction*> seen;
+    auto accounts = gnc_account_get_descendants (acc);
+    accounts = g_list_prepend (accounts, acc);
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto account = static_cast<Account*>(node->data);
+        if (xaccAccountGetType (account) != ACCT_TYPE_ROOT &&
+            !xaccAccountGetCommodity (account))
+            plan.fixes.push_back (make_fix (SCRUB_FIX_ACCOUNT_COMMODITY,
+                                            account, NULL, NULL));
+        if (scrub_lots && xaccAccountHasLotWork (account) &&
+            xaccAccountHasTrades (account))
+            plan.fixes.push_back (make_fix (SCRUB_FIX_LOTS, account, NULL,
+                                            NULL));
+        for (auto snode = xaccAccountGetSplitList (account); snode;
+             snode = snode->next)
+        {
+            auto trans = static_cast<Split*>(snode->data)->parent;
+            if (trans && seen.insert (trans).second)
+                transactions.push_back (trans);
+        }
+    }
+    g_list_free (accounts);
+}
+
+static void
+report_progress (QofPercentageFunc percentagefunc, const char *format,
+                 size_t current, size_t total)
+{
+    if (!percentagefunc) return;
+    auto message = g_strdup_printf (format, (guint)current, (guint)total);
+    percentagefunc (message, total ? (100.0 * current) / total : 100.0);
+    g_free (message);
+}
+
+ScrubPlan *
+xaccScrubPlanNew (Account *acc, gboolean scrub_lots,
+                  QofPercentageFunc percentagefunc)
+{
+    g_return_val_if_fail (acc, NULL);
+
+    auto plan = new ScrubPlan;
+    auto book = gnc_account_get_book (acc);
+    plan->book = book;
+    std::vector<Transaction*> transactions;
+    check_accounts (acc, scrub_lots, *plan, transactions);
+
+    bool trading = book && qof_book_use_trading_accounts (book);
+    auto num_chunks = (transactions.size() + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<ScrubFix>> chunk_fixes (num_chunks);
+    std::atomic<size_t> next_chunk {0};
+    auto check_chunk = [&](size_t chunk)
+    {
+        auto end = std::min ((chunk + 1) * chunk_size, transactions.size());
+        for (auto i = chunk * chunk_size; i < end; ++i)
+            check_transaction (transactions[i], trading, chunk_fixes[chunk]);
+    };
+    auto work = [&]()
+    {
+        size_t chunk;
+        while ((chunk = next_chunk++) < num_chunks)
+            check_chunk (chunk);
+    };
+
+    ENTER ("(acc=%s) %" G_GSIZE_FORMAT " transactions",
+           xaccAccountGetName (acc), transactions.size());
+    auto num_threads = std::min<size_t> (std::thread::hardware_concurrency(),
+                                         num_chunks);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        try
+        {
+            threads.emplace_back (work);
+        }
+        catch (const std::system_error& err)
+        {
+            PWARN ("Checking with %" G_GSIZE_FORMAT " threads: %s", i,
+                   err.what());
+            break;
+        }
+    }
+
+    /* This thread takes a share of the work too. It mustn't report
+     * progress until the others are done: a progress function may run
+     * the GUI's main loop, which can change the book they're reading. */
+    work ();
+    for (auto& thread : threads)
+        thread.join();
+    report_progress (percentagefunc, _("Checking transactions: %u of %u"),
+                     transactions.size(), transactions.size());
+
+    for (auto& fixes : chunk_fixes)
+        for (auto& fix : fixes)
+        {
+            /* Whether a transaction in several commodities balances
+             * is settled here, since it depends on the book's options. */
+            if (fix.type == SCRUB_FIX_IMBALANCE &&
+                gnc_numeric_check (fix.imbalance) && has_currency (fix.trans))
+            {
+                if (xaccTransIsBalanced (fix.trans)) continue;
+                fix.imbalance = xaccTransGetImbalanceValue (fix.trans);
+            }
+            plan->fixes.push_back (fix);
+        }
+    std::stable_sort (plan->fixes.begin(), plan->fixes.end(),
+                      [](const ScrubFix& a, const ScrubFix& b)
+                      { return a.type < b.type; });
+    for (auto const& fix : plan->fixes)
+        plan->targets.push_back ({guid_of (fix.account), guid_of (fix.trans),
+                                  guid_of (fix.split)});
+    if (percentagefunc)
+        percentagefunc (NULL, -1.0);
+    LEAVE ("%" G_GSIZE_FORMAT " fixes", plan->fixes.size());
+    return plan;
+}
+
+guint
+xaccScrubPlanGetNumFixes (const ScrubPlan *plan)
+{
+    g_return_val_if_fail (plan, 0);
+    return plan->fixes.size();
+}
+
+const ScrubFix *
+xaccScrubPlanGetFix (const ScrubPlan *plan, guint index)
+{
+    g_return_val_if_fail (plan, NULL);
+    if (index >= plan->fixes.size()) return NULL;
+    return &plan->fixes[index];
+}
+
+/* ================================================================ */
+
+static void
+append_trans_line (GString *report, const char *format, Transaction *trans,
+                   const char *extra)
+{
+    auto date = qof_print_date (trans->date_posted);
+    g_string_append_printf (report, format,
+                            trans->description ? trans->description : "",
+                            date, extra);
+    g_string_append_c (report, '\n');
+    g_free (date);
+}
+
+gchar *
+xaccScrubPlanGetReport (const ScrubPlan *plan)
+{
+    g_return_val_if_fail (plan, NULL);
+
+    auto report = g_string_new (NULL);
+    for (auto const& fix : plan->fixes)
+    {
+        switch (fix.type)
+        {
+        case SCRUB_FIX_ACCOUNT_COMMODITY:
+        case SCRUB_FIX_LOTS:
+        {
+            auto name = gnc_account_get_full_name (fix.account);
+            g_string_append_printf (report,
+                                    fix.type == SCRUB_FIX_LOTS ?
+                                    _("Account \"%s\": the lots and capital gains need updating") :
+                                    _("Account \"%s\": has no commodity"),
+                                    name);
+            g_string_append_c (report, '\n');
+            g_free (name);
+            break;
+        }
+        case SCRUB_FIX_ORPHAN:
+            append_trans_line (report,
+                               _("Transaction \"%s\" on %s: split \"%s\" has no account"),
+                               fix.trans, fix.split->memo ? fix.split->memo : "");
+            break;
+        case SCRUB_FIX_CURRENCY:
+            append_trans_line (report,
+                               _("Transaction \"%s\" on %s: has no currency"),
+                               fix.trans, NULL);
+            break;
+        case SCRUB_FIX_SPLIT:
+            append_trans_line (report,
+                               _("Transaction \"%s\" on %s: the amount of split \"%s\" doesn't match its value"),
+                               fix.trans, fix.split->memo ? fix.split->memo : "");
+            break;
+        case SCRUB_FIX_IMBALANCE:
+        {
+            if (gnc_numeric_check (fix.imbalance))
+            {
+                append_trans_line (report,
+                                   _("Transaction \"%s\" on %s: may be unbalanced once it has a currency"),
+                                   fix.trans, NULL);
+                break;
+            }
+            auto amount = gnc_numeric_to_string (fix.imbalance);
+            append_trans_line (report,
+                               _("Transaction \"%s\" on %s: is unbalanced by %s"),
+                               fix.trans, amount);
+            g_free (amount);
+            break;
+        }
+        }
+    }
+    return g_string_free (report, FALSE);
+}
+
+void
+xaccScrubPlanApply (ScrubPlan *plan, QofPercentageFunc percentagefunc)
+{
+    g_return_if_fail (plan);
+
+    const char *message = _("Repairing: %u of %u");
+    auto total = plan->fixes.size();
+    ENTER ("%" G_GSIZE_FORMAT " fixes", total);
+    for (size_t i = 0; i < total; ++i)
+    {
+        auto const& target = plan->targets[i];
+        if (i % 100 == 0)
+            report_progress (percentagefunc, message, i, total);
+        auto account = xaccAccountLookup (&target.account, plan->book);
+        auto trans = xaccTransLookup (&target.trans, plan->book);
+        auto split = xaccSplitLookup (&target.split, plan->book);
+        switch (plan->fixes[i].type)
+        {
+        case SCRUB_FIX_ACCOUNT_COMMODITY:
+            if (account)
+                xaccAccountScrubCommodity (account);
+            break;
+        case SCRUB_FIX_ORPHAN:
+            if (trans)
+                xaccTransScrubOrphans (trans);
+            break;
+        case SCRUB_FIX_CURRENCY:
+            if (trans)
+                xaccTransScrubCurrency (trans);
+            break;
+        case SCRUB_FIX_SPLIT:
+            if (split)
+                xaccSplitScrub (split);
+            break;
+        case SCRUB_FIX_IMBALANCE:
+            if (trans)
+                xaccTransScrubImbalance (trans,
+                                         gnc_book_get_root_account (plan->book),
+                                         NULL);
+            break;
+        case SCRUB_FIX_LOTS:
+            if (account)
+                xaccAccountScrubDirtyLots (account);
+            break;
+        }
+    }
+    if (percentagefunc)
+        percentagefunc (NULL, -1.0);
+    LEAVE ("");
+}
+
+void
+xaccScrubPlanFree (ScrubPlan *plan)
+{
+    delete plan;
+}
@@ -0,0 +1,109 @@
+/********************************************************************\
+ * ScrubPlan.h -- Find what needs scrubbing, then fix it            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Scrub
+    @{ */
+
+/** @file ScrubPlan.h
+ *  @brief Check and repair an account tree in two passes
+ *
+ * Scrubbing a large book one split at a time is slow, and nearly all of
+ * the time goes into looking at transactions that are fine. A scrub
+ * plan separates the looking from the fixing: xaccScrubPlanNew()
+ * examines the accounts and their transactions, spreading the
+ * transactions over several threads since it changes nothing, and
+ * lists the fixes needed. The list can be shown to the user as a dry
+ * run with xaccScrubPlanGetReport(), and xaccScrubPlanApply() then
+ * makes the fixes one after the other, with the same scrub routines the
+ * tree scrubs use.
+ *
+ * The pointers in the fixes are only good until the book changes.
+ * xaccScrubPlanApply() finds the objects again by GUID, so fixes for
+ * objects deleted in the meantime are skipped, but the book itself must
+ * stay open.
+ */
+
+#ifndef XACC_SCRUB_PLAN_H
+#define XACC_SCRUB_PLAN_H
+
+#include "gnc-engine.h"
+#include "qofsession.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** The kinds of problems a plan can fix, in the order they're fixed. */
+typedef enum
+{
+    SCRUB_FIX_ACCOUNT_COMMODITY, /**< The account has no commodity. */
+    SCRUB_FIX_ORPHAN,        /**< A split of the transaction has no account. */
+    SCRUB_FIX_CURRENCY,      /**< The transaction has no currency. */
+    SCRUB_FIX_SPLIT,         /**< A split's amount or value is invalid, or
+                                  its amount differs from its value though
+                                  it's in the transaction's currency, or
+                                  the transaction has no currency yet. */
+    SCRUB_FIX_IMBALANCE,     /**< The transaction doesn't balance, or has
+                                  no currency yet to tell. */
+    SCRUB_FIX_LOTS,          /**< The account's lots need scrubbing. */
+} ScrubFixType;
+
+typedef struct
+{
+    ScrubFixType type;
+    Account *account;       /**< For the account fixes. */
+    Transaction *trans;     /**< For the transaction and split fixes. */
+    Split *split;           /**< For the split fixes. */
+    gnc_numeric imbalance;  /**< For SCRUB_FIX_IMBALANCE, if known;
+                                 otherwise an error value. */
+} ScrubFix;
+
+typedef struct ScrubPlan ScrubPlan;
+
+/** Examine acc, its descendants and their transactions and make a plan
+ *  of the fixes they need. Lots are only looked at if scrub_lots is
+ *  TRUE. percentagefunc, which may be NULL, is called from the calling
+ *  thread only, once the other threads have finished. */
+ScrubPlan *xaccScrubPlanNew (Account *acc, gboolean scrub_lots,
+                             QofPercentageFunc percentagefunc);
+
+guint xaccScrubPlanGetNumFixes (const ScrubPlan *plan);
+const ScrubFix *xaccScrubPlanGetFix (const ScrubPlan *plan, guint index);
+
+/** A description of each fix, one per line, for showing what a scrub
+ *  would change without changing it. The caller frees the string. */
+gchar *xaccScrubPlanGetReport (const ScrubPlan *plan);
+
+/** Make the fixes in the plan. */
+void xaccScrubPlanApply (ScrubPlan *plan, QofPercentageFunc percentagefunc);
+
+void xaccScrubPlanFree (ScrubPlan *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XACC_SCRUB_PLAN_H */
+/** @} */
+/** @} */
@@ -732,6 +732,14 @@ void mark_split (Split *s)
 
     /* set dirty flag on lot too. */
     if (s->lot) gnc_lot_set_closed_unknown(s->lot);
+
+    /* Editing either half of a gains transaction means the gains of the
+     * source split's lot have to be checked again. */
+    if (s->gains_split && s->gains_split->lot)
+    {
+        GNCLot *lot = s->gains_split->lot;
+        xaccAccountMarkLotDirty (gnc_lot_get_account (lot), lot);
+    }
 }
 
 /*
@@ -1205,6 +1213,7 @@ qofSplitSetAmount (Split *split, gnc_numeric amt)
     {
         split->amount = amt;
     }
+    if (split->lot) gnc_lot_set_closed_unknown(split->lot);
 }
 
 /* The amount of the split in the _account's_ commodity. */
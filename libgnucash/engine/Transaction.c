@@ -274,6 +274,7 @@ gnc_transaction_init(Transaction* trans)
     trans->readonly_reason = NULL;
     trans->reason_cache_valid = FALSE;
     trans->isClosingTxn_cached = -1;
+    trans->date_posted_day_num_valid = FALSE;
     LEAVE (" ");
 }
 
@@ -1444,6 +1445,9 @@ void
 xaccTransBeginEdit (Transaction *trans)
 {
     if (!trans) return;
+    /* The posted date's slot might be changed without going through
+     * xaccTransSetDatePostedGDate(). */
+    trans->date_posted_day_num_valid = FALSE;
     if (!qof_begin_edit(&trans->inst)) return;
 
     if (qof_book_shutting_down(qof_instance_get_book(trans))) return;
@@ -1746,6 +1750,7 @@ xaccTransRollbackEdit (Transaction *trans)
     SWAP(trans->description, orig->description);
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
+    trans->date_posted_day_num_valid = FALSE;
     SWAP(trans->common_currency, orig->common_currency);
     qof_instance_swap_kvp (QOF_INSTANCE (trans), QOF_INSTANCE (orig));
 
@@ -1811,6 +1816,10 @@ xaccTransRollbackEdit (Transaction *trans)
     g_list_free(orig->splits);
     orig->splits = NULL;
 
+    /* The restored amounts and date bypassed the setters, so the lots'
+     * cached balances and opening dates have to be refreshed. */
+    FOR_EACH_SPLIT(trans, if (s->lot) gnc_lot_set_closed_unknown(s->lot));
+
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
     be = qof_book_get_backend(qof_instance_get_book(trans));
@@ -1954,6 +1963,8 @@ xaccTransSetDateInternal(Transaction *trans, time64 *dadate, time64 val)
     }
 #endif
     *dadate = val;
+    if (dadate == &trans->date_posted)
+        trans->date_posted_day_num_valid = FALSE;
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);
     xaccTransCommitEdit(trans);
@@ -2373,12 +2384,9 @@ xaccTransGetIsClosingTxn (const Transaction *trans)
     if (trans->isClosingTxn_cached == -1)
     {
         Transaction* trans_nonconst = (Transaction*) trans;
-        GValue v = G_VALUE_INIT;
-        qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, trans_is_closing_str);
-        if (G_VALUE_HOLDS_INT64 (&v))
-            trans_nonconst->isClosingTxn_cached = (g_value_get_int64 (&v) ? 1 : 0);
-        else
-            trans_nonconst->isClosingTxn_cached = 0;
+        trans_nonconst->isClosingTxn_cached =
+            qof_instance_get_slot_int64 (QOF_INSTANCE (trans),
+                                         trans_is_closing_str) ? 1 : 0;
     }
     return (trans->isClosingTxn_cached == 1)
             ? TRUE
@@ -2442,6 +2450,22 @@ xaccTransGetDatePostedGDate (const Transaction *trans)
     return result;
 }
 
+gint32
+xaccTransGetDatePostedDayNum (const Transaction *trans)
+{
+    if (!trans) return G_MININT32;
+    if (!trans->date_posted_day_num_valid)
+    {
+        /* Cache the value, which is a derived one: */
+        Transaction *trans_nonconst = (Transaction*) trans;
+        GDate date = xaccTransGetDatePostedGDate (trans);
+        trans_nonconst->date_posted_day_num = g_date_valid (&date) ?
+            gnc_gdate_get_day_num (&date) : G_MININT32;
+        trans_nonconst->date_posted_day_num_valid = TRUE;
+    }
+    return trans->date_posted_day_num;
+}
+
 time64
 xaccTransRetDateEntered (const Transaction *trans)
 {
@@ -2533,8 +2557,8 @@ xaccTransIsSXTemplate (const Transaction * trans)
 gboolean xaccTransIsReadonlyByPostedDate(const Transaction *trans)
 {
     GDate *threshold_date;
-    GDate trans_date;
     const QofBook *book = xaccTransGetBook (trans);
+    gint32 trans_day;
     gboolean result;
     g_assert(trans);
 
@@ -2548,14 +2572,17 @@ gboolean xaccTransIsReadonlyByPostedDate(const Transaction *trans)
 
     threshold_date = qof_book_get_autoreadonly_gdate(book);
     g_assert(threshold_date); // ok because we checked uses_autoreadonly before
-    trans_date = xaccTransGetDatePostedGDate(trans);
+    trans_day = xaccTransGetDatePostedDayNum(trans);
 
 //    g_warning("there is auto-read-only with days=%d, trans_date_day=%d, threshold_date_day=%d",
 //              qof_book_get_num_days_autofreeze(book),
-//              g_date_get_day(&trans_date),
-//              g_date_get_day(threshold_date));
+//              trans_day,
+//              gnc_gdate_get_day_num(threshold_date));
 
-    if (g_date_compare(&trans_date, threshold_date) < 0)
+    /* Like g_date_compare(), don't hold an invalid posted date against
+     * the transaction. */
+    if (trans_day != G_MININT32 &&
+        trans_day < gnc_gdate_get_day_num(threshold_date))
     {
         //g_warning("we are auto-read-only");
         result = TRUE;
@@ -2722,25 +2749,18 @@ gboolean
 xaccTransGetVoidStatus(const Transaction *trans)
 {
     const char *s = NULL;
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(trans, FALSE);
 
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, void_reason_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         s = g_value_get_string (&v);
-    return s && strlen(s);
+    s = qof_instance_get_slot_string (QOF_INSTANCE (trans), void_reason_str);
+    return s && *s;
 }
 
 const char *
 xaccTransGetVoidReason(const Transaction *trans)
 {
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(trans, FALSE);
 
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, void_reason_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         return g_value_get_string (&v);
-    return NULL;
+    return qof_instance_get_slot_string (QOF_INSTANCE (trans), void_reason_str);
 }
 
 time64
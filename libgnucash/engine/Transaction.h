@@ -645,6 +645,12 @@ time64        xaccTransRetDatePosted   (const Transaction *trans);
 /** Retrieve the posted date of the transaction. The posted date is
     the date when this transaction was posted at the bank. */
 GDate      xaccTransGetDatePostedGDate (const Transaction *trans);
+/** Retrieve the posted date of the transaction as a day number (see
+    gnc_gdate_get_day_num()). It's the date xaccTransGetDatePostedGDate()
+    returns, but cached, so prefer it when comparing or bucketing the
+    dates of many transactions. Returns G_MININT32 if trans is NULL or
+    its posted date isn't valid. */
+gint32     xaccTransGetDatePostedDayNum (const Transaction *trans);
 
 /*################## Added for Reg2 #################*/
 /** Retrieve the date of when the transaction was entered. The entered
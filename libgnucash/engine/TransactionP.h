@@ -124,6 +124,14 @@ struct transaction_s
      * cached from the KVP value because it is queried a lot. Tri-state value: -1
      * = uninitialized; 0 = FALSE, 1 = TRUE. */
     gint isClosingTxn_cached;
+
+    /* The posted date as a day number, i.e. the date returned by
+     * xaccTransGetDatePostedGDate(), cached because comparing and
+     * bucketing posted dates needs it for every transaction.
+     * date_posted_day_num_valid indicates whether the cached value is
+     * valid. */
+    gint32 date_posted_day_num;
+    gboolean date_posted_day_num_valid;
 };
 
 struct _TransactionClass
@@ -156,11 +156,14 @@ finder_helper (GNCLot *lot,  gpointer user_data)
         return NULL;
     }
 
+    /* The lots come in date order, so the first one that beats the
+     * guess is the one we want. */
     posted = trans->date_posted;
     if (els->date_pred (els->time, posted))
     {
         els->time = trans->date_posted;
         els->lot = lot;
+        return lot;
     }
 
     return NULL;
@@ -182,7 +185,8 @@ xaccAccountFindOpenLot (Account *acc, gnc_numeric sign,
     if (gnc_numeric_positive_p(sign)) es.numeric_pred = gnc_numeric_negative_p;
     else es.numeric_pred = gnc_numeric_positive_p;
 
-    xaccAccountForEachLot (acc, finder_helper, &es);
+    xaccAccountForEachOpenLotByDate (acc, date_pred == latest_pred,
+                                     finder_helper, &es);
     return es.lot;
 }
 
@@ -26,12 +26,14 @@
 #include "qof.h"
 #include "qoflog.h"
 #include "Query.h"
+#include "gnc-balance-matrix.h"
 #include "gnc-budget.h"
 #include "gnc-commodity.h"
 #include "gnc-engine.h"
 #include "gnc-filepath-utils.h"
 #include "gnc-pricedb.h"
 #include "gnc-lot.h"
+#include "gnc-report-splits.h"
 #include "gnc-session.h"
 #include "gnc-hooks-scm.h"
 #include "engine-deprecated.h"
@@ -232,6 +234,212 @@ time64 time64CanonicalDayTime(time64 t);
 
 %include <gnc-budget.h>
 
+%ignore gnc_account_list_get_balances_at_dates;
+%include <gnc-balance-matrix.h>
+
+%{
+static int
+compare_time64 (const void *a, const void *b)
+{
+    time64 ta = *(const time64 *)a, tb = *(const time64 *)b;
+    return ta < tb ? -1 : ta > tb;
+}
+%}
+%rename ("gnc-account-list-get-balances-at-dates") wrap_gnc_account_list_get_balances_at_dates;
+%inline %{
+  /* This helper function wraps gnc_account_list_get_balances_at_dates()
+   * to take a list of accounts and a list of dates, which it sorts, and
+   * to return a list of the balances at the sorted dates for each
+   * account. report_commodity may be #f. */
+  SCM wrap_gnc_account_list_get_balances_at_dates (SCM accounts, SCM dates,
+                                                   int flags,
+                                                   SCM report_commodity);
+  SCM wrap_gnc_account_list_get_balances_at_dates (SCM accounts, SCM dates,
+                                                   int flags,
+                                                   SCM report_commodity)
+  {
+      GList *acc_list = NULL, *node;
+      gnc_commodity *commodity = NULL;
+      guint num_dates = scm_to_uint (scm_length (dates)), i;
+      time64 *date_array = g_new (time64, num_dates + 1);
+      gnc_numeric *balances, *balance;
+      SCM result = SCM_EOL;
+
+      for (i = 0; i < num_dates; i++, dates = SCM_CDR (dates))
+          date_array[i] = scm_to_int64 (SCM_CAR (dates));
+      qsort (date_array, num_dates, sizeof (time64), compare_time64);
+
+      for (; !scm_is_null (accounts); accounts = SCM_CDR (accounts))
+          acc_list = g_list_prepend (acc_list,
+                                     SWIG_MustGetPtr (SCM_CAR (accounts),
+                                                      SWIGTYPE_p_Account,
+                                                      1, 0));
+      acc_list = g_list_reverse (acc_list);
+
+      if (scm_is_true (report_commodity))
+          commodity = SWIG_MustGetPtr (report_commodity,
+                                       SWIGTYPE_p_gnc_commodity, 4, 0);
+
+      balances = gnc_account_list_get_balances_at_dates (acc_list, date_array,
+                                                         num_dates, flags,
+                                                         commodity);
+      balance = balances;
+      for (node = acc_list; balances && node; node = node->next)
+      {
+          SCM row = SCM_EOL;
+          for (i = 0; i < num_dates; i++)
+              row = scm_cons (gnc_numeric_to_scm (*balance++), row);
+          result = scm_cons (scm_reverse_x (row, SCM_EOL), result);
+      }
+
+      g_free (balances);
+      g_free (date_array);
+      g_list_free (acc_list);
+      return scm_reverse_x (result, SCM_EOL);
+  }
+%}
+
+%ignore GncReportSplitFilter;
+%ignore GncReportSortLevel;
+%ignore gnc_report_splits_new;
+%ignore gnc_report_splits_free;
+%ignore gnc_report_splits_get_num_rows;
+%ignore gnc_report_splits_get_split;
+%ignore gnc_report_splits_get_group;
+%include <gnc-report-splits.h>
+
+%{
+/* The report's split filter is called from C++, which a Scheme throw
+ * mustn't unwind. The throw is caught and kept, the remaining splits
+ * are left out, and it's rethrown once the native pass is cleaned up. */
+typedef struct
+{
+    SCM proc;
+    Split *split;
+    SCM throw_key;
+    SCM throw_args;
+} SplitFilterCall;
+
+static SCM
+split_filter_body (void *data)
+{
+    SplitFilterCall *call = data;
+    return scm_call_1 (call->proc, SWIG_NewPointerObj (call->split,
+                                                       SWIGTYPE_p_Split, 0));
+}
+
+static SCM
+split_filter_handler (void *data, SCM key, SCM args)
+{
+    SplitFilterCall *call = data;
+    call->throw_key = key;
+    call->throw_args = args;
+    return SCM_BOOL_F;
+}
+
+static gboolean
+call_split_filter (Split *split, gpointer user_data)
+{
+    SplitFilterCall *call = user_data;
+
+    if (scm_is_true (call->throw_key))
+        return FALSE;
+
+    call->split = split;
+    return scm_is_true (scm_internal_catch (SCM_BOOL_T, split_filter_body, call,
+                                            split_filter_handler, call));
+}
+
+static void
+scm_to_sort_level (SCM level, GncReportSortLevel *sort_level)
+{
+    sort_level->key = scm_to_int (SCM_CAR (level));
+    sort_level->date_group = scm_to_int (SCM_CADR (level));
+    sort_level->ascending = scm_is_true (SCM_CADDR (level));
+}
+%}
+%rename ("gnc-report-splits-from-query") wrap_gnc_report_splits_from_query;
+%inline %{
+  /* This helper function runs a transaction report's query and passes
+   * the splits it finds to gnc_report_splits_new(). accounts,
+   * account_filter, matcher and matcher_exclude are the fields of the
+   * filter, split_filter is a procedure taking a split or #f, and
+   * primary and secondary are lists of a sort key, a date group and
+   * whether to sort in ascending order. It returns a list of the list
+   * of splits and the lists of their primary and secondary groups. */
+  SCM wrap_gnc_report_splits_from_query (QofQuery *query, SCM unique_trans,
+                                         SCM accounts, int account_filter,
+                                         SCM matcher, SCM matcher_exclude,
+                                         SCM split_filter, SCM primary,
+                                         SCM secondary, SCM sort);
+  SCM wrap_gnc_report_splits_from_query (QofQuery *query, SCM unique_trans,
+                                         SCM accounts, int account_filter,
+                                         SCM matcher, SCM matcher_exclude,
+                                         SCM split_filter, SCM primary,
+                                         SCM secondary, SCM sort)
+  {
+      GncReportSplitFilter filter = { NULL, account_filter, NULL,
+                                      scm_is_true (matcher_exclude),
+                                      NULL, NULL };
+      SplitFilterCall call = { split_filter, NULL, SCM_BOOL_F, SCM_BOOL_F };
+      GncReportSortLevel primary_level, secondary_level;
+      GncReportSplits *rows;
+      GList *splits;
+      guint row;
+      SCM split_list = SCM_EOL, primary_groups = SCM_EOL;
+      SCM secondary_groups = SCM_EOL;
+      SCM node;
+
+      /* Convert the arguments which may throw before allocating. */
+      scm_to_sort_level (primary, &primary_level);
+      scm_to_sort_level (secondary, &secondary_level);
+      for (node = accounts; !scm_is_null (node); node = SCM_CDR (node))
+          SWIG_MustGetPtr (SCM_CAR (node), SWIGTYPE_p_Account, 3, 0);
+
+      for (; !scm_is_null (accounts); accounts = SCM_CDR (accounts))
+          filter.accounts = g_list_prepend (filter.accounts,
+                                            SWIG_MustGetPtr (SCM_CAR (accounts),
+                                                             SWIGTYPE_p_Account,
+                                                             3, 0));
+      if (scm_is_string (matcher))
+          filter.matcher = scm_to_utf8_string (matcher);
+      if (scm_is_true (split_filter))
+      {
+          filter.func = call_split_filter;
+          filter.user_data = &call;
+      }
+
+      if (scm_is_true (unique_trans))
+          splits = xaccQueryGetSplitsUniqueTrans (query);
+      else
+          splits = qof_query_run (query);
+
+      rows = gnc_report_splits_new (splits, &filter, &primary_level,
+                                    &secondary_level, scm_is_true (sort));
+
+      for (row = gnc_report_splits_get_num_rows (rows);
+           scm_is_false (call.throw_key) && row-- > 0;)
+      {
+          split_list = scm_cons (SWIG_NewPointerObj (gnc_report_splits_get_split (rows, row),
+                                                     SWIGTYPE_p_Split, 0),
+                                 split_list);
+          primary_groups = scm_cons (scm_from_int (gnc_report_splits_get_group (rows, 0, row)),
+                                     primary_groups);
+          secondary_groups = scm_cons (scm_from_int (gnc_report_splits_get_group (rows, 1, row)),
+                                       secondary_groups);
+      }
+
+      gnc_report_splits_free (rows);
+      if (scm_is_true (unique_trans))
+          g_list_free (splits);
+      g_list_free (filter.accounts);
+      free ((char *)filter.matcher);
+      if (scm_is_true (call.throw_key))
+          scm_throw (call.throw_key, call.throw_args);
+      return scm_list_3 (split_list, primary_groups, secondary_groups);
+  }
+%}
+
 %typemap(in) GList * {
   SCM path_scm = $input;
   GList *path = NULL;
@@ -434,6 +642,36 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("QOF-DATE-FORMAT-UTC");
     SET_ENUM("QOF-DATE-FORMAT-CUSTOM");
 
+    SET_ENUM("GNC-BALANCE-RECURSE");
+    SET_ENUM("GNC-BALANCE-NOCLOSING");
+    SET_ENUM("GNC-BALANCE-NEAREST-PRICE");
+
+    SET_ENUM("GNC-REPORT-KEY-NONE");
+    SET_ENUM("GNC-REPORT-KEY-ACCOUNT-NAME");
+    SET_ENUM("GNC-REPORT-KEY-ACCOUNT-CODE");
+    SET_ENUM("GNC-REPORT-KEY-DATE");
+    SET_ENUM("GNC-REPORT-KEY-RECONCILED-DATE");
+    SET_ENUM("GNC-REPORT-KEY-RECONCILED-STATUS");
+    SET_ENUM("GNC-REPORT-KEY-CORR-ACCOUNT-NAME");
+    SET_ENUM("GNC-REPORT-KEY-CORR-ACCOUNT-CODE");
+    SET_ENUM("GNC-REPORT-KEY-AMOUNT");
+    SET_ENUM("GNC-REPORT-KEY-DESCRIPTION");
+    SET_ENUM("GNC-REPORT-KEY-NUMBER");
+    SET_ENUM("GNC-REPORT-KEY-ACTION");
+    SET_ENUM("GNC-REPORT-KEY-MEMO");
+    SET_ENUM("GNC-REPORT-KEY-NOTES");
+
+    SET_ENUM("GNC-REPORT-DATE-NONE");
+    SET_ENUM("GNC-REPORT-DATE-DAY");
+    SET_ENUM("GNC-REPORT-DATE-WEEK");
+    SET_ENUM("GNC-REPORT-DATE-MONTH");
+    SET_ENUM("GNC-REPORT-DATE-QUARTER");
+    SET_ENUM("GNC-REPORT-DATE-YEAR");
+
+    SET_ENUM("GNC-REPORT-ACCOUNTS-ANY");
+    SET_ENUM("GNC-REPORT-ACCOUNTS-INCLUDE");
+    SET_ENUM("GNC-REPORT-ACCOUNTS-EXCLUDE");
+
 
 #undef SET_ENUM
   }
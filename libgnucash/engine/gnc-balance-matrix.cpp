@@ -0,0 +1,196 @@
+/********************************************************************\
+ * gnc-balance-matrix.cpp -- Balances of many accounts at many      *
+ *                           dates.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-commodity.h"
+#include "gnc-engine.h"
+}
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "gnc-balance-matrix.hpp"
+
+static QofLogModule log_module = GNC_MOD_ACCOUNT;
+
+/* The balances of an account in its own commodity after the last split
+ * posted at or before each date, found in one pass over its splits. */
+static GncBalanceRow
+account_own_balances (Account* acc, const std::vector<time64>& dates,
+                      bool noclosing)
+{
+    GncBalanceRow row;
+    Split* latest = nullptr;
+
+    row.reserve (dates.size());
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    auto node = xaccAccountGetSplitList (acc);
+    for (auto date : dates)
+    {
+        for (; node; node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            if (xaccTransGetDate (xaccSplitGetParent (split)) > date)
+                break;
+            latest = split;
+        }
+
+        if (!latest)
+            row.push_back (gnc_numeric_zero ());
+        else if (noclosing)
+            row.push_back (xaccSplitGetNoclosingBalance (latest));
+        else
+            row.push_back (xaccSplitGetBalance (latest));
+    }
+    return row;
+}
+
+namespace
+{
+struct BalanceSum
+{
+    const std::vector<time64>& dates;
+    GncBalanceFlags flags;
+    gnc_commodity* target;
+    std::unordered_map<Account*, GncBalanceRow>& own;
+    GncBalanceRow row;
+};
+}
+
+static const GncBalanceRow&
+lookup_own_balances (BalanceSum& sum, Account* acc)
+{
+    auto iter = sum.own.find (acc);
+    if (iter == sum.own.end())
+    {
+        auto row = account_own_balances (acc, sum.dates,
+                                         sum.flags & GNC_BALANCE_NOCLOSING);
+        iter = sum.own.emplace (acc, std::move (row)).first;
+    }
+    return iter->second;
+}
+
+static gnc_numeric
+convert_balance (BalanceSum& sum, Account* acc, gnc_numeric balance,
+                 time64 date)
+{
+    auto commodity = xaccAccountGetCommodity (acc);
+    if (sum.flags & GNC_BALANCE_NEAREST_PRICE)
+        return xaccAccountConvertBalanceToCurrencyAsOfDate (acc, balance,
+                                                            commodity,
+                                                            sum.target, date);
+    return xaccAccountConvertBalanceToCurrency (acc, balance, commodity,
+                                                sum.target);
+}
+
+/* Adds a sub-account's balances the way the engine's recursive balance
+ * functions do, so the results are the same. */
+static void
+add_descendant_balances (Account* acc, gpointer data)
+{
+    auto& sum = *static_cast<BalanceSum*>(data);
+    auto& own = lookup_own_balances (sum, acc);
+    auto fraction = gnc_commodity_get_fraction (sum.target);
+
+    for (size_t i = 0; i < sum.dates.size(); ++i)
+    {
+        auto balance = convert_balance (sum, acc, own[i], sum.dates[i]);
+        sum.row[i] = gnc_numeric_add (sum.row[i], balance, fraction,
+                                      GNC_HOW_RND_ROUND_HALF_UP);
+    }
+}
+
+GncBalanceMatrix
+gnc_account_balances_at_dates (const std::vector<Account*>& accounts,
+                               const std::vector<time64>& dates,
+                               GncBalanceFlags flags,
+                               const gnc_commodity* report_commodity)
+{
+    GncBalanceMatrix matrix;
+    std::unordered_map<Account*, GncBalanceRow> own;
+
+    if (!std::is_sorted (dates.begin(), dates.end()))
+    {
+        PERR ("dates must be in increasing order");
+        return matrix;
+    }
+
+    matrix.reserve (accounts.size());
+    for (auto acc : accounts)
+    {
+        auto target = const_cast<gnc_commodity*>(report_commodity);
+        if (!target && GNC_IS_ACCOUNT (acc))
+            target = xaccAccountGetCommodity (acc);
+        BalanceSum sum {dates, flags, target, own,
+                        GncBalanceRow (dates.size(), gnc_numeric_zero ())};
+
+        if (!GNC_IS_ACCOUNT (acc) || !target)
+        {
+            PWARN ("no balances for account %p", acc);
+            matrix.push_back (std::move (sum.row));
+            continue;
+        }
+
+        auto& own_balances = lookup_own_balances (sum, acc);
+        for (size_t i = 0; i < dates.size(); ++i)
+            sum.row[i] = convert_balance (sum, acc, own_balances[i], dates[i]);
+
+        if (flags & GNC_BALANCE_RECURSE)
+            gnc_account_foreach_descendant (acc, add_descendant_balances, &sum);
+
+        matrix.push_back (std::move (sum.row));
+    }
+
+    PINFO ("%zu accounts at %zu dates from %zu split lists", accounts.size(),
+           dates.size(), own.size());
+    return matrix;
+}
+
+gnc_numeric *
+gnc_account_list_get_balances_at_dates (GList *accounts, const time64 *dates,
+                                        guint num_dates, GncBalanceFlags flags,
+                                        const gnc_commodity *report_commodity)
+{
+    std::vector<Account*> acc_vec;
+    for (auto node = accounts; node; node = node->next)
+        acc_vec.push_back (static_cast<Account*>(node->data));
+    std::vector<time64> date_vec (dates, dates + num_dates);
+
+    auto matrix = gnc_account_balances_at_dates (acc_vec, date_vec, flags,
+                                                 report_commodity);
+    if (matrix.size() != acc_vec.size())
+        return nullptr;
+
+    auto result = g_new (gnc_numeric, acc_vec.size() * num_dates + 1);
+    auto out = result;
+    for (const auto& row : matrix)
+        out = std::copy (row.begin(), row.end(), out);
+    return result;
+}
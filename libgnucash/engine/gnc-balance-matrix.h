@@ -0,0 +1,84 @@
+/********************************************************************\
+ * gnc-balance-matrix.h -- Balances of many accounts at many dates. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-balance-matrix.h
+ *  @brief Balances of a list of accounts at a list of dates.
+ *
+ *  Reports and budgets need the balances of many accounts at many
+ *  dates. Asking for them one at a time with
+ *  xaccAccountGetBalanceAsOfDate() walks an account's splits once per
+ *  date; these functions walk them once for all the dates, and
+ *  compute the balances of an account shared by several subtrees only
+ *  once.
+ *
+ *  A balance at a date includes the splits of transactions posted at
+ *  or before that date, so the balance xaccAccountGetBalanceAsOfDate()
+ *  gives for a date is the one here for the date minus one second.
+ */
+
+#ifndef GNC_BALANCE_MATRIX_H
+#define GNC_BALANCE_MATRIX_H
+
+#include "Account.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    /** Add the balances of all the sub-accounts. */
+    GNC_BALANCE_RECURSE       = 1 << 0,
+    /** Leave out closing transactions. */
+    GNC_BALANCE_NOCLOSING     = 1 << 1,
+    /** Convert to the target commodity with the price nearest each
+     *  date instead of the latest price. */
+    GNC_BALANCE_NEAREST_PRICE = 1 << 2,
+} GncBalanceFlags;
+
+/** Compute the balance of each account at each date.
+ *
+ *  Balances are given in report_commodity, or in each account's own
+ *  commodity if it's NULL. With GNC_BALANCE_RECURSE and the latest
+ *  price they are the same as xaccAccountGetBalanceAsOfDateInCurrency()
+ *  gives, or xaccAccountGetNoclosingBalanceAsOfDateInCurrency() with
+ *  GNC_BALANCE_NOCLOSING.
+ *
+ *  @param accounts The accounts.
+ *  @param dates The dates, in increasing order.
+ *  @param num_dates The number of dates.
+ *  @param flags Which balances to compute.
+ *  @param report_commodity The commodity to give the balances in, or NULL.
+ *  @return A newly allocated array of g_list_length(accounts) * num_dates
+ *  balances, the balances of the first account first, for the caller
+ *  to g_free. NULL if the dates aren't in order.
+ */
+gnc_numeric *gnc_account_list_get_balances_at_dates (
+    GList *accounts, const time64 *dates, guint num_dates,
+    GncBalanceFlags flags, const gnc_commodity *report_commodity);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /*__cplusplus*/
+#endif /* GNC_BALANCE_MATRIX_H */
+/** @} */
@@ -0,0 +1,49 @@
+/********************************************************************\
+ * gnc-balance-matrix.hpp -- Balances of many accounts at many      *
+ *                           dates.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef GNC_BALANCE_MATRIX_HPP
+#define GNC_BALANCE_MATRIX_HPP
+
+extern "C"
+{
+#include "gnc-balance-matrix.h"
+}
+
+#include <vector>
+
+using GncBalanceRow = std::vector<gnc_numeric>;
+/** One row of balances per account, one column per date. */
+using GncBalanceMatrix = std::vector<GncBalanceRow>;
+
+/** Compute the balance of each account at each date, see
+ * gnc_account_list_get_balances_at_dates().
+ *
+ * @param dates must be in increasing order; the result is empty if
+ * they aren't.
+ */
+GncBalanceMatrix
+gnc_account_balances_at_dates (const std::vector<Account*>& accounts,
+                               const std::vector<time64>& dates,
+                               GncBalanceFlags flags,
+                               const gnc_commodity* report_commodity);
+
+#endif //GNC_BALANCE_MATRIX_HPP
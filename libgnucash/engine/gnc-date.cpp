@@ -116,15 +116,7 @@ gnc_localtime (const time64 *secs)
 struct tm*
 gnc_localtime_r (const time64 *secs, struct tm* time)
 {
-    try
-    {
-        *time = static_cast<struct tm>(GncDateTime(*secs));
-        return time;
-    }
-    catch(std::invalid_argument&)
-    {
-        return NULL;
-    }
+    return GncLocalTime::to_tm(*secs, *time) ? time : NULL;
 }
 
 static void
@@ -229,17 +221,9 @@ gnc_start_of_week (void)
 time64
 gnc_mktime (struct tm* time)
 {
-    try
-    {
-        normalize_struct_tm (time);
-        GncDateTime gncdt(*time);
-        *time = static_cast<struct tm>(gncdt);
-        return static_cast<time64>(gncdt);
-    }
-    catch(std::invalid_argument&)
-    {
-        return 0;
-    }
+    time64 secs;
+    normalize_struct_tm (time);
+    return GncLocalTime::from_tm (*time, secs) ? secs : 0;
 }
 
 time64
@@ -1253,6 +1237,36 @@ gnc_gdate_set_time64 (GDate* gd, time64 time)
                     tm.tm_year + 1900);
 }
 
+/* g_date_get_julian() counts from 1 January of year 1 as day 1. */
+static const gint32 julian_epoch = 719163;
+
+gint32
+gnc_time64_get_day_num (time64 time)
+{
+    try
+    {
+        return GncDayNum(time).days();
+    }
+    catch(std::invalid_argument&)
+    {
+        return G_MININT32;
+    }
+}
+
+gint32
+gnc_gdate_get_day_num (const GDate* gd)
+{
+    g_return_val_if_fail (gd && g_date_valid (gd), G_MININT32);
+    return static_cast<gint32>(g_date_get_julian (gd)) - julian_epoch;
+}
+
+void
+gnc_gdate_set_day_num (GDate* gd, gint32 day_num)
+{
+    g_return_if_fail (gd);
+    g_date_set_julian (gd, static_cast<guint32>(day_num + julian_epoch));
+}
+
 time64 gdate_to_time64 (GDate d)
 {
     return gnc_dmy2time64_neutral (g_date_get_day(&d),
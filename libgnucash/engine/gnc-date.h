@@ -289,6 +289,27 @@ void gnc_gdate_set_today (GDate* gd);
  */
 void gnc_gdate_set_time64 (GDate* gd, time64 time);
 
+/** @} */
+
+/** @name Day numbers
+ *  A day number is a date as the number of days since 1 January 1970, so
+ *  comparing dates or bucketing them into periods is integer arithmetic.
+ *    @{ */
+/** The day number of the local date on which time falls.
+ * @param time The time
+ * @return The day number, or G_MININT32 if time is out of range.
+ */
+gint32 gnc_time64_get_day_num (time64 time);
+
+/** The day number of a valid GDate. */
+gint32 gnc_gdate_get_day_num (const GDate* gd);
+
+/** Set a GDate to a day number.
+ * @param gd the date to act on
+ * @param day_num the day number to set it to.
+ */
+void gnc_gdate_set_day_num (GDate* gd, gint32 day_num);
+
 /** @} */
 /** convert a time64 on a certain day (localtime) to
  * the time64 representing midday on that day. Watch out - this is *not* the
@@ -32,10 +32,14 @@ extern "C"
 #include <boost/date_time/local_time/local_time.hpp>
 #include <boost/locale.hpp>
 #include <boost/regex.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <libintl.h>
 #include <locale.h>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -213,16 +217,253 @@ LDT_from_struct_tm(const struct tm tm)
 
 using TD = boost::posix_time::time_duration;
 
+/* GncLocalTime's tables. Each covers the UTC instants of one year, plus a
+ * couple of days either side for local times near New Year, using that
+ * year's timezone rules just as LDT_from_unix_local and LDT_from_struct_tm
+ * do. A span's offset applies from its start until the next span's start.
+ */
+namespace
+{
+struct OffsetSpan
+{
+    time64 start;
+    int32_t offset;
+    bool is_dst;
+};
+
+struct OffsetTable
+{
+    time64 begin;
+    time64 end;
+    std::vector<OffsetSpan> spans;
+};
+
+constexpr time64 seconds_per_day = 86400;
+
+inline time64
+floor_div(time64 a, time64 b) noexcept
+{
+    return a / b - (a % b < 0 ? 1 : 0);
+}
+
+/* Fill tm the way boost's to_tm does for the local time local. */
+void
+tm_from_local_seconds(time64 local, struct tm& tm) noexcept
+{
+    memset(&tm, 0, sizeof(tm));
+    auto days = floor_div(local, seconds_per_day);
+    auto secs = static_cast<int>(local - days * seconds_per_day);
+    GncDayNum day(static_cast<int32_t>(days));
+    auto date = day.year_month_day();
+    tm.tm_year = date.year - 1900;
+    tm.tm_mon = date.month - 1;
+    tm.tm_mday = date.day;
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs / 60 % 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = day.weekday();
+    tm.tm_yday = day.days() - GncDayNum(date.year, 1, 1).days();
+}
+
+void
+reference_offset(const TZ_Ptr& tz, time64 time, OffsetSpan& span)
+{
+    PTime ptime(unix_epoch.date(),
+                boost::posix_time::hours(time / 3600) +
+                boost::posix_time::seconds(time % 3600));
+    LDT ldt(ptime, tz);
+    span.start = time;
+    span.offset = (ldt.local_time() - ldt.utc_time()).total_seconds();
+    span.is_dst = ldt.is_dst();
+}
+
+std::unique_ptr<OffsetTable>
+build_offset_table(int year)
+{
+    /* Offsets change at most a few times a year, and never twice within
+     * sample_step, so sample and then bisect to the second. */
+    constexpr time64 sample_step = 6 * 3600;
+    std::unique_ptr<OffsetTable> table(new OffsetTable);
+    auto tz = tzp->get(year);
+    table->begin = (GncDayNum(year, 1, 1).days() - 2) * seconds_per_day;
+    table->end = (GncDayNum(year + 1, 1, 1).days() + 2) * seconds_per_day;
+    OffsetSpan current, next;
+    reference_offset(tz, table->begin, current);
+    table->spans.push_back(current);
+    for (auto time = table->begin + sample_step; time < table->end;
+         time += sample_step)
+    {
+        reference_offset(tz, time, next);
+        if (next.offset == current.offset && next.is_dst == current.is_dst)
+        {
+            current = next;
+            continue;
+        }
+        auto lo = current.start, hi = time;
+        while (hi - lo > 1)
+        {
+            OffsetSpan mid;
+            reference_offset(tz, lo + (hi - lo) / 2, mid);
+            if (mid.offset == current.offset && mid.is_dst == current.is_dst)
+                lo = mid.start;
+            else
+                hi = mid.start;
+        }
+        next.start = hi;
+        table->spans.push_back(next);
+        current = next;
+        current.start = time;
+    }
+    return table;
+}
+
+std::mutex offset_tables_mutex;
+std::map<int, std::unique_ptr<OffsetTable>> offset_tables;
+std::atomic<unsigned> offset_tables_generation{0};
+
+/* Conversions tend to cluster in a year, so each thread remembers the
+ * last table it used rather than taking the lock every time. */
+struct LastOffsetTable
+{
+    unsigned generation;
+    int year;
+    const OffsetTable* table;
+};
+thread_local LastOffsetTable last_offset_table{0, 0, nullptr};
+
+const OffsetTable&
+get_offset_table(int year)
+{
+    auto generation = offset_tables_generation.load(std::memory_order_acquire);
+    if (last_offset_table.table && last_offset_table.year == year &&
+        last_offset_table.generation == generation)
+        return *last_offset_table.table;
+    std::lock_guard<std::mutex> lock(offset_tables_mutex);
+    auto& table = offset_tables[year];
+    if (!table)
+        table = build_offset_table(year);
+    last_offset_table = {generation, year, table.get()};
+    return *table;
+}
+
+inline const OffsetSpan&
+find_span(const OffsetTable& table, time64 time) noexcept
+{
+    auto spot = std::upper_bound(table.spans.begin(), table.spans.end(), time,
+                                 [](time64 t, const OffsetSpan& span)
+                                 { return t < span.start; });
+    return *(spot - 1);
+}
+
+/* The tables don't cover the first and last years, where boost throws for
+ * local times falling outside the range. */
+inline bool
+year_in_table_range(int year) noexcept
+{
+    return year > static_cast<int>(TimeZoneProvider::min_year) &&
+        year < static_cast<int>(TimeZoneProvider::max_year);
+}
+} // anonymous namespace
+
+bool
+GncLocalTime::to_tm(time64 time, struct tm& tm)
+{
+    if (time < MINTIME || time > MAXTIME ||
+        !year_in_table_range(
+            GncDayNum(static_cast<int32_t>(floor_div(time, seconds_per_day))).year()))
+    {
+        try
+        {
+            tm = static_cast<struct tm>(GncDateTime(time));
+            return true;
+        }
+        catch(const std::invalid_argument&)
+        {
+            return false;
+        }
+    }
+    auto year = GncDayNum(static_cast<int32_t>(floor_div(time, seconds_per_day))).year();
+    auto& span = find_span(get_offset_table(year), time);
+    tm_from_local_seconds(time + span.offset, tm);
+    tm.tm_isdst = span.is_dst ? 1 : 0;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = span.offset;
+#endif
+    return true;
+}
+
+bool
+GncLocalTime::from_tm(struct tm& tm, time64& time)
+{
+    auto year = tm.tm_year + 1900;
+    if (year_in_table_range(year) && tm.tm_mon >= 0 && tm.tm_mon < 12 &&
+        tm.tm_mday >= 1 &&
+        tm.tm_mday <= static_cast<int>(GncDayNum::days_in_month(year, tm.tm_mon + 1)) &&
+        tm.tm_hour >= 0 && tm.tm_hour <= 24 && tm.tm_min >= 0 &&
+        tm.tm_min <= 60 && tm.tm_sec >= 0 && tm.tm_sec <= 60)
+    {
+        auto local = GncDayNum(year, tm.tm_mon + 1, tm.tm_mday).days() *
+            seconds_per_day + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+        auto& table = get_offset_table(year);
+        const OffsetSpan* match = nullptr;
+        unsigned matches = 0;
+        for (auto span = table.spans.begin(); span != table.spans.end(); ++span)
+        {
+            auto candidate = local - span->offset;
+            auto next = span + 1;
+            if (candidate >= span->start &&
+                (next == table.spans.end() ? candidate < table.end :
+                 candidate < next->start))
+            {
+                match = &*span;
+                ++matches;
+            }
+        }
+        /* Otherwise it's in a gap or an overlap, left to the reference. */
+        if (matches == 1)
+        {
+            time = local - match->offset;
+            tm_from_local_seconds(local, tm);
+            tm.tm_isdst = match->is_dst ? 1 : 0;
+#if HAVE_STRUCT_TM_GMTOFF
+            tm.tm_gmtoff = match->offset;
+#endif
+            return true;
+        }
+    }
+    try
+    {
+        GncDateTime gncdt(tm);
+        tm = static_cast<struct tm>(gncdt);
+        time = static_cast<time64>(gncdt);
+        return true;
+    }
+    catch(const std::invalid_argument&)
+    {
+        return false;
+    }
+}
+
+void
+GncLocalTime::reset() noexcept
+{
+    std::lock_guard<std::mutex> lock(offset_tables_mutex);
+    offset_tables_generation.fetch_add(1, std::memory_order_release);
+    offset_tables.clear();
+}
+
 void
 _set_tzp(TimeZoneProvider& new_tzp)
 {
     tzp = &new_tzp;
+    GncLocalTime::reset();
 }
 
 void
 _reset_tzp()
 {
     tzp = &ltzp;
+    GncLocalTime::reset();
 }
 
 class GncDateTimeImpl
@@ -732,3 +973,24 @@ bool operator==(const GncDate& a, const GncDate& b) { return *(a.m_impl) == *(b.
 bool operator<=(const GncDate& a, const GncDate& b) { return *(a.m_impl) <= *(b.m_impl); }
 bool operator>=(const GncDate& a, const GncDate& b) { return *(a.m_impl) >= *(b.m_impl); }
 bool operator!=(const GncDate& a, const GncDate& b) { return *(a.m_impl) != *(b.m_impl); }
+
+/* =================== GncDayNum Implementation ================== */
+
+static int32_t
+local_day_num(time64 time)
+{
+    struct tm tm;
+    if (!GncLocalTime::to_tm(time, tm))
+        throw(std::invalid_argument("Time value is outside the supported year range."));
+    return GncDayNum(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday).days();
+}
+
+GncDayNum::GncDayNum(time64 time) : m_days{local_day_num(time)} {}
+
+time64
+GncDayNum::to_time64(DayPart part) const
+{
+    auto date = year_month_day();
+    return static_cast<time64>(GncDateTime(GncDate(date.year, date.month,
+                                                   date.day), part));
+}
@@ -161,6 +161,38 @@ private:
     std::unique_ptr<GncDateTimeImpl> m_impl;
 };
 
+/** Table-driven conversions between time64 and local time.
+ *
+ * The first conversion touching a year asks the timezone provider that
+ * GncDateTime uses for the UTC offset over that year and records the
+ * instants at which it changes. After that a conversion is a table lookup
+ * plus integer arithmetic. Results are identical to GncDateTime's, which
+ * remains the reference and is still used for local times in a DST gap or
+ * overlap and for the first and last supported years.
+ *
+ * The conversions are thread safe; reset() isn't.
+ */
+class GncLocalTime
+{
+public:
+/** Convert a time to local time.
+ * @param time Seconds from the POSIX epoch.
+ * @param tm Receives the same value as static_cast<struct tm>(GncDateTime(time)).
+ * @return false if the year is outside the constraints.
+ */
+    static bool to_tm(time64 time, struct tm& tm);
+/** Convert a normalized local time to seconds from the POSIX epoch.
+ * @param tm The local time; on success it's replaced by the value
+ * GncDateTime(tm) would give, i.e. normalized with the day of the week,
+ * day of the year, DST flag and offset filled in.
+ * @param time Receives static_cast<time64>(GncDateTime(tm)).
+ * @return false if GncDateTime(tm) would throw std::invalid_argument.
+ */
+    static bool from_tm(struct tm& tm, time64& time);
+/** Discard the tables, e.g. because the timezone changed. */
+    static void reset() noexcept;
+};
+
 /** GnuCash DateFormat class
  *
  * A helper class to represent a date format understood
@@ -311,4 +343,195 @@ bool operator>=(const GncDate& a, const GncDate& b);
 bool operator!=(const GncDate& a, const GncDate& b);
 /**@}*/
 
+/** A calendar date as the number of days since 1 January 1970, for date
+ * arithmetic that doesn't care about the time of day.
+ *
+ * Only constructing one from a time64 involves the timezone; everything
+ * else, including finding the boundaries of months, quarters and
+ * (fiscal) years, is integer arithmetic on the proleptic Gregorian
+ * calendar and is constexpr. Unlike GncDate there's no range check.
+ */
+class GncDayNum
+{
+public:
+    constexpr GncDayNum() noexcept : m_days{0} {}
+    constexpr explicit GncDayNum(int32_t days) noexcept : m_days{days} {}
+    /** Construct from a year, a month 1-12 and a day 1-31. */
+    constexpr GncDayNum(int year, unsigned month, unsigned day) noexcept :
+        m_days{days_from_civil(month <= 2 ? year - 1 : year, month, day)} {}
+    /** Construct the day on which time falls in the current timezone.
+     * @exception std::invalid_argument if time is outside the range
+     * GncDateTime supports.
+     */
+    explicit GncDayNum(time64 time);
+
+    constexpr int32_t days() const noexcept { return m_days; }
+    constexpr ymd year_month_day() const noexcept
+    {
+        return civil_from_shifted(m_days + 719468);
+    }
+    constexpr int year() const noexcept { return year_month_day().year; }
+    constexpr unsigned month() const noexcept { return year_month_day().month; }
+    constexpr unsigned day() const noexcept { return year_month_day().day; }
+    /** @return 0 for Sunday to 6 for Saturday, as in struct tm. */
+    constexpr unsigned weekday() const noexcept
+    {
+        return static_cast<unsigned>((m_days + 4) % 7 + 7) % 7;
+    }
+    /** @return 0 for January 1 to 365 for December 31 in leap years. */
+    constexpr unsigned day_of_year() const noexcept
+    {
+        return m_days - GncDayNum(year(), 1, 1).m_days;
+    }
+
+    static constexpr bool is_leap_year(int year) noexcept
+    {
+        return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    }
+    static constexpr unsigned days_in_month(int year, unsigned month) noexcept
+    {
+        return month == 2 ? (is_leap_year(year) ? 29 : 28) :
+            (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+    }
+
+    /** The same day of the month months later (or earlier), or the last
+     * day of that month if it's shorter. */
+    constexpr GncDayNum add_months(int months) const noexcept
+    {
+        return from_month_index(year() * 12 + static_cast<int>(month()) - 1 +
+                                months, day());
+    }
+    constexpr GncDayNum start_of_month() const noexcept
+    {
+        return GncDayNum(m_days - static_cast<int32_t>(day()) + 1);
+    }
+    constexpr GncDayNum end_of_month() const noexcept
+    {
+        return GncDayNum(m_days - static_cast<int32_t>(day()) +
+                         static_cast<int32_t>(days_in_month(year(), month())));
+    }
+    constexpr GncDayNum start_of_quarter() const noexcept
+    {
+        return GncDayNum(year(), (month() - 1) / 3 * 3 + 1, 1);
+    }
+    constexpr GncDayNum end_of_quarter() const noexcept
+    {
+        return GncDayNum(year(), (month() - 1) / 3 * 3 + 3, 1).end_of_month();
+    }
+    constexpr GncDayNum start_of_year() const noexcept
+    {
+        return GncDayNum(year(), 1, 1);
+    }
+    constexpr GncDayNum end_of_year() const noexcept
+    {
+        return GncDayNum(year(), 12, 31);
+    }
+    /** The first day of the fiscal year containing this day, for a fiscal
+     * year ending on the given month and day (clamped to the end of the
+     * month, so 2/29 means the last day of February).
+     */
+    constexpr GncDayNum start_of_fiscal_year(unsigned end_month,
+                                             unsigned end_day) const noexcept
+    {
+        return *this <= clamped(year(), end_month, end_day) ?
+            clamped(year() - 1, end_month, end_day) + 1 :
+            clamped(year(), end_month, end_day) + 1;
+    }
+    /** The last day of the fiscal year containing this day. */
+    constexpr GncDayNum end_of_fiscal_year(unsigned end_month,
+                                           unsigned end_day) const noexcept
+    {
+        return *this <= clamped(year(), end_month, end_day) ?
+            clamped(year(), end_month, end_day) :
+            clamped(year() + 1, end_month, end_day);
+    }
+
+    /** The start, neutral time or end of the day in the current timezone.
+     * @exception std::invalid_argument if the day is outside the range
+     * GncDateTime supports.
+     */
+    time64 to_time64(DayPart part = DayPart::neutral) const;
+
+    constexpr GncDayNum operator+(int32_t days) const noexcept
+    {
+        return GncDayNum(m_days + days);
+    }
+    constexpr GncDayNum operator-(int32_t days) const noexcept
+    {
+        return GncDayNum(m_days - days);
+    }
+    constexpr int32_t operator-(GncDayNum other) const noexcept
+    {
+        return m_days - other.m_days;
+    }
+    constexpr bool operator==(GncDayNum other) const noexcept { return m_days == other.m_days; }
+    constexpr bool operator!=(GncDayNum other) const noexcept { return m_days != other.m_days; }
+    constexpr bool operator<(GncDayNum other) const noexcept { return m_days < other.m_days; }
+    constexpr bool operator<=(GncDayNum other) const noexcept { return m_days <= other.m_days; }
+    constexpr bool operator>(GncDayNum other) const noexcept { return m_days > other.m_days; }
+    constexpr bool operator>=(GncDayNum other) const noexcept { return m_days >= other.m_days; }
+
+private:
+    /* The civil calendar conversions from
+     * http://howardhinnant.github.io/date_algorithms.html, split into
+     * single-expression functions so that they're constexpr in C++11.
+     * Years are shifted to start in March so that the leap day is last.
+     */
+    static constexpr int32_t era_of(int32_t value, int32_t length) noexcept
+    {
+        return (value >= 0 ? value : value - length + 1) / length;
+    }
+    static constexpr int32_t days_from_civil(int year, unsigned month,
+                                             unsigned day) noexcept
+    {
+        return era_of(year, 400) * 146097 +
+            static_cast<int32_t>(day_of_era(year - era_of(year, 400) * 400,
+                                            (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1)) -
+            719468;
+    }
+    static constexpr unsigned day_of_era(unsigned year_of_era,
+                                         unsigned day_of_year) noexcept
+    {
+        return year_of_era * 365 + year_of_era / 4 - year_of_era / 100 +
+            day_of_year;
+    }
+    static constexpr unsigned year_of_era(unsigned day_of_era) noexcept
+    {
+        return (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+                day_of_era / 146096) / 365;
+    }
+    static constexpr ymd civil_from_shifted(int32_t days) noexcept
+    {
+        return civil_from_era(era_of(days, 146097),
+                              static_cast<unsigned>(days - era_of(days, 146097) * 146097));
+    }
+    static constexpr ymd civil_from_era(int32_t era, unsigned doe) noexcept
+    {
+        return civil_from_year(era * 400 + static_cast<int32_t>(year_of_era(doe)),
+                               doe - day_of_era(year_of_era(doe), 0));
+    }
+    static constexpr ymd civil_from_year(int32_t year, unsigned doy) noexcept
+    {
+        return civil_from_month(year, (5 * doy + 2) / 153, doy);
+    }
+    static constexpr ymd civil_from_month(int32_t year, unsigned mp,
+                                          unsigned doy) noexcept
+    {
+        return ymd{year + (mp >= 10 ? 1 : 0),
+                   static_cast<int>(mp < 10 ? mp + 3 : mp - 9),
+                   static_cast<int>(doy - (153 * mp + 2) / 5 + 1)};
+    }
+    static constexpr GncDayNum from_month_index(int index, unsigned day) noexcept
+    {
+        return clamped(era_of(index, 12), index - era_of(index, 12) * 12 + 1, day);
+    }
+    static constexpr GncDayNum clamped(int year, unsigned month,
+                                       unsigned day) noexcept
+    {
+        return GncDayNum(year, month, day < days_in_month(year, month) ?
+                         day : days_in_month(year, month));
+    }
+    int32_t m_days;
+};
+
 #endif // __GNC_DATETIME_HPP__
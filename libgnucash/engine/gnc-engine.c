@@ -33,6 +33,7 @@
 #include "TransactionP.h"
 #include "gnc-commodity.h"
 #include "gnc-pricedb-p.h"
+#include "gnc-text-index.h"
 
 /** gnc file backend library name */
 #define GNC_LIB_NAME "gncmod-backend-xml"
@@ -61,6 +62,10 @@ gnc_engine_init_part1()
 
     /* Now register our core types */
     cashobjects_register();
+
+    /* Let queries on descriptions, notes and memos, e.g. from the find
+     * dialog, use the word index. It's only built when first needed. */
+    gnc_text_index_set_enabled (TRUE);
 }
 
 static void
@@ -140,6 +145,7 @@ gnc_engine_init_static(int argc, char ** argv)
 void
 gnc_engine_shutdown (void)
 {
+    gnc_text_index_set_enabled (FALSE);
     qof_log_shutdown();
     qof_close();
     engine_is_initialized = 0;
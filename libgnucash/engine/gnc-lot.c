@@ -90,6 +90,11 @@ typedef struct GNCLotPrivate
     signed char is_closed;
 #define LOT_CLOSED_UNKNOWN (-1)
 
+    /* Cached sum of the split amounts, kept up to date as splits are
+     * added and removed and recomputed when one of them changes. */
+    gnc_numeric balance;
+    gboolean balance_valid;
+
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
 } GNCLotPrivate;
@@ -113,6 +118,8 @@ gnc_lot_init(GNCLot* lot)
     priv->account = NULL;
     priv->splits = NULL;
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    priv->balance = gnc_numeric_zero();
+    priv->balance_valid = TRUE;
     priv->marker = 0;
 }
 
@@ -183,6 +190,8 @@ gnc_lot_set_property (GObject* object,
     {
     case PROP_IS_CLOSED:
         priv->is_closed = g_value_get_int(value);
+        if (priv->account)
+            xaccAccountMarkLotDirty (priv->account, lot);
         break;
     case PROP_MARKER:
         priv->marker = g_value_get_int(value);
@@ -195,6 +204,9 @@ gnc_lot_set_property (GObject* object,
         break;
     case PROP_OWNER_GUID:
         qof_instance_set_kvp (QOF_INSTANCE (lot), value, 2, GNC_OWNER_ID, GNC_OWNER_GUID);
+        /* The account indexes its open lots by owner. */
+        if (priv->account)
+            xaccAccountMarkLotDirty (priv->account, lot);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -397,6 +409,9 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     {
         priv = GET_PRIVATE(lot);
         priv->is_closed = LOT_CLOSED_UNKNOWN;
+        priv->balance_valid = FALSE;
+        if (priv->account)
+            xaccAccountMarkLotDirty (priv->account, lot);
     }
 }
 
@@ -486,15 +501,24 @@ gnc_lot_get_balance (GNCLot *lot)
         return zero;
     }
 
-    /* Sum over splits; because they all belong to same account
-     * they will have same denominator.
-     */
-    for (node = priv->splits; node; node = node->next)
+    if (priv->balance_valid)
     {
-        Split *s = node->data;
-        gnc_numeric amt = xaccSplitGetAmount (s);
-        baln = gnc_numeric_add_fixed (baln, amt);
-        g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+        baln = priv->balance;
+    }
+    else
+    {
+        /* Sum over splits; because they all belong to same account
+         * they will have same denominator.
+         */
+        for (node = priv->splits; node; node = node->next)
+        {
+            Split *s = node->data;
+            gnc_numeric amt = xaccSplitGetAmount (s);
+            baln = gnc_numeric_add_fixed (baln, amt);
+            g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+        }
+        priv->balance = baln;
+        priv->balance_valid = TRUE;
     }
 
     /* cache a zero balance as a closed lot */
@@ -605,9 +629,17 @@ gnc_lot_add_split (GNCLot *lot, Split *split)
     xaccSplitSetLot(split, lot);
 
     priv->splits = g_list_append (priv->splits, split);
+    if (priv->balance_valid)
+    {
+        priv->balance = gnc_numeric_add_fixed (priv->balance,
+                                               xaccSplitGetAmount (split));
+        priv->balance_valid =
+            gnc_numeric_check (priv->balance) == GNC_ERROR_OK;
+    }
 
     /* for recomputation of is-closed */
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    xaccAccountMarkLotDirty (priv->account, lot);
     gnc_lot_commit_edit(lot);
 
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -626,12 +658,26 @@ gnc_lot_remove_split (GNCLot *lot, Split *split)
     qof_instance_set_dirty(QOF_INSTANCE(lot));
     priv->splits = g_list_remove (priv->splits, split);
     xaccSplitSetLot(split, NULL);
+    xaccAccountMarkSplitUnassigned (xaccSplitGetAccount (split), split);
     priv->is_closed = LOT_CLOSED_UNKNOWN;   /* force an is-closed computation */
+    if (priv->balance_valid)
+    {
+        priv->balance = gnc_numeric_sub_fixed (priv->balance,
+                                               xaccSplitGetAmount (split));
+        priv->balance_valid =
+            gnc_numeric_check (priv->balance) == GNC_ERROR_OK;
+    }
 
     if (NULL == priv->splits)
     {
         xaccAccountRemoveLot (priv->account, lot);
         priv->account = NULL;
+        priv->balance = gnc_numeric_zero();
+        priv->balance_valid = TRUE;
+    }
+    else
+    {
+        xaccAccountMarkLotDirty (priv->account, lot);
     }
     gnc_lot_commit_edit(lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -442,6 +442,10 @@ GncNumeric::cmp(GncNumeric b)
 GncNumeric
 operator+(GncNumeric a, GncNumeric b)
 {
+    int64_t sum;
+    if (a.denom() == b.denom() && a.denom() > 0 &&
+        !gnc_numeric_add_overflow_p(a.num(), b.num(), &sum) && sum != INT64_MIN)
+        return GncNumeric(sum, a.denom());
     if (a.num() == 0)
         return b;
     if (b.num() == 0)
@@ -734,6 +738,20 @@ gnc_numeric_same(gnc_numeric a, gnc_numeric b, gint64 denom,
     return(gnc_numeric_equal(aconv, bconv));
 }
 
+/* Whether a same-denominator result computed directly is what converting
+ * to denom with how would produce. */
+static inline bool
+same_denom_fast_path(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
+{
+    if (a.denom != b.denom || a.denom <= 0)
+        return false;
+    if (denom != GNC_DENOM_AUTO && denom != a.denom)
+        return false;
+    /* GNC_HOW_DENOM_EXACT normalizes a zero result to 0/1. */
+    auto dtype = how & GNC_NUMERIC_DENOM_MASK;
+    return dtype == GNC_HOW_DENOM_FIXED || dtype == GNC_HOW_DENOM_LCD;
+}
+
 static int64_t
 denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
 {
@@ -758,6 +776,16 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    if (same_denom_fast_path(a, b, denom, how))
+    {
+        gnc_numeric sum;
+        if (!gnc_numeric_add_overflow_p(a.num, b.num, &sum.num) &&
+            sum.num != G_MININT64)
+        {
+            sum.denom = a.denom;
+            return sum;
+        }
+    }
     denom = denom_lcd(a, b, denom, how);
     try
     {
@@ -812,6 +840,16 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    if (same_denom_fast_path(a, b, denom, how))
+    {
+        gnc_numeric diff;
+        if (!gnc_numeric_sub_overflow_p(a.num, b.num, &diff.num) &&
+            diff.num != G_MININT64)
+        {
+            diff.denom = a.denom;
+            return diff;
+        }
+    }
     denom = denom_lcd(a, b, denom, how);
     try
     {
@@ -423,6 +423,33 @@ gnc_numeric gnc_numeric_neg(gnc_numeric a);
  * returned value is "|a/b|". */
 gnc_numeric gnc_numeric_abs(gnc_numeric a);
 
+/* Overflow-checked 64-bit addition and subtraction, TRUE on overflow. Used
+ * for the common case of operands with the same denominator, which needs
+ * neither 128-bit arithmetic nor rounding. A result of G_MININT64 must also
+ * take the slow path as it can't be negated. */
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define gnc_numeric_add_overflow_p(a, b, res) __builtin_add_overflow(a, b, res)
+#define gnc_numeric_sub_overflow_p(a, b, res) __builtin_sub_overflow(a, b, res)
+#else
+static inline gboolean
+gnc_numeric_add_overflow_p(gint64 a, gint64 b, gint64 *res)
+{
+    if ((b > 0 && a > G_MAXINT64 - b) || (b < 0 && a < G_MININT64 - b))
+        return TRUE;
+    *res = a + b;
+    return FALSE;
+}
+
+static inline gboolean
+gnc_numeric_sub_overflow_p(gint64 a, gint64 b, gint64 *res)
+{
+    if ((b < 0 && a > G_MAXINT64 + b) || (b > 0 && a < G_MININT64 + b))
+        return TRUE;
+    *res = a - b;
+    return FALSE;
+}
+#endif
+
 /**
  * Shortcut for common case: gnc_numeric_add(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
@@ -430,6 +457,14 @@ gnc_numeric gnc_numeric_abs(gnc_numeric a);
 static inline
 gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 {
+    gnc_numeric sum;
+    if (a.denom == b.denom && a.denom > 0 &&
+        !gnc_numeric_add_overflow_p(a.num, b.num, &sum.num) &&
+        sum.num != G_MININT64)
+    {
+        sum.denom = a.denom;
+        return sum;
+    }
     return gnc_numeric_add(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
@@ -441,6 +476,14 @@ gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 static inline
 gnc_numeric gnc_numeric_sub_fixed(gnc_numeric a, gnc_numeric b)
 {
+    gnc_numeric diff;
+    if (a.denom == b.denom && a.denom > 0 &&
+        !gnc_numeric_sub_overflow_p(a.num, b.num, &diff.num) &&
+        diff.num != G_MININT64)
+    {
+        diff.denom = a.denom;
+        return diff;
+    }
     return gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
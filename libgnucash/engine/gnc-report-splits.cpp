@@ -0,0 +1,425 @@
+/********************************************************************\
+ * gnc-report-splits.cpp -- Filter, sort and group splits for       *
+ *                          reports                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+#include "gnc-engine.h"
+}
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "gnc-report-splits.hpp"
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+namespace
+{
+enum class KeyKind { NONE, NUMBER, AMOUNT, TEXT };
+
+/* The value of a split a level compares; which member is used depends
+ * on the level's KeyKind. */
+struct KeyValue
+{
+    gint64 number = 0;
+    gnc_numeric amount = gnc_numeric_zero ();
+    std::string text;
+};
+
+using GroupValue = std::tuple<gint64, gint64, gint64, std::string>;
+
+struct Level
+{
+    GncReportSortLevel level;
+    KeyKind kind;
+    std::map<GroupValue, gint> groups;
+};
+
+struct Row
+{
+    Split* split;
+    std::array<KeyValue, 2> keys;
+    std::array<gint, 2> groups;
+};
+
+/* Values shared by both levels. */
+struct Context
+{
+    gint start_of_week;
+    std::unordered_map<const Account*, std::string> full_names;
+};
+}
+
+static KeyKind
+key_kind (const GncReportSortLevel& level)
+{
+    switch (level.key)
+    {
+    case GNC_REPORT_KEY_DATE:
+    case GNC_REPORT_KEY_RECONCILED_DATE:
+        return level.date_group == GNC_REPORT_DATE_NONE ? KeyKind::NONE :
+            KeyKind::NUMBER;
+    case GNC_REPORT_KEY_RECONCILED_STATUS:
+        return KeyKind::NUMBER;
+    case GNC_REPORT_KEY_AMOUNT:
+        return KeyKind::AMOUNT;
+    case GNC_REPORT_KEY_NONE:
+        return KeyKind::NONE;
+    default:
+        return KeyKind::TEXT;
+    }
+}
+
+/* The period numbers are those of the date-subtotal-list in
+ * trep-engine.scm, so the reports group the same splits either way. */
+static gint64
+date_period (const Context& context, time64 date, GncReportDateGroup group)
+{
+    struct tm tm;
+
+    if (group == GNC_REPORT_DATE_WEEK)
+    {
+        const gint64 week = 7 * 86400;
+        auto secs = gnc_time64_get_day_start (date) -
+            (1 + context.start_of_week) * 86400;
+        return secs >= 0 ? secs / week : -((week - 1 - secs) / week);
+    }
+
+    gnc_localtime_r (&date, &tm);
+    gint64 year = tm.tm_year + 1900;
+    switch (group)
+    {
+    case GNC_REPORT_DATE_DAY:
+        return year * 500 + tm.tm_yday + 1;
+    case GNC_REPORT_DATE_MONTH:
+        return year * 100 + tm.tm_mon + 1;
+    case GNC_REPORT_DATE_QUARTER:
+        return year * 10 + tm.tm_mon / 3 + 1;
+    default:
+        return year;
+    }
+}
+
+static gint64
+reconcile_order (char reconcile)
+{
+    switch (reconcile)
+    {
+    case NREC: return 5;
+    case CREC: return 4;
+    case YREC: return 3;
+    case FREC: return 2;
+    case VREC: return 1;
+    default: return 0;
+    }
+}
+
+static const std::string&
+account_full_name (Context& context, const Account* acc)
+{
+    auto iter = context.full_names.find (acc);
+    if (iter == context.full_names.end())
+    {
+        auto name = acc ? gnc_account_get_full_name (acc) : nullptr;
+        iter = context.full_names.emplace (acc, name ? name : "").first;
+        g_free (name);
+    }
+    return iter->second;
+}
+
+static std::string
+text_value (Context& context, GncReportSortKey key, Split* split)
+{
+    auto trans = xaccSplitGetParent (split);
+    const char* text = nullptr;
+
+    switch (key)
+    {
+    case GNC_REPORT_KEY_ACCOUNT_NAME:
+        return account_full_name (context, xaccSplitGetAccount (split));
+    case GNC_REPORT_KEY_ACCOUNT_CODE:
+        text = xaccAccountGetCode (xaccSplitGetAccount (split));
+        break;
+    case GNC_REPORT_KEY_CORR_ACCOUNT_NAME:
+    {
+        auto name = xaccSplitGetCorrAccountFullName (split);
+        std::string value {name ? name : ""};
+        g_free (name);
+        return value;
+    }
+    case GNC_REPORT_KEY_CORR_ACCOUNT_CODE:
+        text = xaccSplitGetCorrAccountCode (split);
+        break;
+    case GNC_REPORT_KEY_DESCRIPTION:
+        text = xaccTransGetDescription (trans);
+        break;
+    case GNC_REPORT_KEY_NUMBER:
+        text = xaccTransGetNum (trans);
+        break;
+    case GNC_REPORT_KEY_ACTION:
+        text = xaccSplitGetAction (split);
+        break;
+    case GNC_REPORT_KEY_MEMO:
+        text = xaccSplitGetMemo (split);
+        break;
+    case GNC_REPORT_KEY_NOTES:
+        text = xaccTransGetNotes (trans);
+        break;
+    default:
+        break;
+    }
+    return text ? text : "";
+}
+
+static KeyValue
+key_value (Context& context, const Level& level, Split* split)
+{
+    KeyValue value;
+
+    switch (level.level.key)
+    {
+    case GNC_REPORT_KEY_DATE:
+        value.number = date_period (context,
+                                    xaccTransGetDate (xaccSplitGetParent (split)),
+                                    level.level.date_group);
+        break;
+    case GNC_REPORT_KEY_RECONCILED_DATE:
+        value.number = date_period (context, xaccSplitGetDateReconciled (split),
+                                    level.level.date_group);
+        break;
+    case GNC_REPORT_KEY_RECONCILED_STATUS:
+        value.number = reconcile_order (xaccSplitGetReconcile (split));
+        break;
+    case GNC_REPORT_KEY_AMOUNT:
+        value.amount = xaccSplitGetValue (split);
+        break;
+    default:
+        if (level.kind == KeyKind::TEXT)
+            value.text = text_value (context, level.level.key, split);
+        break;
+    }
+    return value;
+}
+
+/* The group of a split. Both date keys group by the posted date, as
+ * the transaction report does. */
+static gint
+group_number (Context& context, Level& level, Split* split,
+              const KeyValue& value)
+{
+    GroupValue group;
+
+    switch (level.kind)
+    {
+    case KeyKind::NONE:
+        return -1;
+    case KeyKind::NUMBER:
+        if (level.level.key == GNC_REPORT_KEY_RECONCILED_DATE)
+            std::get<0>(group) = date_period (context,
+                                              xaccTransGetDate (xaccSplitGetParent (split)),
+                                              level.level.date_group);
+        else
+            std::get<0>(group) = value.number;
+        break;
+    case KeyKind::AMOUNT:
+    {
+        auto amount = gnc_numeric_reduce (value.amount);
+        std::get<1>(group) = amount.num;
+        std::get<2>(group) = amount.denom;
+        break;
+    }
+    case KeyKind::TEXT:
+        std::get<3>(group) = value.text;
+        break;
+    }
+    return level.groups.emplace (group, level.groups.size()).first->second;
+}
+
+static int
+compare_values (const Level& level, const KeyValue& a, const KeyValue& b)
+{
+    switch (level.kind)
+    {
+    case KeyKind::NUMBER:
+        return a.number < b.number ? -1 : a.number > b.number;
+    case KeyKind::AMOUNT:
+        return gnc_numeric_compare (a.amount, b.amount);
+    case KeyKind::TEXT:
+        return a.text.compare (b.text);
+    default:
+        return 0;
+    }
+}
+
+static bool
+other_split_in (Split* split, const std::unordered_set<Account*>& accounts)
+{
+    for (auto node = xaccTransGetSplitList (xaccSplitGetParent (split)); node;
+         node = node->next)
+    {
+        auto other = static_cast<Split*>(node->data);
+        if (other != split && accounts.count (xaccSplitGetAccount (other)))
+            return true;
+    }
+    return false;
+}
+
+static bool
+contains (const char* text, const char* matcher)
+{
+    return text && strstr (text, matcher);
+}
+
+static bool
+matches (Split* split, const char* matcher)
+{
+    auto trans = xaccSplitGetParent (split);
+    return contains (xaccTransGetDescription (trans), matcher) ||
+        contains (xaccTransGetNotes (trans), matcher) ||
+        contains (xaccSplitGetMemo (split), matcher);
+}
+
+GncReportSplits::GncReportSplits (GList* splits,
+                                  const GncReportSplitFilter* filter,
+                                  const GncReportSortLevel& primary,
+                                  const GncReportSortLevel& secondary,
+                                  bool sort)
+{
+    std::array<Level, 2> levels {{{primary, key_kind (primary), {}},
+                                  {secondary, key_kind (secondary), {}}}};
+    auto start_of_week = gnc_start_of_week ();
+    Context context {start_of_week ? start_of_week : 1, {}};
+    std::unordered_set<Account*> accounts;
+    auto account_filter = filter ? filter->account_filter : GNC_REPORT_ACCOUNTS_ANY;
+    auto matcher = filter && filter->matcher && *filter->matcher ?
+        filter->matcher : nullptr;
+    std::vector<Row> rows;
+
+    if (account_filter != GNC_REPORT_ACCOUNTS_ANY)
+        for (auto node = filter->accounts; node; node = node->next)
+            accounts.insert (static_cast<Account*>(node->data));
+
+    for (auto node = splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+
+        if (account_filter != GNC_REPORT_ACCOUNTS_ANY &&
+            other_split_in (split, accounts) !=
+            (account_filter == GNC_REPORT_ACCOUNTS_INCLUDE))
+            continue;
+        if (matcher && matches (split, matcher) == filter->matcher_exclude)
+            continue;
+        if (filter && filter->func && !filter->func (split, filter->user_data))
+            continue;
+
+        Row row {split, {}, {}};
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            row.keys[i] = key_value (context, levels[i], split);
+            row.groups[i] = group_number (context, levels[i], split,
+                                          row.keys[i]);
+        }
+        rows.push_back (std::move (row));
+    }
+
+    if (sort && (levels[0].kind != KeyKind::NONE ||
+                 levels[1].kind != KeyKind::NONE))
+        std::stable_sort (rows.begin(), rows.end(),
+                          [&levels](const Row& a, const Row& b)
+                          {
+                              for (size_t i = 0; i < levels.size(); ++i)
+                              {
+                                  auto cmp = compare_values (levels[i],
+                                                             a.keys[i],
+                                                             b.keys[i]);
+                                  if (cmp)
+                                      return levels[i].level.ascending ?
+                                          cmp < 0 : cmp > 0;
+                              }
+                              return false;
+                          });
+
+    this->splits.reserve (rows.size());
+    for (auto& column : groups)
+        column.reserve (rows.size());
+    for (const auto& row : rows)
+    {
+        this->splits.push_back (row.split);
+        for (size_t i = 0; i < groups.size(); ++i)
+            groups[i].push_back (row.groups[i]);
+    }
+
+    PINFO ("%zu of %u splits, %zu and %zu groups", rows.size(),
+           g_list_length (splits), levels[0].groups.size(),
+           levels[1].groups.size());
+}
+
+GncReportSplits *
+gnc_report_splits_new (GList *splits, const GncReportSplitFilter *filter,
+                       const GncReportSortLevel *primary,
+                       const GncReportSortLevel *secondary, gboolean sort)
+{
+    GncReportSortLevel none {GNC_REPORT_KEY_NONE, GNC_REPORT_DATE_NONE, TRUE};
+
+    return new GncReportSplits (splits, filter, primary ? *primary : none,
+                                secondary ? *secondary : none, sort);
+}
+
+void
+gnc_report_splits_free (GncReportSplits *rows)
+{
+    delete rows;
+}
+
+guint
+gnc_report_splits_get_num_rows (const GncReportSplits *rows)
+{
+    g_return_val_if_fail (rows, 0);
+    return rows->splits.size();
+}
+
+Split *
+gnc_report_splits_get_split (const GncReportSplits *rows, guint row)
+{
+    g_return_val_if_fail (rows, nullptr);
+    return row < rows->splits.size() ? rows->splits[row] : nullptr;
+}
+
+gint
+gnc_report_splits_get_group (const GncReportSplits *rows, guint level,
+                             guint row)
+{
+    g_return_val_if_fail (rows && level < rows->groups.size(), -1);
+    const auto& column = rows->groups[level];
+    return row < column.size() ? column[row] : -1;
+}
@@ -0,0 +1,157 @@
+/********************************************************************\
+ * gnc-report-splits.h -- Filter, sort and group splits for reports *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-report-splits.h
+ *  @brief Filter, sort and group the splits of a transaction report.
+ *
+ *  The transaction report filters the splits its query finds, sorts
+ *  them by up to two keys and subtotals them by the same keys. Doing
+ *  that in Scheme calls several accessors per split for each
+ *  comparison; these functions compute each split's sort keys once and
+ *  do the filtering, sorting and grouping in C++.
+ *
+ *  The result is held in columns: the splits in report order and, for
+ *  each sort key, the number of the subtotal group each split is in.
+ *  Splits with equal values of a key have the same group number, so a
+ *  subtotal ends where the number changes.
+ */
+
+#ifndef GNC_REPORT_SPLITS_H
+#define GNC_REPORT_SPLITS_H
+
+#include "Split.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The values splits can be sorted and grouped by. They're the same as
+ * those the transaction report compares splits by. */
+typedef enum
+{
+    GNC_REPORT_KEY_NONE,
+    GNC_REPORT_KEY_ACCOUNT_NAME,
+    GNC_REPORT_KEY_ACCOUNT_CODE,
+    GNC_REPORT_KEY_DATE,
+    GNC_REPORT_KEY_RECONCILED_DATE,
+    GNC_REPORT_KEY_RECONCILED_STATUS,
+    GNC_REPORT_KEY_CORR_ACCOUNT_NAME,
+    GNC_REPORT_KEY_CORR_ACCOUNT_CODE,
+    GNC_REPORT_KEY_AMOUNT,
+    GNC_REPORT_KEY_DESCRIPTION,
+    GNC_REPORT_KEY_NUMBER,
+    GNC_REPORT_KEY_ACTION,
+    GNC_REPORT_KEY_MEMO,
+    GNC_REPORT_KEY_NOTES,
+} GncReportSortKey;
+
+/** The periods the date keys are compared by. With
+ * GNC_REPORT_DATE_NONE a date key neither sorts nor groups. */
+typedef enum
+{
+    GNC_REPORT_DATE_NONE,
+    GNC_REPORT_DATE_DAY,
+    GNC_REPORT_DATE_WEEK,
+    GNC_REPORT_DATE_MONTH,
+    GNC_REPORT_DATE_QUARTER,
+    GNC_REPORT_DATE_YEAR,
+} GncReportDateGroup;
+
+/** Which splits the filter accounts select. */
+typedef enum
+{
+    /** Don't filter by account. */
+    GNC_REPORT_ACCOUNTS_ANY,
+    /** Keep the splits whose transaction has another split in one of
+     *  the filter accounts. */
+    GNC_REPORT_ACCOUNTS_INCLUDE,
+    /** Leave out the splits whose transaction has another split in
+     *  one of the filter accounts. */
+    GNC_REPORT_ACCOUNTS_EXCLUDE,
+} GncReportAccountFilter;
+
+typedef gboolean (*GncReportSplitFunc) (Split *split, gpointer user_data);
+
+typedef struct
+{
+    /** The filter accounts and how to use them. */
+    GList *accounts;
+    GncReportAccountFilter account_filter;
+    /** Keep the splits whose transaction description, transaction
+     *  notes or memo contains this, unless it's NULL or empty. */
+    const char *matcher;
+    /** Leave out the splits matcher matches instead. */
+    gboolean matcher_exclude;
+    /** If not NULL, keep only the splits for which it returns TRUE. It
+     *  is called last, for the splits the other filters keep. It must
+     *  return normally, not longjmp out of the C++ code calling it. */
+    GncReportSplitFunc func;
+    gpointer user_data;
+} GncReportSplitFilter;
+
+typedef struct
+{
+    GncReportSortKey key;
+    /** The period GNC_REPORT_KEY_DATE and GNC_REPORT_KEY_RECONCILED_DATE
+     *  compare; groups of both are by the posted date. */
+    GncReportDateGroup date_group;
+    gboolean ascending;
+} GncReportSortLevel;
+
+typedef struct GncReportSplits GncReportSplits;
+
+/** Filter a list of splits and, if sort is TRUE, sort them by the
+ *  primary key and then the secondary key. Splits the keys don't order
+ *  keep their order in the list.
+ *
+ *  @param splits The splits, usually the result of the report's query.
+ *  @param filter The filters, or NULL to keep every split.
+ *  @param primary The primary key.
+ *  @param secondary The secondary key.
+ *  @param sort FALSE if the splits are already in order, e.g. because
+ *  the query sorted them; they're then only grouped.
+ *  @return The rows of the report, to free with gnc_report_splits_free().
+ */
+GncReportSplits *gnc_report_splits_new (GList *splits,
+                                        const GncReportSplitFilter *filter,
+                                        const GncReportSortLevel *primary,
+                                        const GncReportSortLevel *secondary,
+                                        gboolean sort);
+
+void gnc_report_splits_free (GncReportSplits *rows);
+
+guint gnc_report_splits_get_num_rows (const GncReportSplits *rows);
+
+/** The split in a row, or NULL if there is no such row. */
+Split *gnc_report_splits_get_split (const GncReportSplits *rows, guint row);
+
+/** The group of a row for the primary (level 0) or secondary (level 1)
+ *  key, or -1 if the key doesn't group or there is no such row. */
+gint gnc_report_splits_get_group (const GncReportSplits *rows, guint level,
+                                  guint row);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /*__cplusplus*/
+#endif /* GNC_REPORT_SPLITS_H */
+/** @} */
@@ -0,0 +1,49 @@
+/********************************************************************\
+ * gnc-report-splits.hpp -- Filter, sort and group splits for       *
+ *                          reports                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef GNC_REPORT_SPLITS_HPP
+#define GNC_REPORT_SPLITS_HPP
+
+extern "C"
+{
+#include "gnc-report-splits.h"
+}
+
+#include <array>
+#include <vector>
+
+/** The rows of a transaction report, one column per attribute, see
+ * gnc_report_splits_new(). */
+struct GncReportSplits
+{
+    GncReportSplits (GList* splits, const GncReportSplitFilter* filter,
+                     const GncReportSortLevel& primary,
+                     const GncReportSortLevel& secondary, bool sort);
+
+    /** The splits in report order. */
+    std::vector<Split*> splits;
+    /** The group of each split for the primary and the secondary key,
+     * all -1 for a key which doesn't group. */
+    std::array<std::vector<gint>, 2> groups;
+};
+
+#endif //GNC_REPORT_SPLITS_HPP
@@ -0,0 +1,672 @@
+/********************************************************************\
+ * gnc-text-index.cpp -- Full-text index over transaction strings.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-engine.h"
+#include "gnc-text-index.h"
+}
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+#include "gnc-text-index.hpp"
+#include "qofevent-p.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+#define GNC_TEXT_INDEX_KEY "gnc-text-index"
+
+/* ==================================================================== */
+/* GncTextIndex */
+
+static std::string
+fold_string (const char* text)
+{
+    /* Same folding as qof_utf8_substr_nocase */
+    auto casefold = g_utf8_casefold (text, -1);
+    auto normalized = g_utf8_normalize (casefold, -1, G_NORMALIZE_ALL);
+    g_free (casefold);
+    std::string retval{normalized ? normalized : ""};
+    g_free (normalized);
+    return retval;
+}
+
+std::vector<GncTextIndex::Word>
+GncTextIndex::tokenize (const char* text)
+{
+    std::vector<Word> words;
+    if (!text || !*text || !g_utf8_validate (text, -1, nullptr))
+        return words;
+
+    auto folded = fold_string (text);
+    const char* begin = folded.c_str();
+    const char* word_start = nullptr;
+    for (auto p = begin; *p; p = g_utf8_next_char (p))
+    {
+        auto uc = g_utf8_get_char (p);
+        if (g_unichar_isalnum (uc) || g_unichar_ismark (uc))
+        {
+            if (!word_start)
+                word_start = p;
+            continue;
+        }
+        if (word_start)
+        {
+            words.push_back({std::string(word_start, p),
+                             word_start == begin, false});
+            word_start = nullptr;
+        }
+    }
+    if (word_start)
+        words.push_back({std::string(word_start), word_start == begin, true});
+    return words;
+}
+
+void
+GncTextIndex::add_posting (const std::string& word, DocId id)
+{
+    auto& postings = m_words[word];
+    auto pos = std::lower_bound (postings.begin(), postings.end(), id);
+    if (pos == postings.end() || *pos != id)
+        postings.insert (pos, id);
+}
+
+void
+GncTextIndex::set (const void* doc, const char* text)
+{
+    remove (doc);
+    auto words = tokenize (text);
+    if (words.empty())
+        return;
+
+    DocId id;
+    if (m_free_ids.empty())
+    {
+        id = m_docs.size();
+        m_docs.push_back (doc);
+        m_doc_words.emplace_back();
+    }
+    else
+    {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+        m_docs[id] = doc;
+    }
+    m_ids[doc] = id;
+
+    auto& doc_words = m_doc_words[id];
+    for (const auto& word : words)
+    {
+        add_posting (word.text, id);
+        auto entry = m_words.find (word.text);
+        if (std::find (doc_words.begin(), doc_words.end(), &entry->first) ==
+            doc_words.end())
+            doc_words.push_back (&entry->first);
+    }
+}
+
+void
+GncTextIndex::remove (const void* doc)
+{
+    auto iter = m_ids.find (doc);
+    if (iter == m_ids.end())
+        return;
+
+    auto id = iter->second;
+    for (auto word : m_doc_words[id])
+    {
+        auto entry = m_words.find (*word);
+        auto& postings = entry->second;
+        auto pos = std::lower_bound (postings.begin(), postings.end(), id);
+        if (pos != postings.end() && *pos == id)
+            postings.erase (pos);
+        if (postings.empty())
+            m_words.erase (entry);
+    }
+    m_doc_words[id].clear();
+    m_docs[id] = nullptr;
+    m_free_ids.push_back (id);
+    m_ids.erase (iter);
+}
+
+void
+GncTextIndex::clear () noexcept
+{
+    m_words.clear();
+    m_docs.clear();
+    m_doc_words.clear();
+    m_ids.clear();
+    m_free_ids.clear();
+}
+
+static GncTextIndex::Postings
+merge_postings (const std::vector<const GncTextIndex::Postings*>& lists)
+{
+    if (lists.size() == 1)
+        return *lists.front();
+    GncTextIndex::Postings result;
+    for (auto list : lists)
+        result.insert (result.end(), list->begin(), list->end());
+    std::sort (result.begin(), result.end());
+    result.erase (std::unique (result.begin(), result.end()), result.end());
+    return result;
+}
+
+static void
+intersect_postings (GncTextIndex::Postings& result,
+                    const GncTextIndex::Postings& other)
+{
+    GncTextIndex::Postings tmp;
+    std::set_intersection (result.begin(), result.end(),
+                           other.begin(), other.end(),
+                           std::back_inserter (tmp));
+    result.swap (tmp);
+}
+
+/* A word which is cut off by the edge of the pattern can be the tail,
+ * the head or any part of an indexed word; a word delimited on both
+ * sides must match exactly. */
+GncTextIndex::Postings
+GncTextIndex::word_candidates (const Word& word) const
+{
+    std::vector<const Postings*> lists;
+    if (!word.open_left && !word.open_right)
+    {
+        auto entry = m_words.find (word.text);
+        if (entry != m_words.end())
+            lists.push_back (&entry->second);
+    }
+    else if (!word.open_left)
+    {
+        for (auto entry = m_words.lower_bound (word.text);
+             entry != m_words.end() &&
+                 entry->first.compare (0, word.text.size(), word.text) == 0;
+             ++entry)
+            lists.push_back (&entry->second);
+    }
+    else
+    {
+        auto len = word.text.size();
+        for (const auto& entry : m_words)
+        {
+            const auto& key = entry.first;
+            if (key.size() < len)
+                continue;
+            if (word.open_right ? key.find (word.text) != std::string::npos :
+                key.compare (key.size() - len, len, word.text) == 0)
+                lists.push_back (&entry.second);
+        }
+    }
+    if (lists.empty())
+        return Postings{};
+    return merge_postings (lists);
+}
+
+bool
+GncTextIndex::substring_candidates (const char* pattern,
+                                    Postings& result) const
+{
+    auto words = tokenize (pattern);
+    if (words.empty())
+        return false;
+
+    result.clear();
+    bool first = true;
+    for (const auto& word : words)
+    {
+        auto candidates = word_candidates (word);
+        if (first)
+            result.swap (candidates);
+        else
+            intersect_postings (result, candidates);
+        first = false;
+        if (result.empty())
+            break;
+    }
+    return true;
+}
+
+GncTextIndex::Postings
+GncTextIndex::prefix_match (const char* text) const
+{
+    Postings result;
+    bool first = true;
+    for (auto& word : tokenize (text))
+    {
+        word.open_left = false;
+        word.open_right = true;
+        auto candidates = word_candidates (word);
+        if (first)
+            result.swap (candidates);
+        else
+            intersect_postings (result, candidates);
+        first = false;
+        if (result.empty())
+            break;
+    }
+    return result;
+}
+
+/* ==================================================================== */
+/* Per-book indexes */
+
+struct BookTextIndex
+{
+    GncTextIndex description;
+    GncTextIndex notes;
+    GncTextIndex memo;
+    guint dropped_events;
+    bool valid;
+};
+
+static gboolean text_index_enabled = FALSE;
+static gint text_index_handler_id = 0;
+static std::unordered_set<BookTextIndex*> book_indexes;
+
+static void
+text_index_add_split (BookTextIndex* index, Split* split)
+{
+    index->memo.set (split, xaccSplitGetMemo (split));
+}
+
+static void
+text_index_add_trans (BookTextIndex* index, Transaction* trans)
+{
+    index->description.set (trans, xaccTransGetDescription (trans));
+    index->notes.set (trans, xaccTransGetNotes (trans));
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+        text_index_add_split (index, static_cast<Split*>(node->data));
+}
+
+static void
+text_index_remove_trans (BookTextIndex* index, Transaction* trans)
+{
+    index->description.remove (trans);
+    index->notes.remove (trans);
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+        index->memo.remove (node->data);
+}
+
+static void
+text_index_build_cb (QofInstance* inst, gpointer data)
+{
+    text_index_add_trans (static_cast<BookTextIndex*>(data),
+                          GNC_TRANSACTION (inst));
+}
+
+static void
+text_index_clear (BookTextIndex* index)
+{
+    index->description.clear();
+    index->notes.clear();
+    index->memo.clear();
+    index->valid = false;
+}
+
+static void
+text_index_free (QofBook* book, gpointer key, gpointer data)
+{
+    auto index = static_cast<BookTextIndex*>(data);
+    book_indexes.erase (index);
+    delete index;
+}
+
+static bool
+text_index_is_current (const BookTextIndex* index)
+{
+    return index && index->valid &&
+        index->dropped_events == qof_event_get_dropped_count ();
+}
+
+/* Return the index for book, building it if it doesn't exist yet or if
+ * it might have missed a change while events were suspended. */
+static BookTextIndex*
+text_index_get (QofBook* book)
+{
+    if (!text_index_enabled || !book)
+        return nullptr;
+
+    auto index = static_cast<BookTextIndex*>(qof_book_get_data (book,
+                                                                GNC_TEXT_INDEX_KEY));
+    if (text_index_is_current (index))
+        return index;
+
+    ENTER ("book=%p", book);
+    if (!index)
+    {
+        index = new BookTextIndex;
+        book_indexes.insert (index);
+        qof_book_set_data_fin (book, GNC_TEXT_INDEX_KEY, index,
+                               text_index_free);
+    }
+    text_index_clear (index);
+    index->dropped_events = qof_event_get_dropped_count ();
+    index->valid = true;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            text_index_build_cb, index);
+    LEAVE ("indexed %zu descriptions, %zu notes, %zu memos; %zu words",
+           index->description.num_docs(), index->notes.num_docs(),
+           index->memo.num_docs(),
+           index->description.num_words() + index->notes.num_words() +
+           index->memo.num_words());
+    return index;
+}
+
+static void
+text_index_event_handler (QofInstance* ent, QofEventId event_type,
+                          gpointer handler_data, gpointer event_data)
+{
+    auto book = qof_instance_get_book (ent);
+    if (!book)
+        return;
+
+    /* Don't build an index nobody has asked for yet. */
+    auto index = static_cast<BookTextIndex*>(qof_book_get_data (book,
+                                                                GNC_TEXT_INDEX_KEY));
+    if (!text_index_is_current (index))
+        return;
+
+    if (GNC_IS_TRANSACTION (ent))
+    {
+        auto trans = GNC_TRANSACTION (ent);
+        if (event_type & QOF_EVENT_DESTROY)
+            text_index_remove_trans (index, trans);
+        else if (event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY))
+            text_index_add_trans (index, trans);
+    }
+    else if (GNC_IS_SPLIT (ent))
+    {
+        /* QOF_EVENT_REMOVE only means the split moved to another
+         * transaction, it's still there. */
+        auto split = GNC_SPLIT (ent);
+        if (event_type & QOF_EVENT_DESTROY)
+            index->memo.remove (split);
+        else if (event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY))
+            text_index_add_split (index, split);
+    }
+}
+
+/* ==================================================================== */
+/* Query access path */
+
+enum class IndexedField { NONE, DESCRIPTION, NOTES, MEMO };
+
+static IndexedField
+term_field (QofIdTypeConst search_for, QofQueryParamList* path)
+{
+    auto param = [&path](const char* name) -> bool
+        {
+            if (!path || g_strcmp0 (static_cast<char*>(path->data), name))
+                return false;
+            path = path->next;
+            return true;
+        };
+    if (!g_strcmp0 (search_for, GNC_ID_SPLIT))
+    {
+        if (param (SPLIT_MEMO))
+            return path ? IndexedField::NONE : IndexedField::MEMO;
+        if (!param (SPLIT_TRANS))
+            return IndexedField::NONE;
+    }
+    if (param (TRANS_DESCRIPTION))
+        return path ? IndexedField::NONE : IndexedField::DESCRIPTION;
+    if (param (TRANS_NOTES))
+        return path ? IndexedField::NONE : IndexedField::NOTES;
+    return IndexedField::NONE;
+}
+
+using ObjectSet = std::vector<const void*>;
+
+static void
+add_candidates (ObjectSet& set, const GncTextIndex& index,
+                const GncTextIndex::Postings& postings, bool to_splits)
+{
+    for (auto id : postings)
+    {
+        auto doc = index.doc (id);
+        if (!to_splits)
+        {
+            set.push_back (doc);
+            continue;
+        }
+        auto trans = static_cast<const Transaction*>(doc);
+        for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+            set.push_back (node->data);
+    }
+}
+
+static void
+sort_set (ObjectSet& set)
+{
+    std::sort (set.begin(), set.end());
+    set.erase (std::unique (set.begin(), set.end()), set.end());
+}
+
+/* Candidates for a single term, or FALSE if the term can't use the
+ * index. */
+static bool
+term_candidates (BookTextIndex* index, QofIdTypeConst search_for,
+                 QofQueryTerm* term, ObjectSet& result)
+{
+    if (qof_query_term_is_inverted (term))
+        return false;
+    auto pd = qof_query_term_get_pred_data (term);
+    if (!pd || g_strcmp0 (pd->type_name, QOF_TYPE_STRING))
+        return false;
+    auto pdata = reinterpret_cast<query_string_t>(pd);
+    if (pdata->is_regex)
+        return false;
+    /* The index folds case and normalizes like qof_utf8_substr_nocase,
+     * so it only finds everything a case insensitive "contains" matches.
+     * Normalizing can reorder, compose or replace characters, so a
+     * byte-wise match may not be found, and case insensitive equality
+     * uses collation, which isn't a substring relation. */
+    if (pd->how != QOF_COMPARE_CONTAINS ||
+        pdata->options != QOF_STRING_MATCH_CASEINSENSITIVE)
+        return false;
+
+    auto field = term_field (search_for, qof_query_term_get_param_path (term));
+    const GncTextIndex* text_index = nullptr;
+    switch (field)
+    {
+    case IndexedField::DESCRIPTION:
+        text_index = &index->description;
+        break;
+    case IndexedField::NOTES:
+        text_index = &index->notes;
+        break;
+    case IndexedField::MEMO:
+        text_index = &index->memo;
+        break;
+    default:
+        return false;
+    }
+
+    GncTextIndex::Postings postings;
+    if (!text_index->substring_candidates (pdata->matchstring, postings))
+        return false;
+    result.clear();
+    add_candidates (result, *text_index, postings,
+                    field != IndexedField::MEMO &&
+                    !g_strcmp0 (search_for, GNC_ID_SPLIT));
+    sort_set (result);
+    return true;
+}
+
+static gboolean
+text_index_access_path (QofQuery* q, QofBook* book, GList** candidates)
+{
+    auto index = text_index_get (book);
+    if (!index)
+        return FALSE;
+
+    auto search_for = qof_query_get_search_for (q);
+    ObjectSet result;
+    auto or_terms = qof_query_get_terms (q);
+    if (!or_terms)
+        return FALSE;
+
+    /* Each OR-term needs at least one indexable AND-term; the result is
+     * the union over OR-terms of the intersection of those. */
+    for (auto or_node = or_terms; or_node; or_node = or_node->next)
+    {
+        ObjectSet and_result;
+        bool usable = false;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
+        {
+            ObjectSet term_result;
+            if (!term_candidates (index, search_for,
+                                  static_cast<QofQueryTerm*>(and_node->data),
+                                  term_result))
+                continue;
+            if (!usable)
+            {
+                and_result.swap (term_result);
+                usable = true;
+            }
+            else
+            {
+                ObjectSet tmp;
+                std::set_intersection (and_result.begin(), and_result.end(),
+                                       term_result.begin(), term_result.end(),
+                                       std::back_inserter (tmp));
+                and_result.swap (tmp);
+            }
+        }
+        if (!usable)
+            return FALSE;
+        result.insert (result.end(), and_result.begin(), and_result.end());
+    }
+    sort_set (result);
+
+    *candidates = nullptr;
+    for (auto obj = result.rbegin(); obj != result.rend(); ++obj)
+        *candidates = g_list_prepend (*candidates, const_cast<void*>(*obj));
+    return TRUE;
+}
+
+/* ==================================================================== */
+/* Public API */
+
+void
+gnc_text_index_set_enabled (gboolean enabled)
+{
+    if (!enabled == !text_index_enabled)
+        return;
+
+    text_index_enabled = enabled;
+    if (enabled)
+    {
+        text_index_handler_id =
+            qof_event_register_handler (text_index_event_handler, nullptr);
+        qof_query_register_access_path (GNC_ID_SPLIT, text_index_access_path);
+        qof_query_register_access_path (GNC_ID_TRANS, text_index_access_path);
+        return;
+    }
+
+    qof_query_register_access_path (GNC_ID_SPLIT, nullptr);
+    qof_query_register_access_path (GNC_ID_TRANS, nullptr);
+    qof_event_unregister_handler (text_index_handler_id);
+    text_index_handler_id = 0;
+
+    /* The indexes aren't maintained any longer so empty them; they're
+     * rebuilt if the index is enabled again. */
+    for (auto index : book_indexes)
+        text_index_clear (index);
+}
+
+gboolean
+gnc_text_index_get_enabled (void)
+{
+    return text_index_enabled;
+}
+
+/* Objects having, for each word, a word starting with it in one of the
+ * fields. Transactions collect split memo matches, splits collect their
+ * transaction's description and notes matches. */
+static GList*
+text_index_find (QofBook* book, const char* text, bool splits)
+{
+    auto index = text_index_get (book);
+    if (!index || !text)
+        return nullptr;
+
+    ObjectSet result;
+    bool first = true;
+    for (const auto& word : GncTextIndex::tokenize (text))
+    {
+        ObjectSet word_result;
+        for (auto text_index : {&index->description, &index->notes})
+            add_candidates (word_result, *text_index,
+                            text_index->prefix_match (word.text.c_str()),
+                            splits);
+        for (auto id : index->memo.prefix_match (word.text.c_str()))
+        {
+            auto split = static_cast<const Split*>(index->memo.doc (id));
+            if (splits)
+                word_result.push_back (split);
+            else
+                word_result.push_back (xaccSplitGetParent (split));
+        }
+        sort_set (word_result);
+        if (first)
+        {
+            result.swap (word_result);
+            first = false;
+        }
+        else
+        {
+            ObjectSet tmp;
+            std::set_intersection (result.begin(), result.end(),
+                                   word_result.begin(), word_result.end(),
+                                   std::back_inserter (tmp));
+            result.swap (tmp);
+        }
+        if (result.empty())
+            break;
+    }
+
+    GList* list = nullptr;
+    for (auto obj : result)
+        list = g_list_prepend (list, const_cast<void*>(obj));
+    return g_list_reverse (list);
+}
+
+GList*
+gnc_text_index_find_transactions (QofBook* book, const char* text)
+{
+    return text_index_find (book, text, false);
+}
+
+GList*
+gnc_text_index_find_splits (QofBook* book, const char* text)
+{
+    return text_index_find (book, text, true);
+}
@@ -0,0 +1,74 @@
+/********************************************************************\
+ * gnc-text-index.h -- Full-text index over transaction strings.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-text-index.h
+ *  @brief Optional word index over transaction descriptions, notes and
+ *  split memos.
+ *
+ *  When enabled, each book gets an inverted index (word -> sorted list
+ *  of transactions or splits) which is built the first time it is
+ *  needed and then kept up to date from engine events, i.e. whenever a
+ *  transaction is committed. If events were suspended while the book
+ *  changed (e.g. while loading) the index is rebuilt on next use.
+ *
+ *  The index is registered with the query engine as an access path for
+ *  splits and transactions: a query whose every OR-term contains a
+ *  non-inverted, case insensitive "contains" match on the description,
+ *  notes or memo only checks the objects the index proposes instead of
+ *  the whole book. Case sensitive and exact matches always scan the
+ *  book, because the index's folding doesn't preserve them. Changes made inside an open edit are not visible to the
+ *  index until the transaction is committed.
+ */
+
+#ifndef GNC_TEXT_INDEX_H
+#define GNC_TEXT_INDEX_H
+
+#include "qof.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Turn the text index on or off for all books. gnc_engine_init()
+ *  turns it on and gnc_engine_shutdown() off; it's off if only QOF is
+ *  initialized. Turning it off frees all indexes. */
+void gnc_text_index_set_enabled (gboolean enabled);
+gboolean gnc_text_index_get_enabled (void);
+
+/** Find the transactions whose description, notes or any split memo
+ *  contain a word starting with each of the words in text. Matching is
+ *  case insensitive. The caller owns the returned list but not its
+ *  contents. Returns NULL if the index is disabled.
+ */
+GList *gnc_text_index_find_transactions (QofBook *book, const char *text);
+
+/** Like gnc_text_index_find_transactions() but for splits: a split
+ *  matches if its memo or its transaction's description or notes
+ *  contain the words. */
+GList *gnc_text_index_find_splits (QofBook *book, const char *text);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /*__cplusplus*/
+#endif /* GNC_TEXT_INDEX_H */
+/** @} */
@@ -0,0 +1,94 @@
+/********************************************************************\
+ * gnc-text-index.hpp -- Inverted word index over engine strings.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef GNC_TEXT_INDEX_HPP
+#define GNC_TEXT_INDEX_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** An inverted index mapping case-folded, normalized words to the
+ * sorted list of documents containing them. A document is any object
+ * pointer; each document holds a single string (one index is kept per
+ * indexed field).
+ *
+ * Words are runs of letters, digits and combining marks after the
+ * string has been case-folded and normalized the same way
+ * qof_utf8_substr_nocase() does, so the index can serve as a superset filter for both case
+ * sensitive and case insensitive substring searches.
+ */
+class GncTextIndex
+{
+public:
+    using DocId = uint32_t;
+    using Postings = std::vector<DocId>;
+
+    /** A word found in a string together with whether it might continue
+     * past the left or right edge of that string. */
+    struct Word
+    {
+        std::string text;
+        bool open_left;
+        bool open_right;
+    };
+
+    GncTextIndex() = default;
+    GncTextIndex(const GncTextIndex&) = delete;
+    GncTextIndex& operator=(const GncTextIndex&) = delete;
+
+    /** Split a string into folded words. */
+    static std::vector<Word> tokenize (const char* text);
+
+    /** Index doc under text, replacing whatever it was indexed under. A
+     * NULL or empty text just removes the document. */
+    void set (const void* doc, const char* text);
+    /** Drop doc from the index. */
+    void remove (const void* doc);
+    void clear () noexcept;
+
+    /** Compute the documents which may contain pattern as a substring.
+     * @return false if pattern contains no words, in which case the
+     * index can't narrow the search at all. */
+    bool substring_candidates (const char* pattern, Postings& result) const;
+    /** Compute the documents containing a word beginning with each of
+     * the words in text. */
+    Postings prefix_match (const char* text) const;
+
+    const void* doc (DocId id) const noexcept { return m_docs[id]; }
+    size_t num_docs () const noexcept { return m_ids.size(); }
+    size_t num_words () const noexcept { return m_words.size(); }
+
+private:
+    using WordMap = std::map<std::string, Postings>;
+    Postings word_candidates (const Word& word) const;
+    void add_posting (const std::string& word, DocId id);
+
+    WordMap m_words;
+    std::vector<const void*> m_docs;
+    std::vector<std::vector<const std::string*>> m_doc_words;
+    std::unordered_map<const void*, DocId> m_ids;
+    std::vector<DocId> m_free_ids;
+};
+
+#endif //GNC_TEXT_INDEX_HPP
@@ -36,7 +36,9 @@
 #include "gncEntryP.h"
 #include "gnc-features.h"
 #include "gncInvoice.h"
+#include "gncInvoiceP.h"
 #include "gncOrder.h"
+#include "gncTaxTableP.h"
 
 struct _gncEntry
 {
@@ -87,7 +89,6 @@ struct _gncEntry
     gnc_numeric	i_tax_value_rounded;
     gnc_numeric	i_disc_value;
     gnc_numeric	i_disc_value_rounded;
-    time64	i_taxtable_modtime;
 
     /* vendor bill */
     gnc_numeric	b_value;
@@ -95,7 +96,8 @@ struct _gncEntry
     GList *	b_tax_values;
     gnc_numeric	b_tax_value;
     gnc_numeric	b_tax_value_rounded;
-    time64	b_taxtable_modtime;
+
+    guint64	taxtable_changes;
 };
 
 struct _gncEntryClass
@@ -205,6 +207,8 @@ void mark_entry (GncEntry *entry)
 {
     qof_instance_set_dirty(&entry->inst);
     qof_event_gen (&entry->inst, QOF_EVENT_MODIFY, NULL);
+    gncInvoiceInvalidateTotals (entry->invoice);
+    gncInvoiceInvalidateTotals (entry->bill);
 }
 
 /* ================================================================ */
@@ -1321,24 +1325,13 @@ gncEntryRecomputeValues (GncEntry *entry)
     int denom;
     GList *tv_iter;
 
-    /* See if either tax table changed since we last computed values */
-    if (entry->i_tax_table)
+    /* See if a tax table changed since we last computed values. The
+     * modification times only count seconds, so use the change count. */
+    if ((entry->i_tax_table || entry->b_tax_table) &&
+        entry->taxtable_changes != gncTaxTableGetChangeCount ())
     {
-        time64 modtime = gncTaxTableLastModifiedSecs (entry->i_tax_table);
-        if (entry->i_taxtable_modtime != modtime)
-        {
-            entry->values_dirty = TRUE;
-            entry->i_taxtable_modtime = modtime;
-        }
-    }
-    if (entry->b_tax_table)
-    {
-        time64 modtime = gncTaxTableLastModifiedSecs (entry->b_tax_table);
-        if (entry->b_taxtable_modtime != modtime)
-        {
-            entry->values_dirty = TRUE;
-            entry->b_taxtable_modtime = modtime;
-        }
+        entry->values_dirty = TRUE;
+        entry->taxtable_changes = gncTaxTableGetChangeCount ();
     }
 
     if (!entry->values_dirty)
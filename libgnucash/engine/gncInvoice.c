@@ -44,6 +44,7 @@
 #include "gncInvoice.h"
 #include "gncInvoiceP.h"
 #include "gncOwnerP.h"
+#include "gncTaxTableP.h"
 #include "engine-helpers.h"
 
 struct _gncInvoice
@@ -72,6 +73,12 @@ struct _gncInvoice
     Account       *posted_acc;
     Transaction   *posted_txn;
     GNCLot        *posted_lot;
+
+    /* Remembered until the invoice, one of its entries or a tax table
+     * changes. */
+    gboolean      totals_valid;
+    guint64       totals_taxtable_changes;
+    GncInvoiceTotals totals;
 };
 
 struct _gncInvoiceClass
@@ -99,10 +106,17 @@ static void mark_invoice (GncInvoice *invoice);
 static void
 mark_invoice (GncInvoice *invoice)
 {
+    invoice->totals_valid = FALSE;
     qof_instance_set_dirty(&invoice->inst);
     qof_event_gen (&invoice->inst, QOF_EVENT_MODIFY, NULL);
 }
 
+void gncInvoiceInvalidateTotals (GncInvoice *invoice)
+{
+    if (invoice)
+        invoice->totals_valid = FALSE;
+}
+
 QofBook * gncInvoiceGetBook(GncInvoice *x)
 {
     return qof_instance_get_book(QOF_INSTANCE(x));
@@ -967,22 +981,63 @@ gncInvoiceGetTotalInternal(GncInvoice *invoice, gboolean use_value,
     return total;
 }
 
+/* The subtotal, tax and total all come from one pass over the entries,
+ * giving the same results as computing each separately. */
+static const GncInvoiceTotals *
+gncInvoiceGetTotalsInternal (GncInvoice *invoice)
+{
+    AccountValueList *taxes;
+    guint64 taxtable_changes = gncTaxTableGetChangeCount ();
+
+    if (invoice->totals_valid &&
+        invoice->totals_taxtable_changes == taxtable_changes)
+        return &invoice->totals;
+
+    invoice->totals.subtotal =
+        gncInvoiceGetNetAndTaxesInternal (invoice, TRUE, &taxes, FALSE, 0);
+    invoice->totals.tax = gncInvoiceSumTaxesInternal (taxes);
+    gncAccountValueDestroy (taxes);
+    invoice->totals.total = gnc_numeric_add (invoice->totals.subtotal,
+                                             invoice->totals.tax,
+                                             GNC_DENOM_AUTO,
+                                             GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND_HALF_UP);
+    invoice->totals_valid = TRUE;
+    invoice->totals_taxtable_changes = taxtable_changes;
+    return &invoice->totals;
+}
+
 gnc_numeric gncInvoiceGetTotal (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero();
-    return gncInvoiceGetTotalInternal(invoice, TRUE, TRUE, FALSE, 0);
+    return gncInvoiceGetTotalsInternal (invoice)->total;
 }
 
 gnc_numeric gncInvoiceGetTotalSubtotal (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero();
-    return gncInvoiceGetTotalInternal(invoice, TRUE, FALSE, FALSE, 0);
+    return gncInvoiceGetTotalsInternal (invoice)->subtotal;
 }
 
 gnc_numeric gncInvoiceGetTotalTax (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero();
-    return gncInvoiceGetTotalInternal(invoice, FALSE, TRUE, FALSE, 0);
+    return gncInvoiceGetTotalsInternal (invoice)->tax;
+}
+
+GncInvoiceTotals *gncInvoiceGetTotalsList (GList *invoices)
+{
+    GncInvoiceTotals *totals = g_new0 (GncInvoiceTotals, g_list_length (invoices));
+    GncInvoiceTotals *next = totals;
+    GList *node;
+
+    for (node = invoices; node; node = node->next, next++)
+    {
+        if (node->data)
+            *next = *gncInvoiceGetTotalsInternal (node->data);
+        else
+            next->subtotal = next->tax = next->total = gnc_numeric_zero ();
+    }
+    return totals;
 }
 
 gnc_numeric gncInvoiceGetTotalOf (GncInvoice *invoice, GncEntryPaymentType type)
@@ -1919,8 +1974,8 @@ void gncInvoiceAutoApplyPayments (GncInvoice *invoice)
      * could be used. */
     lm.positive_balance =  gnc_numeric_positive_p (gnc_lot_get_balance (inv_lot));
     lm.owner = owner;
-    lot_list = xaccAccountFindOpenLots (acct, gnc_lot_match_owner_balancing,
-                                        &lm, NULL);
+    lot_list = gncOwnerFindOpenLots (owner, acct, gnc_lot_match_owner_balancing,
+                                     &lm, NULL);
 
     lot_list = g_list_prepend (lot_list, inv_lot);
     gncOwnerAutoApplyPaymentsWithLots (owner, lot_list);
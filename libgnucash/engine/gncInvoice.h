@@ -164,6 +164,21 @@ gnc_numeric gncInvoiceGetTotal (GncInvoice *invoice);
 gnc_numeric gncInvoiceGetTotalOf (GncInvoice *invoice, GncEntryPaymentType type);
 gnc_numeric gncInvoiceGetTotalSubtotal (GncInvoice *invoice);
 gnc_numeric gncInvoiceGetTotalTax (GncInvoice *invoice);
+
+/** The subtotal, tax and total of an invoice, as gncInvoiceGetTotalSubtotal,
+ *  gncInvoiceGetTotalTax and gncInvoiceGetTotal return them. */
+typedef struct
+{
+    gnc_numeric subtotal;
+    gnc_numeric tax;
+    gnc_numeric total;
+} GncInvoiceTotals;
+
+/** Return the totals of each of the invoices, in the same order, in a
+ *  newly allocated array the caller frees with g_free. The totals are
+ *  remembered until the invoice, one of its entries or a tax table
+ *  changes, so lists of many invoices can ask for them again cheaply. */
+GncInvoiceTotals *gncInvoiceGetTotalsList (GList *invoices);
 /** Return a list of tax totals accumulated per tax account.
  */
 AccountValueList *gncInvoiceGetTotalTaxList (GncInvoice *invoice);
@@ -45,5 +45,8 @@ void gncInvoiceAttachToLot (GncInvoice *invoice, GNCLot *lot);
 void gncInvoiceDetachFromLot (GNCLot *lot);
 void gncInvoiceAttachToTxn (GncInvoice *invoice, Transaction *txn);
 
+/* Called when one of the invoice's entries changes. */
+void gncInvoiceInvalidateTotals (GncInvoice *invoice);
+
 #define gncInvoiceSetGUID(I,G) qof_instance_set_guid(QOF_INSTANCE(I),(G))
 #endif /* GNC_INVOICEP_H_ */
@@ -44,6 +44,7 @@
 #include "gncVendorP.h"
 #include "gncInvoice.h"
 #include "gnc-commodity.h"
+#include "AccountP.h"
 #include "Scrub2.h"
 #include "Split.h"
 #include "Transaction.h"
@@ -725,6 +726,41 @@ gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data)
     return gncOwnerEqual (end_owner, req_owner);
 }
 
+LotList *
+gncOwnerFindOpenLots (const GncOwner *owner, const Account *account,
+                      gboolean (*match_func)(GNCLot *lot, gpointer user_data),
+                      gpointer user_data, GCompareFunc sort_func)
+{
+    const GncOwner *end_owner = gncOwnerGetEndOwner (owner);
+    GList *jobs = NULL, *guids = NULL, *node;
+    LotList *lots;
+
+    if (!account) return NULL;
+
+    /* Documents posted to a job record the job as their owner. */
+    switch (gncOwnerGetType (end_owner))
+    {
+    case GNC_OWNER_CUSTOMER:
+        jobs = gncCustomerGetJoblist (gncOwnerGetCustomer (end_owner), TRUE);
+        break;
+    case GNC_OWNER_VENDOR:
+        jobs = gncVendorGetJoblist (gncOwnerGetVendor (end_owner), TRUE);
+        break;
+    default:
+        break;
+    }
+    for (node = jobs; node; node = node->next)
+        guids = g_list_prepend (guids, (gpointer)qof_instance_get_guid (node->data));
+    if (gncOwnerGetGUID (end_owner))
+        guids = g_list_prepend (guids, (gpointer)gncOwnerGetGUID (end_owner));
+
+    lots = xaccAccountFindOpenLotsByOwner (account, guids, match_func,
+                                           user_data, sort_func);
+    g_list_free (guids);
+    g_list_free (jobs);
+    return lots;
+}
+
 gint
 gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB)
 {
@@ -1426,8 +1462,9 @@ gncOwnerApplyPaymentSecs (const GncOwner *owner, Transaction **preset_txn,
     if (lots)
         selected_lots = lots;
     else if (auto_pay)
-        selected_lots = xaccAccountFindOpenLots (posted_acc, gncOwnerLotMatchOwnerFunc,
-                        (gpointer)owner, NULL);
+        selected_lots = gncOwnerFindOpenLots (owner, posted_acc,
+                                              gncOwnerLotMatchOwnerFunc,
+                                              (gpointer)owner, NULL);
 
     /* And link the selected lots and the payment lot together as well as possible.
      * If the payment was bigger than the selected documents/overpayments, only
@@ -1514,8 +1551,9 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
                 continue;
 
             /* Get a list of open lots for this owner and account */
-            lot_list = xaccAccountFindOpenLots (account, gncOwnerLotMatchOwnerFunc,
-                                                (gpointer)owner, NULL);
+            lot_list = gncOwnerFindOpenLots (owner, account,
+                                             gncOwnerLotMatchOwnerFunc,
+                                             (gpointer)owner, NULL);
             /* For each lot */
             for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
             {
@@ -186,6 +186,18 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot);
  */
 gboolean gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data);
 
+/** Find the open lots in account for owner, like xaccAccountFindOpenLots
+ * does, but without looking at the lots of other owners. Only the lots
+ * attached to owner's end owner or one of its jobs, and those attached
+ * to no owner at all, are passed to match_func, which must still check
+ * the owner, gncOwnerLotMatchOwnerFunc for example. The caller frees the
+ * list.
+ */
+LotList * gncOwnerFindOpenLots (const GncOwner *owner, const Account *account,
+                                gboolean (*match_func)(GNCLot *lot,
+                                        gpointer user_data),
+                                gpointer user_data, GCompareFunc sort_func);
+
 /** Helper function used to sort lots by date. If the lot is
  * linked to an invoice, use the invoice posted date, otherwise
  * use the lot's opened date.
@@ -162,10 +162,15 @@ maybe_resort_list (GncTaxTable *table)
     bi->tables = g_list_sort (bi->tables, (GCompareFunc)gncTaxTableCompare);
 }
 
+/* Counts changes to the amounts and accounts of any tax table, for
+ * the values that entries and invoices compute from them. */
+static guint64 tax_table_changes = 0;
+
 static inline void
 mod_table (GncTaxTable *table)
 {
     table->modtime = gnc_time (NULL);
+    tax_table_changes++;
 }
 
 static inline void addObj (GncTaxTable *table)
@@ -788,6 +793,11 @@ time64 gncTaxTableLastModifiedSecs (const GncTaxTable *table)
     return table->modtime;
 }
 
+guint64 gncTaxTableGetChangeCount (void)
+{
+    return tax_table_changes;
+}
+
 gboolean gncTaxTableGetInvisible (const GncTaxTable *table)
 {
     if (!table) return FALSE;
@@ -42,6 +42,11 @@ gboolean gncTaxTableGetInvisible (const GncTaxTable *table);
 
 GncTaxTable* gncTaxTableEntryGetTable( const GncTaxTableEntry* entry );
 
+/** The number of changes made to the entries of any tax table so far.
+ *  Unlike the modification times it changes with every edit, so values
+ *  computed from tax tables can be kept until it moves on. */
+guint64 gncTaxTableGetChangeCount (void);
+
 #define gncTaxTableSetGUID(E,G) qof_instance_set_guid(QOF_INSTANCE(E),(G))
 
 #endif /* GNC_TAXTABLEP_H_ */
@@ -45,14 +45,19 @@ static QofLogModule log_module = "qof.kvp";
 
 static const char delim = '/';
 
-KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
+/* The stamp of the last change to any frame; see get_change_stamp. */
+static uint64_t last_change_stamp = 0;
+
+KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept :
+    m_change_stamp {rhs.m_change_stamp}
 {
+    m_valuemap.reserve(rhs.m_valuemap.size());
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
         {
             auto key = static_cast<char *>(qof_string_cache_insert(a.first));
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            this->m_valuemap.emplace_back(key,val);
         }
     );
 }
@@ -68,18 +73,47 @@ KvpFrameImpl::~KvpFrameImpl() noexcept
     m_valuemap.clear();
 }
 
+static bool
+slot_key_less (const KvpFrameImpl::map_type::value_type & a, const char * key)
+{
+    return std::strcmp (a.first, key) < 0;
+}
+
+KvpFrameImpl::map_type::iterator
+KvpFrameImpl::find_slot (const char * key) noexcept
+{
+    auto spot = std::lower_bound (m_valuemap.begin(), m_valuemap.end(), key,
+                                  slot_key_less);
+    if (spot != m_valuemap.end () && std::strcmp (spot->first, key) == 0)
+        return spot;
+    return m_valuemap.end ();
+}
+
+KvpFrameImpl::map_type::const_iterator
+KvpFrameImpl::find_slot (const char * key) const noexcept
+{
+    return const_cast<KvpFrameImpl*>(this)->find_slot (key);
+}
+
+KvpFrame *
+KvpFrame::get_child_frame_or_nullptr (Path::const_iterator begin,
+                                      Path::const_iterator end) noexcept
+{
+    auto frame = this;
+    for (auto key = begin; frame && key != end; ++key)
+    {
+        auto spot = frame->find_slot (key->c_str ());
+        if (spot == frame->m_valuemap.end ())
+            return nullptr;
+        frame = spot->second->get <KvpFrame *> ();
+    }
+    return frame;
+}
+
 KvpFrame *
 KvpFrame::get_child_frame_or_nullptr (Path const & path) noexcept
 {
-    if (!path.size ())
-        return this;
-    auto key = path.front ();
-    if (m_valuemap.find (key.c_str ()) == m_valuemap.end ())
-        return nullptr;
-    auto child = m_valuemap.at (key.c_str ())->get <KvpFrame *> ();
-    Path send;
-    std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    return child->get_child_frame_or_nullptr (send);
+    return get_child_frame_or_nullptr (path.cbegin (), path.cend ());
 }
 
 KvpFrame *
@@ -88,12 +122,12 @@ KvpFrame::get_child_frame_or_create (Path const & path) noexcept
     if (!path.size ())
         return this;
     auto key = path.front ();
-    auto spot = m_valuemap.find (key.c_str ());
+    auto spot = find_slot (key.c_str ());
     if (spot == m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
         delete set_impl (key.c_str (), new KvpValue {new KvpFrame});
     Path send;
     std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    auto child_val = m_valuemap.at (key.c_str ());
+    auto child_val = find_slot (key.c_str ())->second;
     auto child = child_val->get <KvpFrame *> ();
     return child->get_child_frame_or_create (send);
 }
@@ -103,17 +137,33 @@ KvpValue *
 KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
-    auto spot = m_valuemap.find (key.c_str ());
+    m_change_stamp = ++last_change_stamp;
+    auto spot = find_slot (key.c_str ());
     if (spot != m_valuemap.end ())
     {
-        qof_string_cache_remove (spot->first);
         ret = spot->second;
+        if (value)
+        {
+            /* Replace in place, keeping the already interned key. */
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove (spot->first);
         m_valuemap.erase (spot);
     }
     if (value)
     {
         auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
-        m_valuemap.emplace (cachedkey, value);
+        /* Slots usually arrive in key order (e.g. when loading), so check
+         * the end before searching. */
+        if (m_valuemap.empty () ||
+            std::strcmp (m_valuemap.back ().first, cachedkey) < 0)
+            m_valuemap.emplace_back (cachedkey, value);
+        else
+            m_valuemap.emplace (std::lower_bound (m_valuemap.begin (),
+                                                  m_valuemap.end (),
+                                                  cachedkey, slot_key_less),
+                                cachedkey, value);
     }
     return ret;
 }
@@ -145,17 +195,26 @@ KvpFrameImpl::set_path (Path path, KvpValue* value) noexcept
 KvpValue *
 KvpFrameImpl::get_slot (Path path) noexcept
 {
-    auto key = path.back();
-    path.pop_back();
-    auto target = get_child_frame_or_nullptr (path);
+    if (path.empty())
+        return nullptr;
+    auto target = get_child_frame_or_nullptr (path.cbegin(), path.cend() - 1);
     if (!target)
         return nullptr;
-    auto spot = target->m_valuemap.find (key.c_str ());
+    auto spot = target->find_slot (path.back().c_str ());
     if (spot != target->m_valuemap.end ())
         return spot->second;
     return nullptr;
 }
 
+KvpValue *
+KvpFrameImpl::find_value (const char * key) const noexcept
+{
+    auto spot = find_slot (key);
+    if (spot != m_valuemap.end ())
+        return spot->second;
+    return nullptr;
+}
+
 std::string
 KvpFrameImpl::to_string() const noexcept
 {
@@ -218,7 +277,7 @@ int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
     for (const auto & a : one.m_valuemap)
     {
-        auto otherspot = two.m_valuemap.find(a.first);
+        auto otherspot = two.find_slot(a.first);
         if (otherspot == two.m_valuemap.end())
         {
             return 1;
@@ -118,7 +118,12 @@ struct KvpFrameImpl
 		return ret;
 	    }
     };
-    using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
+    /* Nearly all frames hold only a handful of slots, so rather than a
+     * std::map (one tree node per slot) the slots are kept in a vector
+     * sorted by key and found by binary search. Iteration order is the
+     * same as the map's.
+     */
+    using map_type = std::vector<std::pair<const char *, KvpValue*>>;
 
     public:
     KvpFrameImpl() noexcept {};
@@ -193,6 +198,22 @@ struct KvpFrameImpl
      */
     KvpValue* get_slot(Path keys) noexcept;
 
+    /** Get the value stored directly in this frame under key, or nullptr.
+     * Unlike get_slot(Path) this neither splits a path nor allocates, so
+     * hot accessors reading a top-level slot should use it. The key is
+     * found by comparing strings; keys aren't matched by their interned
+     * pointers because the string cache holding them is rebuilt by
+     * qof_close() and qof_init().
+     */
+    KvpValue* find_value(const char* key) const noexcept;
+
+    /** A number which changes whenever a slot in this frame is set or
+     * removed, for callers caching something they read from the frame. A
+     * copy has the same number as the frame it was copied from until
+     * either of them changes; a frame which was never changed has 0.
+     */
+    uint64_t get_change_stamp() const noexcept { return m_change_stamp; }
+
     /** The function should be of the form:
      * <anything> func (char const *, KvpValue *, data_type &);
      * Do not pass nullptr as the function.
@@ -228,8 +249,13 @@ struct KvpFrameImpl
 
     private:
     map_type m_valuemap;
+    uint64_t m_change_stamp {};
 
+    map_type::iterator find_slot (const char *) noexcept;
+    map_type::const_iterator find_slot (const char *) const noexcept;
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
+    KvpFrame * get_child_frame_or_nullptr (Path::const_iterator,
+                                           Path::const_iterator) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
     void flatten_kvp_impl(std::vector <std::string>, std::vector <KvpEntry> &) const noexcept;
     KvpValue * set_impl (std::string const &, KvpValue *) noexcept;
@@ -239,14 +265,20 @@ template<typename func_type, typename data_type>
 void KvpFrame::for_each_slot_prefix(std::string const & prefix,
         func_type const & func, data_type & data) const noexcept
 {
-    std::for_each (m_valuemap.begin(), m_valuemap.end(),
-        [&prefix,&func,&data](const KvpFrameImpl::map_type::value_type & a)
+    /* The slots are sorted, so the matching ones are contiguous. */
+    auto start = std::lower_bound (m_valuemap.begin(), m_valuemap.end(),
+                                   prefix.c_str(),
+        [](const KvpFrameImpl::map_type::value_type & a, const char * key)
         {
-            /* Testing for prefix matching */
-            if (strncmp(a.first, prefix.c_str(), prefix.size()) == 0)
-                func (&a.first[prefix.size()], a.second, data);
+            return std::strcmp (a.first, key) < 0;
         }
     );
+    for (auto spot = start; spot != m_valuemap.end(); ++spot)
+    {
+        if (strncmp(spot->first, prefix.c_str(), prefix.size()) != 0)
+            break;
+        func (&spot->first[prefix.size()], spot->second, data);
+    }
 }
 
 template <typename func_type>
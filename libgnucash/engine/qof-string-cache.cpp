@@ -37,46 +37,225 @@ extern "C"
 #include "qof.h"
 }
 
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
 /* Uncomment if you need to log anything.
 static QofLogModule log_module = QOF_MOD_UTIL;
 */
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is split into shards selected by the string's hash, each  */
+/* with its own lock, so that loaders running on several threads       */
+/* rarely contend. A cached string is stored in an arena block right   */
+/* after a small header holding its reference count; the shard's set   */
+/* only holds pointers to the characters.                              */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+namespace
+{
 
-static GHashTable*
-qof_get_string_cache(void)
+struct PoolEntry
 {
-    if (!qof_string_cache)
+    guint refcount;
+    guint32 length;     /* strlen of the string */
+    guint32 alloc_size; /* bytes allocated for header and string */
+    guint32 padding;
+    char* str () noexcept { return reinterpret_cast<char*>(this + 1); }
+    static PoolEntry* from_str (const char* str) noexcept
     {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
+        return reinterpret_cast<PoolEntry*>(const_cast<char*>(str)) - 1;
     }
-    return qof_string_cache;
+};
+
+static_assert (sizeof (PoolEntry) == 16, "PoolEntry must keep strings aligned");
+
+/* A string in the pool, or a string being looked up. */
+struct PoolKey
+{
+    const char* str;
+    std::size_t hash;
+};
+
+struct PoolKeyHash
+{
+    std::size_t operator() (const PoolKey& key) const noexcept { return key.hash; }
+};
+
+struct PoolKeyEqual
+{
+    bool operator() (const PoolKey& a, const PoolKey& b) const noexcept
+    {
+        return a.hash == b.hash && strcmp (a.str, b.str) == 0;
+    }
+};
+
+/* FNV-1a, also used to pick the shard. */
+static std::size_t
+pool_hash (const char* str, guint32& length) noexcept
+{
+    uint64_t hash = 14695981039346656037ULL;
+    const char* p = str;
+    for (; *p; ++p)
+    {
+        hash ^= static_cast<unsigned char>(*p);
+        hash *= 1099511628211ULL;
+    }
+    length = p - str;
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
 }
 
+constexpr std::size_t block_size = 64 * 1024;
+constexpr std::size_t granule = sizeof (PoolEntry);
+/* Longer strings get their own allocation. */
+constexpr std::size_t max_pooled = 1024;
+constexpr unsigned num_shards = 32;
+
+class PoolShard
+{
+public:
+    char* insert (const char* str, const PoolKey& probe, guint32 length)
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        ++m_inserts;
+        auto spot = m_strings.find (probe);
+        if (spot != m_strings.end ())
+        {
+            ++m_hits;
+            ++PoolEntry::from_str (spot->str)->refcount;
+            return const_cast<char*>(spot->str);
+        }
+        auto size = (sizeof (PoolEntry) + length + 1 + granule - 1) & ~(granule - 1);
+        auto entry = allocate (size);
+        entry->refcount = 1;
+        entry->length = length;
+        entry->alloc_size = size;
+        memcpy (entry->str (), str, length + 1);
+        m_strings.insert ({entry->str (), probe.hash});
+        return entry->str ();
+    }
+
+    void remove (const PoolKey& probe)
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        auto spot = m_strings.find (probe);
+        if (spot == m_strings.end ())
+            return;
+        auto entry = PoolEntry::from_str (spot->str);
+        if (--entry->refcount > 0)
+            return;
+        m_strings.erase (spot);
+        release (entry);
+    }
+
+    void clear ()
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        for (auto& key : m_strings)
+        {
+            auto entry = PoolEntry::from_str (key.str);
+            if (entry->alloc_size > max_pooled)
+                g_free (entry);
+        }
+        m_strings.clear ();
+        for (auto block : m_blocks)
+            g_free (block);
+        m_blocks.clear ();
+        m_block_used = block_size;
+        for (auto& list : m_free)
+            list.clear ();
+        m_inserts = m_hits = 0;
+    }
+
+    void add_stats (QofStringCacheStats& stats)
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        stats.unique_strings += m_strings.size ();
+        stats.bytes_allocated += m_blocks.size () * block_size;
+        for (auto& key : m_strings)
+        {
+            auto entry = PoolEntry::from_str (key.str);
+            stats.references += entry->refcount;
+            stats.bytes_saved += (entry->refcount - 1) *
+                static_cast<guint64>(entry->length + 1);
+            if (entry->alloc_size > max_pooled)
+                stats.bytes_allocated += entry->alloc_size;
+        }
+        stats.inserts += m_inserts;
+        stats.hits += m_hits;
+    }
+
+private:
+    PoolEntry* allocate (std::size_t size)
+    {
+        if (size > max_pooled)
+            return static_cast<PoolEntry*>(g_malloc (size));
+        auto& list = m_free[size / granule];
+        if (!list.empty ())
+        {
+            auto entry = list.back ();
+            list.pop_back ();
+            return entry;
+        }
+        if (m_block_used + size > block_size)
+        {
+            m_blocks.push_back (static_cast<char*>(g_malloc (block_size)));
+            m_block_used = 0;
+        }
+        auto entry = reinterpret_cast<PoolEntry*>(m_blocks.back () + m_block_used);
+        m_block_used += size;
+        return entry;
+    }
+
+    void release (PoolEntry* entry)
+    {
+        if (entry->alloc_size > max_pooled)
+            g_free (entry);
+        else
+            m_free[entry->alloc_size / granule].push_back (entry);
+    }
+
+    std::mutex m_mutex;
+    std::unordered_set<PoolKey, PoolKeyHash, PoolKeyEqual> m_strings;
+    std::vector<char*> m_blocks;
+    std::size_t m_block_used = block_size;
+    std::vector<PoolEntry*> m_free[max_pooled / granule + 1];
+    guint64 m_inserts = 0;
+    guint64 m_hits = 0;
+};
+
+/* Never destroyed: strings may be released by other static destructors
+ * at exit. Function-local initialization is thread safe. */
+static PoolShard*
+get_shards ()
+{
+    static auto shards = new PoolShard[num_shards];
+    return shards;
+}
+
+static inline PoolShard&
+shard_for (std::size_t hash)
+{
+    return get_shards ()[(hash >> 7) % num_shards];
+}
+
+} // anonymous namespace
+
 void
 qof_string_cache_init(void)
 {
-    (void)qof_get_string_cache();
+    (void)get_shards();
 }
 
 void
 qof_string_cache_destroy (void)
 {
-    if (qof_string_cache)
-    {
-        g_hash_table_destroy(qof_string_cache);
-    }
-    qof_string_cache = NULL;
+    auto shards = get_shards ();
+    for (unsigned i = 0; i < num_shards; ++i)
+        shards[i].clear ();
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -86,21 +265,9 @@ qof_string_cache_remove(const char * key)
 {
     if (key)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
-        }
+        guint32 length;
+        PoolKey probe {key, pool_hash (key, length)};
+        shard_for (probe.hash).remove (probe);
     }
 }
 
@@ -111,23 +278,9 @@ qof_string_cache_insert(const char * key)
 {
     if (key)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return static_cast <char *> (cache_key);
-        }
-        else
-        {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
-        }
+        guint32 length;
+        PoolKey probe {key, pool_hash (key, length)};
+        return shard_for (probe.hash).insert (key, probe, length);
     }
     return NULL;
 }
@@ -139,4 +292,14 @@ qof_string_cache_replace(char const * dst, char const * src)
     qof_string_cache_remove (dst);
     return tmp;
 }
+
+void
+qof_string_cache_get_stats (QofStringCacheStats *stats)
+{
+    g_return_if_fail (stats);
+    memset (stats, 0, sizeof (*stats));
+    auto shards = get_shards ();
+    for (unsigned i = 0; i < num_shards; ++i)
+        shards[i].add_stats (*stats);
+}
 /* ************************ END OF FILE ***************************** */
@@ -66,7 +66,8 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The string cache is demand-created on first use. Inserting and
+ * removing strings is thread safe; qof_string_cache_destroy is not.
  *
  **/
 
@@ -90,6 +91,22 @@ char * qof_string_cache_insert(const char * key);
  */
 char * qof_string_cache_replace(const char * dst, const char * src);
 
+/** Usage statistics for the string cache. */
+typedef struct
+{
+    guint64 unique_strings;  /**< Distinct strings in the cache */
+    guint64 references;      /**< Live references to those strings */
+    guint64 bytes_allocated; /**< Memory held by the cache */
+    guint64 bytes_saved;     /**< String bytes not duplicated thanks to sharing */
+    guint64 inserts;         /**< Calls to qof_string_cache_insert */
+    guint64 hits;            /**< Inserts which found the string cached */
+} QofStringCacheStats;
+
+/** Fill in stats for the whole cache. The hit rate is hits / inserts;
+ * both counters are reset by qof_string_cache_destroy.
+ */
+void qof_string_cache_get_stats (QofStringCacheStats *stats);
+
 #define CACHE_INSERT(str) qof_string_cache_insert((str))
 #define CACHE_REMOVE(str) qof_string_cache_remove((str))
 
@@ -39,4 +39,9 @@ typedef struct
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
+/* Returns the number of events discarded so far because events were
+ * suspended. Caches maintained from events can compare it to a saved
+ * value to find out whether they missed anything. */
+guint qof_event_get_dropped_count (void);
+
 #endif
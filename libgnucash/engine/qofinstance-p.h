@@ -134,6 +134,21 @@ void qof_instance_set_kvp (QofInstance *, GValue const * value, unsigned count,
  */
 void qof_instance_get_kvp (QofInstance *, GValue * value, unsigned count, ...);
 
+/** Retrieve the string stored in a top-level KVP slot without building a
+ * path or copying it.
+ * @param inst: The QofInstance
+ * @param key: The key of the slot in the instance's top frame.
+ * @return The string, which belongs to the slot, or NULL if the slot is
+ * missing or doesn't hold a string.
+ */
+const char* qof_instance_get_slot_string (const QofInstance *inst, const char *key);
+
+/** Retrieve the integer stored in a top-level KVP slot without building a
+ * path.
+ * @return The integer or 0 if the slot is missing or isn't an integer.
+ */
+gint64 qof_instance_get_slot_int64 (const QofInstance *inst, const char *key);
+
 /** @} Close out the DOxygen ingroup */
 /* Functions to isolate the KVP mechanism inside QOF for cases where
 GValue * operations won't work.
@@ -171,6 +186,9 @@ void qof_instance_slot_path_delete (QofInstance const *, std::vector<std::string
 
 void qof_instance_slot_path_delete_if_empty (QofInstance const *, std::vector<std::string> const &);
 
+/** Get the value in a top-level slot; doesn't allocate. */
+KvpValue* qof_instance_get_slot (QofInstance const *, const char * key);
+
 /** Returns all keys that match the given prefix and their corresponding values.*/
 std::vector <std::pair <std::string, KvpValue*>>
 qof_instance_get_slots_prefix (QofInstance const *, std::string const & prefix);
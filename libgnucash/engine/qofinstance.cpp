@@ -1103,6 +1103,32 @@ qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
     }
 }
 
+KvpValue*
+qof_instance_get_slot (QofInstance const * inst, const char * key)
+{
+    return inst->kvp_data->find_value (key);
+}
+
+const char*
+qof_instance_get_slot_string (const QofInstance *inst, const char *key)
+{
+    g_return_val_if_fail (inst && key, nullptr);
+    auto slot = inst->kvp_data->find_value (key);
+    if (slot == nullptr || slot->get_type () != KvpValue::Type::STRING)
+        return nullptr;
+    return slot->get<const char*> ();
+}
+
+gint64
+qof_instance_get_slot_int64 (const QofInstance *inst, const char *key)
+{
+    g_return_val_if_fail (inst && key, 0);
+    auto slot = inst->kvp_data->find_value (key);
+    if (slot == nullptr || slot->get_type () != KvpValue::Type::INT64)
+        return 0;
+    return slot->get<int64_t> ();
+}
+
 void
 qof_instance_copy_kvp (QofInstance *to, const QofInstance *from)
 {
@@ -34,6 +34,22 @@ extern "C"
 {
 #endif
 
+/* An access path lets the module implementing an object type narrow
+ * the set of objects a query has to check, typically by consulting an
+ * index. It returns FALSE if it can't help with the query, in which
+ * case every object in the book is checked as usual. If it returns
+ * TRUE, *candidates must hold a superset of the objects in book which
+ * match the query; the query still checks each of them. The query
+ * frees the list but not the objects.
+ */
+typedef gboolean (*QofQueryAccessPath) (QofQuery *q, QofBook *book,
+                                        GList **candidates);
+
+/* Register path for queries searching for obj_type, replacing any
+ * previous one. Pass a NULL path to unregister. */
+void qof_query_register_access_path (QofIdTypeConst obj_type,
+                                     QofQueryAccessPath path);
+
 /* Functions to get Query information */
 int qof_query_get_max_results (const QofQuery *q);
 
@@ -113,6 +113,9 @@ typedef struct _QofQueryCB
     gint              count;
 } QofQueryCB;
 
+/* Access paths registered by object modules, keyed by QofIdType */
+static GHashTable *accessPathTable = NULL;
+
 /* initial_term will be owned by the new Query */
 static void query_init (QofQuery *q, QofQueryTerm *initial_term)
 {
@@ -839,9 +842,27 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        /* And then iterate over all the objects, or only over the
+         * candidates an access path proposes if there is one */
+        {
+            GList *candidates = NULL;
+            QofQueryAccessPath path = NULL;
+
+            if (accessPathTable)
+                path = reinterpret_cast<QofQueryAccessPath>(
+                    g_hash_table_lookup (accessPathTable,
+                                         qcb->query->search_for));
+            if (path && path (qcb->query, book, &candidates))
+            {
+                PINFO ("access path proposed %u candidates",
+                       g_list_length (candidates));
+                g_list_foreach (candidates, check_item_cb, qcb);
+                g_list_free (candidates);
+            }
+            else
+                qof_object_foreach (qcb->query->search_for, book,
+                                    (QofInstanceForeachCB) check_item_cb, qcb);
+        }
     }
 }
 
@@ -1349,10 +1370,30 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    if (accessPathTable)
+    {
+        g_hash_table_destroy (accessPathTable);
+        accessPathTable = NULL;
+    }
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+void qof_query_register_access_path (QofIdTypeConst obj_type,
+                                     QofQueryAccessPath path)
+{
+    g_return_if_fail (obj_type);
+
+    if (!accessPathTable)
+        accessPathTable = g_hash_table_new (g_str_hash, g_str_equal);
+
+    if (path)
+        g_hash_table_insert (accessPathTable, (gpointer)obj_type,
+                             reinterpret_cast<void*>(path));
+    else
+        g_hash_table_remove (accessPathTable, obj_type);
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
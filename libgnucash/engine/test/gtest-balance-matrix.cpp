@@ -0,0 +1,213 @@
+/********************************************************************
+ * gtest-balance-matrix.cpp: Test balances of accounts at dates.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../Split.h"
+#include "../gnc-pricedb.h"
+#include "../cashobjects.h"
+}
+
+#include "../gnc-balance-matrix.hpp"
+#include <gtest/gtest.h>
+
+static const time64 day = 86400;
+static const time64 start = 1500000000;
+
+class BalanceMatrixTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        m_book = qof_book_new();
+        m_usd = gnc_commodity_new (m_book, "US Dollar", "CURRENCY", "USD",
+                                   "0", 100);
+        m_eur = gnc_commodity_new (m_book, "Euro", "CURRENCY", "EUR",
+                                   "0", 100);
+        m_root = gnc_account_create_root (m_book);
+        m_assets = make_account (m_root, "Assets", m_usd);
+        m_bank = make_account (m_assets, "Bank", m_usd);
+        m_euro_bank = make_account (m_assets, "Euro Bank", m_eur);
+        m_income = make_account (m_root, "Income", m_usd);
+        m_equity = make_account (m_root, "Equity", m_usd);
+    }
+    void TearDown() {
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        qof_book_destroy (m_book);
+        qof_close();
+    }
+    Account* make_account (Account* parent, const char* name,
+                           gnc_commodity* commodity) {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, ACCT_TYPE_BANK);
+        xaccAccountSetCommodity (acc, commodity);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (parent, acc);
+        return acc;
+    }
+    void add_split (Transaction* trans, Account* acc, gint64 amount,
+                    gint64 value) {
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+        xaccSplitSetValue (split, gnc_numeric_create (value, 1));
+    }
+    /* Set closing before the commit so the accounts' balances that
+     * leave out closing transactions are recomputed. */
+    void transfer (time64 date, Account* from, Account* to, gint64 amount,
+                   gint64 to_amount, bool closing = false) {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecs (trans, date);
+        xaccTransSetIsClosingTxn (trans, closing);
+        add_split (trans, from, -amount, -amount);
+        add_split (trans, to, to_amount, amount);
+        xaccTransCommitEdit (trans);
+    }
+    void add_price (time64 date, gint64 usd_per_eur) {
+        auto price = gnc_price_create (m_book);
+        gnc_price_begin_edit (price);
+        gnc_price_set_commodity (price, m_eur);
+        gnc_price_set_currency (price, m_usd);
+        gnc_price_set_time64 (price, date);
+        gnc_price_set_value (price, gnc_numeric_create (usd_per_eur, 1));
+        gnc_price_commit_edit (price);
+        gnc_pricedb_add_price (gnc_pricedb_get_db (m_book), price);
+        gnc_price_unref (price);
+    }
+    QofBook* m_book;
+    gnc_commodity* m_usd;
+    gnc_commodity* m_eur;
+    Account* m_root;
+    Account* m_assets;
+    Account* m_bank;
+    Account* m_euro_bank;
+    Account* m_income;
+    Account* m_equity;
+};
+
+TEST_F(BalanceMatrixTest, own_balances)
+{
+    transfer (start + day, m_income, m_bank, 100, 100);
+    transfer (start + 3 * day, m_income, m_bank, 50, 50);
+    transfer (start + 3 * day, m_bank, m_equity, 30, 30, true);
+
+    std::vector<time64> dates {start, start + day, start + 2 * day,
+                               start + 3 * day, start + 4 * day};
+    auto matrix = gnc_account_balances_at_dates ({m_bank, m_income}, dates,
+                                                 GncBalanceFlags (0), nullptr);
+    ASSERT_EQ (2u, matrix.size());
+    ASSERT_EQ (dates.size(), matrix[0].size());
+    const gint64 bank[] {0, 100, 100, 120, 120};
+    for (size_t i = 0; i < dates.size(); ++i)
+    {
+        EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (bank[i], 1),
+                                        matrix[0][i]));
+        /* The engine leaves out the splits at the date itself. */
+        EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate
+                                        (m_income, dates[i] + 1),
+                                        matrix[1][i]));
+    }
+
+    matrix = gnc_account_balances_at_dates ({m_bank}, dates,
+                                            GNC_BALANCE_NOCLOSING, nullptr);
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (150, 1),
+                                    matrix[0][4]));
+
+    EXPECT_TRUE (gnc_account_balances_at_dates ({m_bank}, {start + day, start},
+                                                GncBalanceFlags (0),
+                                                nullptr).empty());
+}
+
+TEST_F(BalanceMatrixTest, recursive_and_converted)
+{
+    add_price (start, 2);
+    transfer (start + day, m_income, m_bank, 100, 100);
+    transfer (start + 2 * day, m_income, m_euro_bank, 60, 30);
+    add_price (start + 2 * day, 3);
+
+    std::vector<time64> dates {start, start + day, start + 2 * day};
+    auto matrix = gnc_account_balances_at_dates ({m_assets, m_euro_bank},
+                                                 dates, GNC_BALANCE_RECURSE,
+                                                 nullptr);
+    ASSERT_EQ (2u, matrix.size());
+    for (size_t i = 0; i < dates.size(); ++i)
+    {
+        EXPECT_TRUE (gnc_numeric_equal (xaccAccountGetBalanceAsOfDateInCurrency
+                                        (m_assets, dates[i] + 1, nullptr,
+                                         TRUE),
+                                        matrix[0][i]));
+    }
+    /* The latest price converts 30 EUR to 90 USD. */
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (190, 1),
+                                    matrix[0][2]));
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (30, 1),
+                                    matrix[1][2]));
+
+    matrix = gnc_account_balances_at_dates ({m_euro_bank}, dates,
+                                            GNC_BALANCE_NEAREST_PRICE, m_usd);
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (90, 1),
+                                    matrix[0][2]));
+
+    /* The C interface returns the same balances row by row. */
+    auto accounts = g_list_append (nullptr, m_assets);
+    auto balances = gnc_account_list_get_balances_at_dates
+        (accounts, dates.data(), dates.size(), GNC_BALANCE_RECURSE, nullptr);
+    ASSERT_NE (nullptr, balances);
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (100, 1),
+                                    balances[1]));
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (190, 1),
+                                    balances[2]));
+    g_free (balances);
+    g_list_free (accounts);
+}
+
+TEST_F(BalanceMatrixTest, many_dates)
+{
+    xaccAccountBeginEdit (m_bank);
+    xaccAccountBeginEdit (m_income);
+    for (int i = 0; i < 1000; ++i)
+        transfer (start + i * day, m_income, m_bank, 1, 1);
+    xaccAccountCommitEdit (m_income);
+    xaccAccountCommitEdit (m_bank);
+
+    std::vector<time64> dates;
+    for (int i = 0; i < 1000; i += 7)
+        dates.push_back (start + i * day);
+    auto matrix = gnc_account_balances_at_dates ({m_bank, m_assets}, dates,
+                                                 GNC_BALANCE_RECURSE, nullptr);
+    for (size_t i = 0; i < dates.size(); ++i)
+    {
+        auto expected = gnc_numeric_create (i * 7 + 1, 1);
+        EXPECT_TRUE (gnc_numeric_equal (expected, matrix[0][i]));
+        EXPECT_TRUE (gnc_numeric_equal (expected, matrix[1][i]));
+    }
+}
@@ -479,3 +479,199 @@ TEST(gnc_datetime_functions, test_timezone_offset)
     EXPECT_EQ(-25200, gncdt3.offset());
 }
 */
+
+static void
+expect_same_tm(const struct tm& expected, const struct tm& actual, time64 time)
+{
+    EXPECT_EQ(expected.tm_year, actual.tm_year) << "at " << time;
+    EXPECT_EQ(expected.tm_mon, actual.tm_mon) << "at " << time;
+    EXPECT_EQ(expected.tm_mday, actual.tm_mday) << "at " << time;
+    EXPECT_EQ(expected.tm_hour, actual.tm_hour) << "at " << time;
+    EXPECT_EQ(expected.tm_min, actual.tm_min) << "at " << time;
+    EXPECT_EQ(expected.tm_sec, actual.tm_sec) << "at " << time;
+    EXPECT_EQ(expected.tm_wday, actual.tm_wday) << "at " << time;
+    EXPECT_EQ(expected.tm_yday, actual.tm_yday) << "at " << time;
+    EXPECT_EQ(expected.tm_isdst, actual.tm_isdst) << "at " << time;
+#if HAVE_STRUCT_TM_GMTOFF
+    EXPECT_EQ(expected.tm_gmtoff, actual.tm_gmtoff) << "at " << time;
+#endif
+}
+
+/* GncLocalTime must agree with GncDateTime everywhere, including the
+ * hours around each transition and the first and last years. */
+static void
+check_local_time(time64 start, time64 end, time64 step)
+{
+    for (auto time = start; time < end; time += step)
+    {
+        struct tm expected = static_cast<struct tm>(GncDateTime(time));
+        struct tm actual;
+        ASSERT_TRUE(GncLocalTime::to_tm(time, actual));
+        expect_same_tm(expected, actual, time);
+        if (::testing::Test::HasFailure())
+            return;
+
+        /* Every local time, plus the ones in gaps: */
+        for (auto hour : {0, 1, 2, 3})
+        {
+            struct tm tm = expected;
+            tm.tm_hour = hour;
+            tm.tm_isdst = -1;
+            struct tm ref_tm = tm;
+            time64 ref_time = 0, local_time = 0;
+            bool ref_ok = true;
+            try
+            {
+                GncDateTime gncdt(ref_tm);
+                ref_tm = static_cast<struct tm>(gncdt);
+                ref_time = static_cast<time64>(gncdt);
+            }
+            catch(const std::invalid_argument&)
+            {
+                ref_ok = false;
+            }
+            ASSERT_EQ(ref_ok, GncLocalTime::from_tm(tm, local_time)) << "at " << time;
+            if (!ref_ok)
+                continue;
+            EXPECT_EQ(ref_time, local_time) << "at " << time;
+            expect_same_tm(ref_tm, tm, time);
+            if (::testing::Test::HasFailure())
+                return;
+        }
+    }
+}
+
+#include <chrono>
+#include <iostream>
+
+TEST(gnc_local_time, matches_gnc_datetime)
+{
+    static const char* zones[] =
+#ifdef __MINGW32__
+        {"GMT Standard Time", "Pacific Standard Time",
+         "W. Australia Standard Time", "AUS Eastern Standard Time"};
+#else
+        {"Europe/London", "America/Los_Angeles", "Australia/Perth",
+         "Australia/Sydney"};
+#endif
+    for (auto zone : zones)
+    {
+        SCOPED_TRACE(zone);
+        TimeZoneProvider tzp(zone);
+        _set_tzp(tzp);
+        // 1960 to 2040 every few hours, and more closely through 2017.
+        check_local_time(-315619200, 2208988800, 21601);
+        check_local_time(1483228800, 1514764800, 997);
+        // Around the ends of the supported range.
+        check_local_time(-17987443200 + 86400, -17987443200 + 400 * 86400, 3600);
+        check_local_time(253402300800 - 400 * 86400, 253402300800 - 86400, 3600);
+        _reset_tzp();
+    }
+}
+
+TEST(gnc_local_time, DISABLED_benchmark)
+{
+    using Clock = std::chrono::steady_clock;
+    const time64 start = 946684800, step = 4327;
+    const int count = 200000;
+#ifdef __MINGW32__
+    TimeZoneProvider tzp{"GMT Standard Time"};
+#else
+    TimeZoneProvider tzp("Europe/London");
+#endif
+    _set_tzp(tzp);
+    struct tm tm;
+    time64 sum = 0;
+    auto time_it = [&](const char* what, bool fast) {
+        auto begin = Clock::now();
+        for (int i = 0; i < count; ++i)
+        {
+            auto time = start + i * step;
+            if (fast)
+                GncLocalTime::to_tm(time, tm);
+            else
+                tm = static_cast<struct tm>(GncDateTime(time));
+            tm.tm_isdst = -1;
+            time64 back;
+            if (fast)
+                GncLocalTime::from_tm(tm, back);
+            else
+                back = static_cast<time64>(GncDateTime(tm));
+            sum += back;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - begin).count();
+        std::cout << what << ": " << elapsed / count << " ns per round trip"
+                  << std::endl;
+    };
+    time_it("GncDateTime", false);
+    time_it("GncLocalTime", true);
+    _reset_tzp();
+    EXPECT_NE(0, sum);
+}
+
+static_assert(GncDayNum(1970, 1, 1).days() == 0, "epoch");
+static_assert(GncDayNum(2000, 3, 1).days() == 11017, "after a leap day");
+static_assert(GncDayNum(1969, 12, 31).weekday() == 3, "Wednesday");
+static_assert(GncDayNum(2016, 2, 29).add_months(12) == GncDayNum(2017, 2, 28),
+              "clamped to the end of February");
+static_assert(GncDayNum(2017, 8, 15).end_of_quarter() == GncDayNum(2017, 9, 30),
+              "quarter end");
+
+TEST(gnc_day_num, matches_gnc_date)
+{
+    // Every day from 1401 to 9998, checked against boost's calendar.
+    for (auto days = GncDayNum(1401, 1, 1).days();
+         days < GncDayNum(9999, 1, 1).days(); ++days)
+    {
+        GncDayNum day(days);
+        auto date = day.year_month_day();
+        GncDate gncd(date.year, date.month, date.day);
+        auto check = gncd.year_month_day();
+        ASSERT_EQ(check.year, date.year) << "at " << days;
+        ASSERT_EQ(check.month, date.month) << "at " << days;
+        ASSERT_EQ(check.day, date.day) << "at " << days;
+        ASSERT_EQ(days, GncDayNum(date.year, date.month, date.day).days());
+        if (date.day == 1)
+            ASSERT_EQ(days - 1, GncDayNum(days - 1).end_of_month().days());
+    }
+}
+
+TEST(gnc_day_num, time64)
+{
+    TimeZoneProvider tzp("Australia/Sydney");
+    _set_tzp(tzp);
+    GncDayNum day(2017, 12, 31);
+    for (auto part : {DayPart::start, DayPart::neutral, DayPart::end})
+        EXPECT_EQ(day, GncDayNum(day.to_time64(part)));
+    // 2017-12-31 13:00 UTC is New Year's Day in Sydney.
+    EXPECT_EQ(day + 1, GncDayNum(static_cast<time64>(1514725200)));
+    _reset_tzp();
+    EXPECT_THROW(GncDayNum(MAXTIME + 86400 * 2), std::invalid_argument);
+}
+
+TEST(gnc_day_num, periods)
+{
+    GncDayNum day(2018, 2, 14);
+    EXPECT_EQ(GncDayNum(2018, 2, 1), day.start_of_month());
+    EXPECT_EQ(GncDayNum(2018, 2, 28), day.end_of_month());
+    EXPECT_EQ(GncDayNum(2018, 1, 1), day.start_of_quarter());
+    EXPECT_EQ(GncDayNum(2018, 3, 31), day.end_of_quarter());
+    EXPECT_EQ(GncDayNum(2018, 1, 1), day.start_of_year());
+    EXPECT_EQ(GncDayNum(2018, 12, 31), day.end_of_year());
+    EXPECT_EQ(44u, day.day_of_year());
+    EXPECT_EQ(3u, day.weekday());
+    EXPECT_EQ(GncDayNum(2017, 11, 14), day.add_months(-3));
+    EXPECT_EQ(GncDayNum(2019, 3, 14), day.add_months(13));
+    // Fiscal years ending 30 June and the last day of February.
+    EXPECT_EQ(GncDayNum(2017, 7, 1), day.start_of_fiscal_year(6, 30));
+    EXPECT_EQ(GncDayNum(2018, 6, 30), day.end_of_fiscal_year(6, 30));
+    EXPECT_EQ(GncDayNum(2018, 7, 1),
+              GncDayNum(2018, 7, 1).start_of_fiscal_year(6, 30));
+    EXPECT_EQ(GncDayNum(2018, 3, 1),
+              GncDayNum(2018, 3, 1).start_of_fiscal_year(2, 29));
+    EXPECT_EQ(GncDayNum(2020, 2, 29),
+              GncDayNum(2019, 3, 1).end_of_fiscal_year(2, 29));
+    EXPECT_EQ(GncDayNum(2017, 3, 1), day.start_of_fiscal_year(2, 29));
+    EXPECT_EQ(-1, GncDayNum(1969, 12, 31).days());
+}
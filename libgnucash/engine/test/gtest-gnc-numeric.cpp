@@ -21,6 +21,9 @@
 \********************************************************************/
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
 #include "../gnc-numeric.hpp"
 #include "../gnc-rational.hpp"
 
@@ -338,6 +341,73 @@ TEST(gncnumeric_operators, test_subtraction)
     EXPECT_EQ(12, c.denom());
 }
 
+TEST(gncnumeric_operators, test_same_denom)
+{
+    GncNumeric a(150, 100), b(-75, 100);
+    auto c = a + b;
+    EXPECT_EQ(75, c.num());
+    EXPECT_EQ(100, c.denom());
+    c = a - b;
+    EXPECT_EQ(225, c.num());
+    EXPECT_EQ(100, c.denom());
+
+    gnc_numeric x{150, 100}, y{-75, 100};
+    auto z = gnc_numeric_add_fixed(x, y);
+    EXPECT_EQ(75, z.num);
+    EXPECT_EQ(100, z.denom);
+    z = gnc_numeric_sub_fixed(x, y);
+    EXPECT_EQ(225, z.num);
+    EXPECT_EQ(100, z.denom);
+    z = gnc_numeric_add(x, y, 100, GNC_HOW_DENOM_FIXED | GNC_HOW_RND_ROUND);
+    EXPECT_EQ(75, z.num);
+    EXPECT_EQ(100, z.denom);
+    /* Exact arithmetic reports a zero sum as 0/1. */
+    z = gnc_numeric_sub(x, x, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    EXPECT_EQ(0, z.num);
+    EXPECT_EQ(1, z.denom);
+
+    /* Sums which don't fit in 64 bits take the general path, which rounds
+     * them instead of letting them wrap. */
+    gnc_numeric big{INT64_MAX - 1, 100}, one{3, 100};
+    z = gnc_numeric_add_fixed(big, one);
+    EXPECT_EQ(4611686018427387904, z.num);
+    EXPECT_EQ(50, z.denom);
+    gnc_numeric small{INT64_MIN + 2, 100};
+    z = gnc_numeric_sub_fixed(small, one);
+    EXPECT_EQ(-4611686018427387904, z.num);
+    EXPECT_EQ(50, z.denom);
+}
+
+/* Compares summing same-denominator values through the fast path with the
+ * general rational arithmetic. Not run by default; use
+ * --gtest_also_run_disabled_tests. */
+TEST(gncnumeric_benchmark, DISABLED_same_denom_sum)
+{
+    const int count = 1000000;
+    std::vector<gnc_numeric> amounts;
+    for (int i = 0; i < count; ++i)
+        amounts.push_back({i % 100000 - 50000, 100});
+
+    auto start = std::chrono::steady_clock::now();
+    gnc_numeric fast = gnc_numeric_zero();
+    fast.denom = 100;
+    for (auto amount : amounts)
+        fast = gnc_numeric_add_fixed(fast, amount);
+    auto mid = std::chrono::steady_clock::now();
+    /* Exact arithmetic doesn't take the fast path. */
+    gnc_numeric slow = fast;
+    slow.num = 0;
+    for (auto amount : amounts)
+        slow = gnc_numeric_add(slow, amount, 100, GNC_HOW_DENOM_EXACT);
+    auto end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(fast.num, slow.num);
+    using ns = std::chrono::duration<double, std::nano>;
+    std::cout << "Same denominator sum: "
+              << ns(mid - start).count() / count << " ns/add fast path, "
+              << ns(end - mid).count() / count << " ns/add general path\n";
+}
+
 TEST(gncnumeric_operators, test_multiplication)
 {
     GncNumeric a(123456789987654321, 1000000000);
@@ -0,0 +1,210 @@
+/********************************************************************
+ * gtest-gnc-text-index.cpp: Test the transaction text index.       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Query.h"
+#include "../Transaction.h"
+#include "../Split.h"
+#include "../cashobjects.h"
+#include "../gnc-text-index.h"
+}
+
+#include "../gnc-text-index.hpp"
+#include <gtest/gtest.h>
+
+static const int doc1 = 1, doc2 = 2, doc3 = 3;
+
+TEST(GncTextIndex, tokenize)
+{
+    auto words = GncTextIndex::tokenize ("  Grocery-Store, MÜNCHEN 42");
+    ASSERT_EQ (4u, words.size());
+    EXPECT_EQ ("grocery", words[0].text);
+    EXPECT_FALSE (words[0].open_left);
+    EXPECT_FALSE (words[0].open_right);
+    EXPECT_EQ ("42", words[3].text);
+    EXPECT_TRUE (words[3].open_right);
+    EXPECT_TRUE (GncTextIndex::tokenize ("").empty());
+    EXPECT_TRUE (GncTextIndex::tokenize (nullptr).empty());
+    EXPECT_TRUE (GncTextIndex::tokenize (" - ").empty());
+}
+
+TEST(GncTextIndex, substring_candidates)
+{
+    GncTextIndex index;
+    index.set (&doc1, "Weekly grocery shopping");
+    index.set (&doc2, "Groceries for the party");
+    index.set (&doc3, "Rent");
+    EXPECT_EQ (3u, index.num_docs());
+
+    GncTextIndex::Postings result;
+    ASSERT_TRUE (index.substring_candidates ("grocer", result));
+    ASSERT_EQ (2u, result.size());
+    ASSERT_TRUE (index.substring_candidates ("ocer", result));
+    EXPECT_EQ (2u, result.size());
+    ASSERT_TRUE (index.substring_candidates ("grocery shop", result));
+    ASSERT_EQ (1u, result.size());
+    EXPECT_EQ (&doc1, index.doc (result[0]));
+    ASSERT_TRUE (index.substring_candidates ("ly grocery ", result));
+    EXPECT_EQ (1u, result.size());
+    ASSERT_TRUE (index.substring_candidates ("groceryx", result));
+    EXPECT_TRUE (result.empty());
+    EXPECT_FALSE (index.substring_candidates (" ", result));
+}
+
+TEST(GncTextIndex, set_and_remove)
+{
+    GncTextIndex index;
+    index.set (&doc1, "Rent");
+    index.set (&doc1, "Mortgage");
+    GncTextIndex::Postings result;
+    ASSERT_TRUE (index.substring_candidates ("rent", result));
+    EXPECT_TRUE (result.empty());
+    EXPECT_EQ (1u, index.prefix_match ("mort").size());
+    index.remove (&doc1);
+    EXPECT_EQ (0u, index.num_docs());
+    EXPECT_EQ (0u, index.num_words());
+    index.set (&doc2, "Rent");
+    EXPECT_EQ (1u, index.prefix_match ("RE").size());
+}
+
+class TextIndexBookTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        gnc_text_index_set_enabled (TRUE);
+        m_book = qof_book_new();
+        m_currency = gnc_commodity_new (m_book, "US Dollar", "CURRENCY",
+                                        "USD", "0", 100);
+        auto root = gnc_account_create_root (m_book);
+        m_account = xaccMallocAccount (m_book);
+        gnc_account_append_child (root, m_account);
+        m_trans1 = make_trans ("Weekly grocery shopping", "Market");
+        m_trans2 = make_trans ("Rent", "March");
+    }
+    void TearDown() {
+        gnc_text_index_set_enabled (FALSE);
+        qof_book_destroy (m_book);
+        qof_close();
+    }
+    Transaction* make_trans (const char* desc, const char* memo) {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_currency);
+        xaccTransSetDescription (trans, desc);
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, m_account);
+        xaccSplitSetMemo (split, memo);
+        xaccTransCommitEdit (trans);
+        return trans;
+    }
+    QofBook* m_book;
+    gnc_commodity* m_currency;
+    Account* m_account;
+    Transaction* m_trans1;
+    Transaction* m_trans2;
+};
+
+TEST_F(TextIndexBookTest, find)
+{
+    auto list = gnc_text_index_find_transactions (m_book, "groc week");
+    ASSERT_EQ (1u, g_list_length (list));
+    EXPECT_EQ (m_trans1, list->data);
+    g_list_free (list);
+
+    list = gnc_text_index_find_splits (m_book, "rent mar");
+    ASSERT_EQ (1u, g_list_length (list));
+    EXPECT_EQ (m_trans2, xaccSplitGetParent (GNC_SPLIT (list->data)));
+    g_list_free (list);
+
+    /* Kept up to date on commit */
+    xaccTransBeginEdit (m_trans2);
+    xaccTransSetDescription (m_trans2, "Mortgage");
+    xaccTransCommitEdit (m_trans2);
+    list = gnc_text_index_find_transactions (m_book, "rent");
+    EXPECT_EQ (nullptr, list);
+    list = gnc_text_index_find_transactions (m_book, "mortgage");
+    EXPECT_EQ (1u, g_list_length (list));
+    g_list_free (list);
+}
+
+TEST_F(TextIndexBookTest, query)
+{
+    auto q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, m_book);
+    xaccQueryAddDescriptionMatch (q, "Grocery", FALSE, FALSE,
+                                  QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    auto list = qof_query_run (q);
+    ASSERT_EQ (1u, g_list_length (list));
+    EXPECT_EQ (m_trans1, xaccSplitGetParent (GNC_SPLIT (list->data)));
+    qof_query_destroy (q);
+
+    /* Case sensitive matches scan the book. */
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, m_book);
+    xaccQueryAddDescriptionMatch (q, "Grocery", TRUE, FALSE,
+                                  QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    EXPECT_EQ (nullptr, qof_query_run (q));
+    qof_query_destroy (q);
+
+    /* Events missed while suspended force a rebuild. */
+    qof_event_suspend ();
+    make_trans ("Another grocery run", "");
+    qof_event_resume ();
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, m_book);
+    xaccQueryAddDescriptionMatch (q, "grocery", FALSE, FALSE,
+                                  QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    EXPECT_EQ (2u, g_list_length (qof_query_run (q)));
+    qof_query_destroy (q);
+}
+
+TEST_F(TextIndexBookTest, query_unicode)
+{
+    /* Normalizing puts the dot below before the acute and replaces
+     * the ligature, so folded terms can't find these byte-wise. */
+    auto accent = make_trans ("Cafe\u0301\u0323 bill", "");
+    auto ligature = make_trans ("\uFB01ling fee", "");
+    auto count = [this](const char* text, gboolean case_sensitive) {
+        auto q = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (q, m_book);
+        xaccQueryAddDescriptionMatch (q, text, case_sensitive, FALSE,
+                                      QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+        auto list = qof_query_run (q);
+        auto result = g_list_length (list);
+        if (result == 1)
+            EXPECT_TRUE (xaccSplitGetParent (GNC_SPLIT (list->data)) == accent ||
+                         xaccSplitGetParent (GNC_SPLIT (list->data)) == ligature);
+        qof_query_destroy (q);
+        return result;
+    };
+    EXPECT_EQ (1u, count ("e\u0301", TRUE));
+    EXPECT_EQ (1u, count ("\uFB01ling", TRUE));
+    EXPECT_EQ (0u, count ("filing", TRUE));
+    EXPECT_EQ (1u, count ("FILING", FALSE));
+    EXPECT_EQ (1u, count ("CAFE\u0323\u0301", FALSE));
+}
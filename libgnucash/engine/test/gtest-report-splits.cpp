@@ -0,0 +1,216 @@
+/********************************************************************
+ * gtest-report-splits.cpp: Test filtering, sorting and grouping    *
+ * report splits.                                                   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../Split.h"
+#include "../gnc-date.h"
+#include "../cashobjects.h"
+}
+
+#include "../gnc-report-splits.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+class ReportSplitsTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        m_book = qof_book_new();
+        m_usd = gnc_commodity_new (m_book, "US Dollar", "CURRENCY", "USD",
+                                   "0", 100);
+        m_root = gnc_account_create_root (m_book);
+        m_bank = make_account ("Bank");
+        m_food = make_account ("Food");
+        m_fuel = make_account ("Fuel");
+        m_splits = nullptr;
+    }
+    void TearDown() {
+        g_list_free (m_splits);
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        qof_book_destroy (m_book);
+        qof_close();
+    }
+    Account* make_account (const char* name) {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, ACCT_TYPE_BANK);
+        xaccAccountSetCommodity (acc, m_usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (m_root, acc);
+        return acc;
+    }
+    Split* add_split (Transaction* trans, Account* acc, gint64 amount,
+                      const char* memo) {
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetMemo (split, memo);
+        xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+        xaccSplitSetValue (split, gnc_numeric_create (amount, 1));
+        return split;
+    }
+    /* Adds the bank's split of a payment to the splits to report. */
+    Split* payment (int mday, int month, const char* desc, Account* to,
+                    gint64 amount, const char* memo = "") {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (trans,
+                                              gnc_dmy2time64 (mday, month, 2018));
+        xaccTransSetDescription (trans, desc);
+        auto split = add_split (trans, m_bank, -amount, memo);
+        add_split (trans, to, amount, "");
+        xaccTransCommitEdit (trans);
+        m_splits = g_list_append (m_splits, split);
+        return split;
+    }
+    std::string descriptions (const GncReportSplits& rows) {
+        std::string result;
+        for (auto split : rows.splits)
+            result.append (result.empty() ? "" : ",").append
+                (xaccTransGetDescription (xaccSplitGetParent (split)));
+        return result;
+    }
+    QofBook* m_book;
+    gnc_commodity* m_usd;
+    Account* m_root;
+    Account* m_bank;
+    Account* m_food;
+    Account* m_fuel;
+    GList* m_splits;
+};
+
+static const GncReportSortLevel no_sort {GNC_REPORT_KEY_NONE,
+                                         GNC_REPORT_DATE_NONE, TRUE};
+
+static gboolean
+larger_than (Split* split, gpointer data)
+{
+    auto amount = gnc_numeric_neg (xaccSplitGetAmount (split));
+    return gnc_numeric_compare (amount, *static_cast<gnc_numeric*>(data)) > 0;
+}
+
+TEST_F(ReportSplitsTest, filter)
+{
+    payment (1, 1, "Bread", m_food, 5, "bakery");
+    payment (2, 1, "Petrol", m_fuel, 40);
+    payment (3, 1, "Milk", m_food, 2);
+    payment (4, 1, "Diesel", m_fuel, 60, "bread van");
+
+    GList accounts {m_food, nullptr, nullptr};
+    GncReportSplitFilter filter {&accounts, GNC_REPORT_ACCOUNTS_INCLUDE,
+                                 nullptr, FALSE, nullptr, nullptr};
+    GncReportSplits include {m_splits, &filter, no_sort, no_sort, true};
+    EXPECT_EQ ("Bread,Milk", descriptions (include));
+
+    filter.account_filter = GNC_REPORT_ACCOUNTS_EXCLUDE;
+    GncReportSplits exclude {m_splits, &filter, no_sort, no_sort, true};
+    EXPECT_EQ ("Petrol,Diesel", descriptions (exclude));
+
+    filter.account_filter = GNC_REPORT_ACCOUNTS_ANY;
+    filter.matcher = "read";
+    GncReportSplits matched {m_splits, &filter, no_sort, no_sort, true};
+    EXPECT_EQ ("Bread,Diesel", descriptions (matched));
+
+    filter.matcher_exclude = TRUE;
+    GncReportSplits unmatched {m_splits, &filter, no_sort, no_sort, true};
+    EXPECT_EQ ("Petrol,Milk", descriptions (unmatched));
+
+    auto limit = gnc_numeric_create (10, 1);
+    filter.matcher = "";
+    filter.func = larger_than;
+    filter.user_data = &limit;
+    GncReportSplits large {m_splits, &filter, no_sort, no_sort, true};
+    EXPECT_EQ ("Petrol,Diesel", descriptions (large));
+    EXPECT_EQ (-1, large.groups[0][0]);
+}
+
+TEST_F(ReportSplitsTest, sort_and_group)
+{
+    payment (5, 1, "Bread", m_food, 5);
+    payment (2, 1, "Petrol", m_fuel, 40);
+    payment (3, 2, "Milk", m_food, 2);
+    payment (1, 2, "Diesel", m_fuel, 60);
+    payment (4, 1, "Cheese", m_food, 8);
+
+    /* Splits with the same other account keep their order. */
+    GncReportSortLevel by_account {GNC_REPORT_KEY_CORR_ACCOUNT_NAME,
+                                   GNC_REPORT_DATE_NONE, FALSE};
+    GncReportSplits accounts {m_splits, nullptr, by_account, no_sort, true};
+    EXPECT_EQ ("Petrol,Diesel,Bread,Milk,Cheese", descriptions (accounts));
+    EXPECT_EQ (accounts.groups[0][0], accounts.groups[0][1]);
+    EXPECT_NE (accounts.groups[0][1], accounts.groups[0][2]);
+    EXPECT_EQ (accounts.groups[0][2], accounts.groups[0][4]);
+
+    GncReportSortLevel by_month {GNC_REPORT_KEY_DATE, GNC_REPORT_DATE_MONTH,
+                                 TRUE};
+    GncReportSortLevel by_amount {GNC_REPORT_KEY_AMOUNT, GNC_REPORT_DATE_NONE,
+                                  TRUE};
+    GncReportSplits months {m_splits, nullptr, by_month, by_amount, true};
+    EXPECT_EQ ("Petrol,Cheese,Bread,Diesel,Milk", descriptions (months));
+    EXPECT_EQ (months.groups[0][0], months.groups[0][2]);
+    EXPECT_NE (months.groups[0][2], months.groups[0][3]);
+    EXPECT_EQ (months.groups[0][3], months.groups[0][4]);
+    EXPECT_NE (months.groups[1][0], months.groups[1][1]);
+
+    /* Without a date group the date doesn't sort. */
+    by_month.date_group = GNC_REPORT_DATE_NONE;
+    GncReportSplits dates {m_splits, nullptr, by_month, no_sort, true};
+    EXPECT_EQ ("Bread,Petrol,Milk,Diesel,Cheese", descriptions (dates));
+    EXPECT_EQ (-1, dates.groups[0][0]);
+
+    /* Splits already in order are only grouped. */
+    by_month.date_group = GNC_REPORT_DATE_YEAR;
+    GncReportSplits years {m_splits, nullptr, by_amount, by_month, false};
+    EXPECT_EQ ("Bread,Petrol,Milk,Diesel,Cheese", descriptions (years));
+    for (auto group : years.groups[1])
+        EXPECT_EQ (years.groups[1][0], group);
+}
+
+TEST_F(ReportSplitsTest, c_api)
+{
+    auto bread = payment (5, 1, "Bread", m_food, 5);
+    auto petrol = payment (2, 1, "Petrol", m_fuel, 40);
+
+    GncReportSortLevel by_description {GNC_REPORT_KEY_DESCRIPTION,
+                                       GNC_REPORT_DATE_NONE, FALSE};
+    auto rows = gnc_report_splits_new (m_splits, nullptr, &by_description,
+                                       nullptr, TRUE);
+    ASSERT_EQ (2u, gnc_report_splits_get_num_rows (rows));
+    EXPECT_EQ (petrol, gnc_report_splits_get_split (rows, 0));
+    EXPECT_EQ (bread, gnc_report_splits_get_split (rows, 1));
+    EXPECT_EQ (nullptr, gnc_report_splits_get_split (rows, 2));
+    EXPECT_NE (gnc_report_splits_get_group (rows, 0, 0),
+               gnc_report_splits_get_group (rows, 0, 1));
+    EXPECT_EQ (-1, gnc_report_splits_get_group (rows, 1, 0));
+    EXPECT_EQ (-1, gnc_report_splits_get_group (rows, 0, 2));
+    gnc_report_splits_free (rows);
+}
@@ -0,0 +1,262 @@
+/********************************************************************
+ * gtest-scrub-lots.cpp: Test incremental lot and gains scrubbing.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../AccountP.h"
+#include "../Transaction.h"
+#include "../Split.h"
+#include "../Scrub3.h"
+#include "../cap-gains.h"
+#include "../cashobjects.h"
+#include "../gnc-lot.h"
+}
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+
+class ScrubLotsTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        m_book = qof_book_new();
+        m_currency = gnc_commodity_new (m_book, "US Dollar", "CURRENCY",
+                                        "USD", "0", 100);
+        m_stock = gnc_commodity_new (m_book, "Acme Corp", "NYSE", "ACME",
+                                     "", 1000);
+        m_root = gnc_account_create_root (m_book);
+        m_broker = make_account ("Broker", ACCT_TYPE_STOCK, m_stock);
+        m_cash = make_account ("Cash", ACCT_TYPE_BANK, m_currency);
+    }
+    void TearDown() {
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        qof_book_destroy (m_book);
+        qof_close();
+    }
+    Account* make_account (const char* name, GNCAccountType type,
+                           gnc_commodity* comm) {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, type);
+        xaccAccountSetCommodity (acc, comm);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (m_root, acc);
+        return acc;
+    }
+    /* Buys (or sells, if shares is negative) at price dollars a share,
+     * day days after the start of 2000. */
+    Split* trade (int day, gint64 shares, gint64 price) {
+        auto trans = xaccMallocTransaction (m_book);
+        auto value = gnc_numeric_create (shares * price * 100, 100);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_currency);
+        xaccTransSetDatePostedSecsNormalized (trans,
+                                              946728000 + day * 86400);
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, m_broker);
+        xaccSplitSetAmount (split, gnc_numeric_create (shares, 1));
+        xaccSplitSetValue (split, value);
+        auto cash = xaccMallocSplit (m_book);
+        xaccSplitSetParent (cash, trans);
+        xaccSplitSetAccount (cash, m_cash);
+        xaccSplitSetAmount (cash, gnc_numeric_neg (value));
+        xaccSplitSetValue (cash, gnc_numeric_neg (value));
+        xaccTransCommitEdit (trans);
+        return split;
+    }
+    /* Buys ten shares and sells seven on alternate days. */
+    void trade_many (int count) {
+        xaccAccountBeginEdit (m_broker);
+        xaccAccountBeginEdit (m_cash);
+        for (int i = 0; i < count; ++i)
+            trade (i, i % 2 ? -7 : 10, 100 + i % 37);
+        xaccAccountCommitEdit (m_cash);
+        xaccAccountCommitEdit (m_broker);
+    }
+    /* After scrubbing, the total value of the broker account is the
+     * cost of the shares still held: the gains transactions take out
+     * the rest. */
+    gnc_numeric cost_basis () {
+        auto total = gnc_numeric_zero ();
+        for (auto node = xaccAccountGetSplitList (m_broker); node;
+             node = node->next)
+            total = gnc_numeric_add (total,
+                                     xaccSplitGetValue (GNC_SPLIT (node->data)),
+                                     100, GNC_HOW_RND_ROUND_HALF_UP);
+        return total;
+    }
+    QofBook* m_book;
+    gnc_commodity* m_currency;
+    gnc_commodity* m_stock;
+    Account* m_root;
+    Account* m_broker;
+    Account* m_cash;
+};
+
+TEST_F(ScrubLotsTest, dirty_scrub_matches_full_scrub)
+{
+    trade_many (200);
+    auto lots = xaccAccountGetLotList (m_broker);
+    EXPECT_EQ (nullptr, lots);
+    /* The first scrub of an account does all of it. */
+    xaccAccountTreeScrubDirtyLots (m_root);
+    lots = xaccAccountGetLotList (m_broker);
+    auto num_lots = g_list_length (lots);
+    g_list_free (lots);
+    EXPECT_EQ (100u, num_lots);
+    EXPECT_EQ (0u, xaccAccountTreeScrubDirtyLots (m_root));
+
+    /* Repricing an early purchase only touches its lot. */
+    auto split = GNC_SPLIT (xaccAccountGetSplitList (m_broker)->data);
+    auto trans = xaccSplitGetParent (split);
+    auto value = gnc_numeric_create (1234500, 100);
+    xaccTransBeginEdit (trans);
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        auto s = GNC_SPLIT (node->data);
+        auto v = s == split ? value : gnc_numeric_neg (value);
+        xaccSplitSetValue (s, v);
+        if (s != split)
+            xaccSplitSetAmount (s, v);
+    }
+    xaccTransCommitEdit (trans);
+    auto scrubbed = xaccAccountTreeScrubDirtyLots (m_root);
+    EXPECT_LT (0u, scrubbed);
+    EXPECT_GT (5u, scrubbed);
+
+    /* New trades are assigned to lots. */
+    trade (300, -3, 150);
+    scrubbed = xaccAccountTreeScrubDirtyLots (m_root);
+    EXPECT_LT (0u, scrubbed);
+    EXPECT_GT (5u, scrubbed);
+    auto sell = GNC_SPLIT (g_list_last (xaccAccountGetSplitList (m_broker))->data);
+    EXPECT_NE (nullptr, xaccSplitGetLot (sell));
+    auto basis = cost_basis ();
+
+    xaccAccountTreeScrubLots (m_root);
+    EXPECT_TRUE (gnc_numeric_equal (basis, cost_basis ()));
+}
+
+TEST_F(ScrubLotsTest, step)
+{
+    trade_many (40);
+    xaccAccountTreeScrubDirtyLots (m_root);
+    EXPECT_FALSE (xaccAccountTreeScrubDirtyLotsStep (m_root, 1));
+    trade (100, 10, 90);
+    trade (101, 10, 91);
+    EXPECT_TRUE (xaccAccountHasLotWork (m_broker));
+    while (xaccAccountTreeScrubDirtyLotsStep (m_root, 1));
+    EXPECT_FALSE (xaccAccountHasLotWork (m_broker));
+}
+
+TEST_F(ScrubLotsTest, no_trades_no_work)
+{
+    trade_many (4);
+    xaccAccountTreeScrubDirtyLots (m_root);
+    trade (10, 10, 90);
+    EXPECT_TRUE (xaccAccountHasLotWork (m_broker));
+    EXPECT_FALSE (xaccAccountHasLotWork (m_cash));
+
+    /* A purchase paid for in another currency makes the cash account
+     * one with trades. */
+    auto euro = gnc_commodity_new (m_book, "Euro", "CURRENCY", "EUR", "0",
+                                   100);
+    auto trans = xaccMallocTransaction (m_book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, euro);
+    xaccTransSetDatePostedSecsNormalized (trans, 946728000);
+    auto split = xaccMallocSplit (m_book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, m_cash);
+    xaccSplitSetAmount (split, gnc_numeric_create (-100, 1));
+    xaccSplitSetValue (split, gnc_numeric_create (-90, 1));
+    xaccTransCommitEdit (trans);
+    EXPECT_TRUE (xaccAccountHasLotWork (m_cash));
+}
+
+TEST_F(ScrubLotsTest, start_lot_work)
+{
+    trade_many (4);
+    xaccAccountTreeStartLotWork (m_root);
+    EXPECT_FALSE (xaccAccountHasLotWork (m_broker));
+    EXPECT_FALSE (xaccAccountHasLotWork (m_cash));
+    EXPECT_FALSE (xaccAccountTreeScrubDirtyLotsStep (m_root, 1));
+
+    auto buy = trade (10, 10, 90);
+    EXPECT_TRUE (xaccAccountHasLotWork (m_broker));
+    EXPECT_FALSE (xaccAccountHasLotWork (m_cash));
+    while (xaccAccountTreeScrubDirtyLotsStep (m_root, 1));
+    EXPECT_NE (nullptr, xaccSplitGetLot (buy));
+    /* The trades from before weren't touched. */
+    auto first = GNC_SPLIT (xaccAccountGetSplitList (m_broker)->data);
+    EXPECT_EQ (nullptr, xaccSplitGetLot (first));
+}
+
+TEST_F(ScrubLotsTest, DISABLED_benchmark)
+{
+    using clock = std::chrono::steady_clock;
+    const int trades = 50000, edits = 100;
+
+    trade_many (trades);
+    auto start = clock::now();
+    xaccAccountTreeScrubLots (m_root);
+    auto full = std::chrono::duration_cast<std::chrono::milliseconds>
+        (clock::now() - start).count();
+
+    auto splits = xaccAccountGetSplitList (m_broker);
+    auto length = g_list_length (splits);
+    std::chrono::microseconds incremental {0};
+    guint scrubbed = 0;
+    for (int i = 0; i < edits; ++i)
+    {
+        auto split = GNC_SPLIT (g_list_nth_data (splits, (i * 7919) % length));
+        /* Only reprice purchases, they're never split across lots. */
+        if (!gnc_numeric_positive_p (xaccSplitGetAmount (split))) continue;
+        auto value = gnc_numeric_add (xaccSplitGetValue (split),
+                                      gnc_numeric_create (1, 100), 100,
+                                      GNC_HOW_RND_ROUND_HALF_UP);
+        auto trans = xaccSplitGetParent (split);
+        xaccTransBeginEdit (trans);
+        xaccSplitSetValue (split, value);
+        xaccSplitSetValue (xaccSplitGetOtherSplit (split),
+                           gnc_numeric_neg (value));
+        xaccSplitSetAmount (xaccSplitGetOtherSplit (split),
+                            gnc_numeric_neg (value));
+        xaccTransCommitEdit (trans);
+        start = clock::now();
+        scrubbed += xaccAccountTreeScrubDirtyLots (m_root);
+        incremental += std::chrono::duration_cast<std::chrono::microseconds>
+            (clock::now() - start);
+    }
+    std::cout << "Full scrub of " << trades << " trades: " << full << " ms\n"
+              << "Dirty scrub after each of " << edits << " edits: "
+              << incremental.count() / edits << " us, "
+              << scrubbed << " lots" << std::endl;
+}
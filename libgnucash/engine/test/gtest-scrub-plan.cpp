@@ -0,0 +1,206 @@
+/********************************************************************
+ * gtest-scrub-plan.cpp: Test two-pass check and repair.            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../TransactionP.h"
+#include "../Split.h"
+#include "../ScrubPlan.h"
+#include "../cashobjects.h"
+}
+
+#include <gtest/gtest.h>
+#include <string>
+
+class ScrubPlanTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        m_book = qof_book_new();
+        m_currency = gnc_commodity_new (m_book, "US Dollar", "CURRENCY",
+                                        "USD", "0", 100);
+        m_root = gnc_account_create_root (m_book);
+        m_checking = make_account ("Checking", ACCT_TYPE_BANK);
+        m_expenses = make_account ("Expenses", ACCT_TYPE_EXPENSE);
+        /* Otherwise committing would repair the broken transactions. */
+        xaccDisableDataScrubbing ();
+    }
+    void TearDown() {
+        xaccEnableDataScrubbing ();
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        qof_book_destroy (m_book);
+        qof_close();
+    }
+    Account* make_account (const char* name, GNCAccountType type) {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetType (acc, type);
+        xaccAccountSetCommodity (acc, m_currency);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (m_root, acc);
+        return acc;
+    }
+    void add_split (Transaction* trans, Account* acc, gint64 cents) {
+        auto split = xaccMallocSplit (m_book);
+        xaccSplitSetParent (split, trans);
+        if (acc)
+            xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, gnc_numeric_create (cents, 100));
+        xaccSplitSetValue (split, gnc_numeric_create (cents, 100));
+    }
+    /* Pays from checking; the expense split's account and amount can be
+     * broken. */
+    Transaction* payment (const char* desc, gint64 cents, Account* to,
+                          gint64 to_cents) {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_currency);
+        xaccTransSetDescription (trans, desc);
+        xaccTransSetDatePostedSecsNormalized (trans, gnc_time (NULL));
+        add_split (trans, m_checking, -cents);
+        add_split (trans, to, to_cents);
+        xaccTransCommitEdit (trans);
+        return trans;
+    }
+    QofBook* m_book;
+    gnc_commodity* m_currency;
+    Account* m_root;
+    Account* m_checking;
+    Account* m_expenses;
+};
+
+TEST_F(ScrubPlanTest, plan_and_apply)
+{
+    payment ("Groceries", 10000, m_expenses, 10000);
+    auto unbalanced = payment ("Fuel", 5000, m_expenses, 3000);
+    auto orphaned = payment ("Lunch", 1000, nullptr, 1000);
+
+    auto plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    ASSERT_EQ (2u, xaccScrubPlanGetNumFixes (plan));
+    auto fix = xaccScrubPlanGetFix (plan, 0);
+    EXPECT_EQ (SCRUB_FIX_ORPHAN, fix->type);
+    EXPECT_EQ (orphaned, fix->trans);
+    fix = xaccScrubPlanGetFix (plan, 1);
+    EXPECT_EQ (SCRUB_FIX_IMBALANCE, fix->type);
+    EXPECT_EQ (unbalanced, fix->trans);
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (-2000, 100),
+                                    fix->imbalance));
+    EXPECT_EQ (nullptr, xaccScrubPlanGetFix (plan, 2));
+
+    /* The dry run changes nothing. */
+    auto report = xaccScrubPlanGetReport (plan);
+    std::string text {report};
+    g_free (report);
+    EXPECT_NE (std::string::npos, text.find ("Fuel"));
+    EXPECT_NE (std::string::npos, text.find ("Lunch"));
+    EXPECT_EQ (std::string::npos, text.find ("Groceries"));
+    EXPECT_FALSE (xaccTransIsBalanced (unbalanced));
+
+    xaccScrubPlanApply (plan, nullptr);
+    xaccScrubPlanFree (plan);
+    EXPECT_TRUE (xaccTransIsBalanced (unbalanced));
+    for (auto node = xaccTransGetSplitList (orphaned); node; node = node->next)
+        EXPECT_NE (nullptr, xaccSplitGetAccount (GNC_SPLIT (node->data)));
+
+    plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    EXPECT_EQ (0u, xaccScrubPlanGetNumFixes (plan));
+    xaccScrubPlanFree (plan);
+}
+
+TEST_F(ScrubPlanTest, no_currency)
+{
+    auto trans = xaccMallocTransaction (m_book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Rent");
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_time (NULL));
+    add_split (trans, m_checking, -50000);
+    add_split (trans, m_expenses, 50000);
+    xaccTransCommitEdit (trans);
+    ASSERT_EQ (nullptr, xaccTransGetCurrency (trans));
+
+    /* The splits and the balance are checked once there's a currency. */
+    auto plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    ASSERT_EQ (4u, xaccScrubPlanGetNumFixes (plan));
+    EXPECT_EQ (SCRUB_FIX_CURRENCY, xaccScrubPlanGetFix (plan, 0)->type);
+    EXPECT_EQ (SCRUB_FIX_SPLIT, xaccScrubPlanGetFix (plan, 1)->type);
+    EXPECT_EQ (SCRUB_FIX_SPLIT, xaccScrubPlanGetFix (plan, 2)->type);
+    EXPECT_EQ (SCRUB_FIX_IMBALANCE, xaccScrubPlanGetFix (plan, 3)->type);
+    xaccScrubPlanApply (plan, nullptr);
+    xaccScrubPlanFree (plan);
+    EXPECT_EQ (m_currency, xaccTransGetCurrency (trans));
+
+    plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    EXPECT_EQ (0u, xaccScrubPlanGetNumFixes (plan));
+    xaccScrubPlanFree (plan);
+}
+
+TEST_F(ScrubPlanTest, deleted_before_apply)
+{
+    auto unbalanced = payment ("Fuel", 5000, m_expenses, 3000);
+    auto plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    ASSERT_EQ (1u, xaccScrubPlanGetNumFixes (plan));
+
+    xaccTransBeginEdit (unbalanced);
+    xaccTransDestroy (unbalanced);
+    xaccTransCommitEdit (unbalanced);
+    xaccScrubPlanApply (plan, nullptr);
+    xaccScrubPlanFree (plan);
+    EXPECT_EQ (nullptr, gnc_account_lookup_by_name (m_root, "Imbalance-USD"));
+}
+
+static int progress_calls;
+static void
+count_progress (const char *message, double percent)
+{
+    ++progress_calls;
+}
+
+TEST_F(ScrubPlanTest, many_transactions)
+{
+    xaccAccountBeginEdit (m_checking);
+    xaccAccountBeginEdit (m_expenses);
+    for (int i = 0; i < 5000; ++i)
+        payment ("Coffee", 300, m_expenses, i % 500 ? 300 : 250);
+    xaccAccountCommitEdit (m_expenses);
+    xaccAccountCommitEdit (m_checking);
+
+    /* Progress is reported when the checking threads are done. */
+    progress_calls = 0;
+    auto plan = xaccScrubPlanNew (m_root, FALSE, count_progress);
+    EXPECT_EQ (2, progress_calls);
+    ASSERT_EQ (10u, xaccScrubPlanGetNumFixes (plan));
+    for (guint i = 0; i < 10; ++i)
+        EXPECT_EQ (SCRUB_FIX_IMBALANCE, xaccScrubPlanGetFix (plan, i)->type);
+    xaccScrubPlanApply (plan, count_progress);
+    xaccScrubPlanFree (plan);
+
+    plan = xaccScrubPlanNew (m_root, FALSE, nullptr);
+    EXPECT_EQ (0u, xaccScrubPlanGetNumFixes (plan));
+    xaccScrubPlanFree (plan);
+}
@@ -24,8 +24,13 @@
 
 #include "../guid.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <random>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include <iomanip>
 #include <string>
 #include <iostream>
@@ -97,3 +102,105 @@ TEST (GncGUID, round_trip)
     EXPECT_EQ (guid1, guid2);
 }
 
+
+TEST (GncGUID, random_unique)
+{
+    constexpr size_t per_thread = 50000;
+    std::vector<std::vector<GncGUID>> guids (4);
+    std::vector<std::thread> threads;
+    for (auto& list : guids)
+        threads.emplace_back ([&list] {
+            for (size_t i = 0; i < per_thread; ++i)
+                list.push_back (gnc::GUID::create_random ());
+        });
+    for (auto& thread : threads)
+        thread.join ();
+
+    std::set<std::string> seen;
+    for (auto const & list : guids)
+        for (auto const & guid : list)
+        {
+            EXPECT_EQ (0x40, guid.reserved[6] & 0xf0) << "version 4";
+            EXPECT_EQ (0x80, guid.reserved[8] & 0xc0) << "RFC 4122 variant";
+            seen.insert (gnc::GUID {guid}.to_string ());
+        }
+    EXPECT_EQ (guids.size () * per_thread, seen.size ());
+}
+
+TEST (GncGUID, DISABLED_random_throughput)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int count = 1000000;
+    GncGUID sink;
+    auto start = Clock::now ();
+    for (int i = 0; i < count; ++i)
+        sink = gnc::GUID::create_random ();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (Clock::now () - start).count ();
+    std::cout << elapsed / count << " ns per GUID" << std::endl;
+    EXPECT_NE (gnc::GUID::null_guid (), sink);
+}
+
+#include <boost/uuid/uuid_io.hpp>
+
+TEST (GncGUID, hex_codec)
+{
+    std::mt19937 rng {42};
+    for (int i = 0; i < 10000; ++i)
+    {
+        GncGUID guid;
+        for (auto& byte : guid.reserved)
+            byte = rng () & 0xff;
+        boost::uuids::uuid uuid;
+        std::copy (guid.reserved, guid.reserved + GUID_DATA_SIZE, uuid.data);
+        auto expected = boost::uuids::to_string (uuid);
+        expected.erase (std::remove (expected.begin (), expected.end (), '-'),
+                        expected.end ());
+
+        char buff[GUID_ENCODING_LENGTH + 1];
+        EXPECT_EQ (buff + GUID_ENCODING_LENGTH, guid_to_string_buff (&guid, buff));
+        ASSERT_EQ (expected, buff);
+        EXPECT_EQ (expected, gnc::GUID {guid}.to_string ());
+
+        GncGUID back;
+        ASSERT_TRUE (string_to_guid (buff, &back));
+        EXPECT_TRUE (guid_equal (&guid, &back));
+        std::string upper {buff};
+        std::transform (upper.begin (), upper.end (), upper.begin (), ::toupper);
+        EXPECT_EQ (gnc::GUID::from_string (upper), guid);
+        // The dashed form is still accepted.
+        EXPECT_EQ (gnc::GUID::from_string (boost::uuids::to_string (uuid)), guid);
+    }
+
+    // Every character that isn't a hex digit is rejected in every position.
+    std::string valid (GUID_ENCODING_LENGTH, 'a');
+    GncGUID guid;
+    for (size_t pos = 0; pos < valid.size (); ++pos)
+        for (int c = 1; c < 256; ++c)
+        {
+            auto str = valid;
+            str[pos] = static_cast<char> (c);
+            bool hex = isxdigit (c);
+            EXPECT_EQ (hex, gnc::GUID::is_valid_guid (str)) << pos << " " << c;
+            EXPECT_EQ (hex, string_to_guid (str.c_str (), &guid)) << pos << " " << c;
+        }
+    EXPECT_FALSE (string_to_guid (valid.substr (1).c_str (), &guid));
+    EXPECT_FALSE (string_to_guid ((valid + "a").c_str (), &guid));
+}
+
+TEST (GncGUID, DISABLED_hex_throughput)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int count = 1000000;
+    auto guid = guid_new_return ();
+    char buff[GUID_ENCODING_LENGTH + 1];
+    auto start = Clock::now ();
+    for (int i = 0; i < count; ++i)
+    {
+        guid_to_string_buff (&guid, buff);
+        string_to_guid (buff, &guid);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (Clock::now () - start).count ();
+    std::cout << elapsed / count << " ns per encode and decode" << std::endl;
+}
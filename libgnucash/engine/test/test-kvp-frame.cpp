@@ -27,6 +27,7 @@
 #include "../kvp-frame.hpp"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <chrono>
 
 class KvpFrameTest : public ::testing::Test
 {
@@ -226,3 +227,149 @@ TEST (KvpFrameTestForEachPrefix, for_each_prefix_2)
             EXPECT_EQ(value->get_type(), KvpValue::Type::INT64);
         }, count);
 }
+
+TEST (KvpFrameTestOrder, keys_sorted)
+{
+    KvpFrame fr;
+    for (auto key : {"mango", "apple", "zucchini", "kiwi", "banana"})
+        fr.set({key}, new KvpValue {(int64_t)1});
+    delete fr.set({"kiwi"}, new KvpValue {(int64_t)2});
+    delete fr.set({"banana"}, nullptr);
+    auto keys = fr.get_keys();
+    std::vector<std::string> expected {"apple", "kiwi", "mango", "zucchini"};
+    EXPECT_EQ(expected, keys);
+    EXPECT_EQ(2, fr.get_slot({"kiwi"})->get<int64_t>());
+    EXPECT_EQ(nullptr, fr.get_slot({"banana"}));
+}
+
+TEST (KvpFrameTestOrder, find_value)
+{
+    KvpFrame fr;
+    delete fr.set({"placeholder"}, new KvpValue {g_strdup ("true")});
+    delete fr.set({"hidden"}, new KvpValue {(int64_t)1});
+    EXPECT_EQ(fr.get_slot({"placeholder"}), fr.find_value("placeholder"));
+    EXPECT_EQ(1, fr.find_value("hidden")->get<int64_t>());
+    EXPECT_EQ(nullptr, fr.find_value("color"));
+    EXPECT_EQ(nullptr, KvpFrame{}.find_value("notes"));
+}
+
+TEST (KvpFrameTestOrder, change_stamp)
+{
+    KvpFrame fr;
+    EXPECT_EQ(0u, fr.get_change_stamp());
+    delete fr.set({"hidden"}, new KvpValue {(int64_t)1});
+    auto stamp = fr.get_change_stamp();
+    EXPECT_NE(0u, stamp);
+    KvpFrame copy {fr};
+    EXPECT_EQ(stamp, copy.get_change_stamp());
+    delete fr.set({"hidden"}, new KvpValue {(int64_t)0});
+    EXPECT_NE(stamp, fr.get_change_stamp());
+    EXPECT_NE(copy.get_change_stamp(), fr.get_change_stamp());
+    stamp = fr.get_change_stamp();
+    delete fr.set_path({"tax-US", "code"}, new KvpValue {g_strdup ("N262")});
+    EXPECT_NE(stamp, fr.get_change_stamp());
+}
+
+/* Counts the bytes its containers allocate, to measure the memory the
+ * slot storage takes. */
+static size_t allocated_bytes = 0;
+
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+    T* allocate(size_t n)
+    {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept
+    {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&)
+{ return true; }
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&)
+{ return false; }
+
+/* Compares the memory use and the lookup time of the sorted-vector slot
+ * storage with the std::map it replaced. Not run by default; use
+ * --gtest_also_run_disabled_tests. */
+TEST (KvpFrameBenchmark, DISABLED_map_vs_vector)
+{
+    using slot_type = KvpFrameImpl::map_type::value_type;
+    using old_map_type = std::map<const char *, KvpValue*,
+                                  KvpFrameImpl::cstring_comparer,
+                                  CountingAllocator<std::pair<const char* const,
+                                                              KvpValue*>>>;
+    using vector_type = std::vector<slot_type, CountingAllocator<slot_type>>;
+    const char* keys[] {"color", "date-posted", "filter", "hidden", "notes",
+                        "placeholder", "sort-order", "trans-read-only"};
+    constexpr size_t num_frames = 10000, lookups = 200;
+    using clock = std::chrono::steady_clock;
+    KvpFrameImpl::cstring_comparer less;
+
+    for (size_t nkeys : {1, 3, 8})
+    {
+        /* The vectors are filled one slot at a time at the sorted
+         * position, the way KvpFrame::set inserts, so they grow the same
+         * way the frames' storage does. */
+        allocated_bytes = 0;
+        std::vector<old_map_type> maps(num_frames);
+        for (auto& map : maps)
+            for (size_t k = 0; k < nkeys; ++k)
+                map.emplace(keys[k], nullptr);
+        auto map_bytes = allocated_bytes / num_frames;
+
+        allocated_bytes = 0;
+        std::vector<vector_type> vectors(num_frames);
+        for (auto& vec : vectors)
+            for (size_t k = 0; k < nkeys; ++k)
+            {
+                auto pos = std::lower_bound(vec.begin(), vec.end(), keys[k],
+                                            [&less](const slot_type& slot,
+                                                    const char* key)
+                                            { return less(slot.first, key); });
+                vec.emplace(pos, keys[k], nullptr);
+            }
+        auto vec_bytes = allocated_bytes / num_frames;
+
+        std::vector<KvpFrame> frames(num_frames);
+        for (auto& frame : frames)
+            for (size_t k = 0; k < nkeys; ++k)
+                frame.set({keys[k]}, new KvpValue {(int64_t)k});
+
+        /* Both look up the same single keys in one frame. */
+        size_t found = 0;
+        auto start = clock::now();
+        for (size_t n = 0; n < lookups; ++n)
+            for (auto& map : maps)
+                found += (map.find("placeholder") != map.end()) +
+                    (map.find("color") != map.end());
+        auto map_time = clock::now() - start;
+
+        start = clock::now();
+        for (size_t n = 0; n < lookups; ++n)
+            for (auto& frame : frames)
+                found += (frame.find_value("placeholder") != nullptr) +
+                    (frame.find_value("color") != nullptr);
+        auto frame_time = clock::now() - start;
+
+        std::cout << nkeys << " keys: std::map " << map_bytes
+                  << " bytes/frame, "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      map_time).count()
+                  << " ms; vector " << vec_bytes << " bytes/frame, "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      frame_time).count() << " ms; "
+                  << found << " hits" << std::endl;
+    }
+}
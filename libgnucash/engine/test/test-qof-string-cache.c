@@ -59,7 +59,9 @@ test_qof_string_cache( void )
     gchar* str1_2;
     gchar* str1_3;
     gchar* str1_4;
+    QofStringCacheStats before, stats;
 
+    qof_string_cache_get_stats(&before);
     strncpy(str, "str1", sizeof(str));
     str1_1 = qof_string_cache_insert(str);      /* Refcount = 1 */
     g_assert(str1_1 != str);
@@ -70,15 +72,74 @@ test_qof_string_cache( void )
     g_assert(str1_1 == str1_3);
     qof_string_cache_remove(str);               /* Refcount = 1 */
     qof_string_cache_remove(str);               /* Refcount = 0 */
+    /* The memory of a removed string may be reused, so check that it's
+     * gone from the statistics rather than by its address. */
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpint(stats.unique_strings, ==, before.unique_strings);
+    g_assert_cmpint(stats.inserts - before.inserts, ==, 3);
+    g_assert_cmpint(stats.hits - before.hits, ==, 2);
     strncpy(str, "str2", sizeof(str));
     qof_string_cache_insert(str);               /* Refcount = 1 */
     strncpy(str, "str1", sizeof(str));
     str1_4 = qof_string_cache_insert(str);      /* Refcount = 1 */
-    g_assert(str1_1 != str1_4);
+    g_assert_cmpstr(str1_4, ==, "str1");
+    qof_string_cache_insert(str);               /* Refcount = 2 */
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpint(stats.unique_strings - before.unique_strings, ==, 2);
+    g_assert_cmpint(stats.references - before.references, ==, 3);
+    g_assert_cmpint(stats.bytes_saved - before.bytes_saved, ==, strlen("str1") + 1);
+}
+
+#define NUM_THREADS 4
+#define NUM_STRINGS 1000
+
+static gpointer
+insert_strings (gpointer data)
+{
+    gchar **cached = data;
+    gchar str[32];
+    int i;
+    for (i = 0; i < NUM_STRINGS; ++i)
+    {
+        g_snprintf (str, sizeof(str), "string %d", i);
+        cached[i] = qof_string_cache_insert (str);
+    }
+    return NULL;
+}
+
+static void
+test_qof_string_cache_threads( void )
+{
+    /* Concurrent inserts of the same strings must all get the same copy. */
+    static gchar *cached[NUM_THREADS][NUM_STRINGS];
+    GThread *threads[NUM_THREADS];
+    QofStringCacheStats before, stats;
+    int i, j;
+
+    qof_string_cache_get_stats (&before);
+    for (i = 0; i < NUM_THREADS; ++i)
+        threads[i] = g_thread_new ("string-cache", insert_strings, cached[i]);
+    for (i = 0; i < NUM_THREADS; ++i)
+        g_thread_join (threads[i]);
+    for (i = 1; i < NUM_THREADS; ++i)
+        for (j = 0; j < NUM_STRINGS; ++j)
+            g_assert (cached[i][j] == cached[0][j]);
+    qof_string_cache_get_stats (&stats);
+    g_assert_cmpint (stats.unique_strings - before.unique_strings, ==, NUM_STRINGS);
+    g_assert_cmpint (stats.references - before.references, ==,
+                     NUM_THREADS * NUM_STRINGS);
+    g_assert_cmpint (stats.hits - before.hits, ==, (NUM_THREADS - 1) * NUM_STRINGS);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        for (j = 0; j < NUM_STRINGS; ++j)
+            qof_string_cache_remove (cached[i][j]);
+    qof_string_cache_get_stats (&stats);
+    g_assert_cmpint (stats.unique_strings, ==, before.unique_strings);
 }
 
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache threads", test_qof_string_cache_threads);
 }
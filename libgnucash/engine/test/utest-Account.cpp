@@ -2038,6 +2038,67 @@ test_xaccAccountFindOpenLots (Fixture *fixture, gconstpointer pData)
     count_sorts = 0;
 }
 
+static gpointer
+collect_open_lots (GNCLot *lot, gpointer data)
+{
+    auto lots = static_cast<GList**>(data);
+    *lots = g_list_append (*lots, lot);
+    return NULL;
+}
+
+static time64
+lot_opening_date (GNCLot *lot)
+{
+    auto split = gnc_lot_get_earliest_split (lot);
+    return xaccTransGetDate (xaccSplitGetParent (split));
+}
+
+/* xaccAccountForEachOpenLotByDate
+gpointer
+xaccAccountForEachOpenLotByDate (Account *acc, gboolean reverse,// C: 1 in 1 */
+static void
+test_xaccAccountForEachOpenLotByDate (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *acct = gnc_account_lookup_by_name (root, "baz");
+    GList *lots = NULL, *rlots = NULL;
+
+    g_assert (acct);
+    xaccAccountForEachOpenLotByDate (acct, FALSE, collect_open_lots, &lots);
+    xaccAccountForEachOpenLotByDate (acct, TRUE, collect_open_lots, &rlots);
+    g_assert_cmpint (g_list_length (lots), == , 2);
+    g_assert (lots->data == rlots->next->data);
+    g_assert (lots->next->data == rlots->data);
+    auto first = GNC_LOT (lots->data), second = GNC_LOT (lots->next->data);
+    g_assert_cmpint (lot_opening_date (first), <, lot_opening_date (second));
+    g_list_free (lots);
+    g_list_free (rlots);
+    lots = NULL;
+
+    /* Moving the opening of the first lot past the second reorders them,
+     * and changing an amount is reflected in the lot's balance. */
+    auto split = gnc_lot_get_earliest_split (first);
+    auto trans = xaccSplitGetParent (split);
+    auto balance = gnc_lot_get_balance (first);
+    xaccTransBeginEdit (trans);
+    xaccTransSetDatePostedSecs (trans, lot_opening_date (second) + 86400);
+    xaccSplitSetAmount (split, gnc_numeric_add (xaccSplitGetAmount (split),
+                                                gnc_numeric_create (100, 1),
+                                                GNC_DENOM_AUTO,
+                                                GNC_HOW_DENOM_EXACT));
+    xaccTransCommitEdit (trans);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (first),
+                                 gnc_numeric_add (balance,
+                                                  gnc_numeric_create (100, 1),
+                                                  GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_EXACT)));
+    xaccAccountForEachOpenLotByDate (acct, FALSE, collect_open_lots, &lots);
+    g_assert_cmpint (g_list_length (lots), == , 2);
+    g_assert (lots->data == second);
+    g_assert (lots->next->data == first);
+    g_list_free (lots);
+}
+
 static gpointer
 bogus_for_each_lot_func (GNCLot *lot, gpointer data)
 {
@@ -2078,6 +2139,32 @@ test_xaccAccountForEachLot (Fixture *fixture, gconstpointer pData)
  * xaccAccountSetHidden
  * xaccAccountIsHidden
 */
+/* The placeholder flag is cached; make sure the cache follows the KVP
+ * whether it's changed through the setter, through the generic KVP
+ * functions or by a backend writing to the frame directly. */
+static void
+test_xaccAccountGetPlaceholder (Fixture *fixture, gconstpointer pData)
+{
+    auto acc = fixture->acct;
+    GValue v = G_VALUE_INIT;
+    g_assert (!xaccAccountGetPlaceholder (acc));
+    xaccAccountSetPlaceholder (acc, TRUE);
+    g_assert (xaccAccountGetPlaceholder (acc));
+    xaccAccountSetPlaceholder (acc, FALSE);
+    g_assert (!xaccAccountGetPlaceholder (acc));
+
+    xaccAccountBeginEdit (acc);
+    g_value_init (&v, G_TYPE_STRING);
+    g_value_set_static_string (&v, "true");
+    qof_instance_set_path_kvp (QOF_INSTANCE (acc), &v, {"placeholder"});
+    xaccAccountCommitEdit (acc);
+    g_assert (xaccAccountGetPlaceholder (acc));
+    g_value_unset (&v);
+
+    delete qof_instance_get_slots (QOF_INSTANCE (acc))->set ({"placeholder"},
+                                                             nullptr);
+    g_assert (!xaccAccountGetPlaceholder (acc));
+}
 /* xaccAccountHasAncestor
 gboolean
 xaccAccountHasAncestor (const Account *acc, const Account * ancestor)// C: 5 in 3 */
@@ -2581,7 +2668,9 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountForEachOpenLotByDate", Fixture, &complex_data, setup, test_xaccAccountForEachOpenLotByDate,  teardown );
 
+    GNC_TEST_ADD (suitename, "xaccAccountGetPlaceholder", Fixture, NULL, setup, test_xaccAccountGetPlaceholder,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountHasAncestor", Fixture, &complex, setup, test_xaccAccountHasAncestor,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "AccountType Stuff", test_xaccAccountType_Stuff );
     GNC_TEST_ADD_FUNC (suitename, "AccountType Compatibility", test_xaccAccountType_Compatibility);
@@ -202,6 +202,119 @@ test_invoice_posted_trans ( Fixture *fixture, gconstpointer pData )
     }
 }
 
+static void
+test_invoice_find_open_lots ( Fixture *fixture, gconstpointer pData )
+{
+    GncJob *job = gncJobCreate(fixture->book);
+    GncEmployee *employee = gncEmployeeCreate(fixture->book);
+    GncOwner job_owner, other;
+    GNCLot *owner_lot = gnc_lot_new(fixture->book);
+    GNCLot *job_lot = gnc_lot_new(fixture->book);
+    GNCLot *other_lot = gnc_lot_new(fixture->book);
+    GList *lots;
+
+    gncJobSetOwner(job, &fixture->owner);
+    gncOwnerInitJob(&job_owner, job);
+    gncOwnerInitEmployee(&other, employee);
+    xaccAccountInsertLot(fixture->account2, owner_lot);
+    xaccAccountInsertLot(fixture->account2, job_lot);
+    xaccAccountInsertLot(fixture->account2, other_lot);
+    gncOwnerAttachToLot(&fixture->owner, owner_lot);
+    gncOwnerAttachToLot(&job_owner, job_lot);
+    gncOwnerAttachToLot(&other, other_lot);
+
+    /* The job's lots are the owner's too, in the account's order. */
+    lots = gncOwnerFindOpenLots(&fixture->owner, fixture->account2,
+                                gncOwnerLotMatchOwnerFunc, &fixture->owner, NULL);
+    g_assert (g_list_length (lots) == 2);
+    g_assert (lots->data == owner_lot);
+    g_assert (lots->next->data == job_lot);
+    g_list_free (lots);
+
+    lots = gncOwnerFindOpenLots(&other, fixture->account2,
+                                gncOwnerLotMatchOwnerFunc, &other, NULL);
+    g_assert (g_list_length (lots) == 1);
+    g_assert (lots->data == other_lot);
+    g_list_free (lots);
+
+    /* Changing a lot's owner moves it in the index. */
+    gncOwnerAttachToLot(&fixture->owner, other_lot);
+    lots = gncOwnerFindOpenLots(&other, fixture->account2,
+                                gncOwnerLotMatchOwnerFunc, &other, NULL);
+    g_assert (lots == NULL);
+    lots = gncOwnerFindOpenLots(&fixture->owner, fixture->account2,
+                                gncOwnerLotMatchOwnerFunc, &fixture->owner, NULL);
+    g_assert (g_list_length (lots) == 3);
+    g_list_free (lots);
+
+    gnc_lot_destroy(owner_lot);
+    gnc_lot_destroy(job_lot);
+    gnc_lot_destroy(other_lot);
+    gncJobBeginEdit(job);
+    gncJobDestroy(job);
+    gncEmployeeBeginEdit(employee);
+    gncEmployeeDestroy(employee);
+}
+
+static void
+test_invoice_totals ( Fixture *fixture, gconstpointer pData )
+{
+    GncEntry *entry = gncEntryCreate(fixture->book);
+    GncTaxTable *table = gncTaxTableCreate(fixture->book);
+    GncTaxTableEntry *tt_entry = gncTaxTableEntryCreate();
+    GncInvoice *other = gncInvoiceCreate(fixture->book);
+    GncInvoiceTotals *totals;
+    GList *invoices;
+
+    gncInvoiceSetCurrency(fixture->invoice, fixture->commodity);
+    gncInvoiceSetOwner(fixture->invoice, &fixture->owner);
+    gncEntrySetInvAccount(entry, fixture->account);
+    gncEntrySetQuantity(entry, gnc_numeric_create(2, 1));
+    gncEntrySetInvPrice(entry, gnc_numeric_create(1000, 100));
+    gncInvoiceAddEntry(fixture->invoice, entry);
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice),
+                                 gnc_numeric_create(2000, 100)));
+
+    /* Changing an entry changes the remembered totals. */
+    gncEntrySetQuantity(entry, gnc_numeric_create(3, 1));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice),
+                                 gnc_numeric_create(3000, 100)));
+
+    gncTaxTableSetName(table, "Sales tax");
+    gncTaxTableEntrySetAccount(tt_entry, fixture->account2);
+    gncTaxTableEntrySetType(tt_entry, GNC_AMT_TYPE_PERCENT);
+    gncTaxTableEntrySetAmount(tt_entry, gnc_numeric_create(10, 1));
+    gncTaxTableAddEntry(table, tt_entry);
+    gncEntrySetInvTaxTable(entry, table);
+    gncEntrySetInvTaxable(entry, TRUE);
+    gncEntrySetInvTaxIncluded(entry, FALSE);
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalTax(fixture->invoice),
+                                 gnc_numeric_create(300, 100)));
+
+    /* So does changing the tax table, even within the same second. */
+    gncTaxTableEntrySetAmount(tt_entry, gnc_numeric_create(20, 1));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalSubtotal(fixture->invoice),
+                                 gnc_numeric_create(3000, 100)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalTax(fixture->invoice),
+                                 gnc_numeric_create(600, 100)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice),
+                                 gnc_numeric_create(3600, 100)));
+
+    gncInvoiceSetCurrency(other, fixture->commodity);
+    invoices = g_list_prepend (g_list_prepend (NULL, other), fixture->invoice);
+    totals = gncInvoiceGetTotalsList(invoices);
+    g_assert (gnc_numeric_equal (totals[0].subtotal, gnc_numeric_create(3000, 100)));
+    g_assert (gnc_numeric_equal (totals[0].tax, gnc_numeric_create(600, 100)));
+    g_assert (gnc_numeric_equal (totals[0].total, gnc_numeric_create(3600, 100)));
+    g_assert (gnc_numeric_zero_p (totals[1].total));
+    g_free (totals);
+    g_list_free (invoices);
+
+    gncInvoiceRemoveEntries(fixture->invoice);
+    gncInvoiceBeginEdit(other);
+    gncInvoiceDestroy(other);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
@@ -215,4 +328,6 @@ test_suite_gncInvoice ( void )
     GNC_TEST_ADD( suitename, "post trans - customer creditnote", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
     pData.is_cn = FALSE;   // Customer invoice
     GNC_TEST_ADD( suitename, "post trans - customer invoice", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "remembered totals", Fixture, &pData, setup, test_invoice_totals, teardown );
+    GNC_TEST_ADD( suitename, "find open lots by owner", Fixture, &pData, setup, test_invoice_find_open_lots, teardown );
 }
@@ -1799,6 +1799,7 @@ test_xaccTransOrder_num_action (Fixture *fixture, gconstpointer pData)
  * xaccTransGetDateEnteredTS C: 1  Local: 0:0:0
  * xaccTransRetDatePostedTS C: 10 in 6  Local: 1:1:0
  * xaccTransGetDatePostedGDate C: 1  Local: 1:0:0
+ * xaccTransGetDatePostedDayNum Local: 1:0:0
  * xaccTransRetDateEnteredTS C: 1  Local: 0:1:0
  * xaccTransGetDateDueTS C: 1  Local: 1:0:0
  * xaccTransRetDateDueTS C: 1 SCM: 2 in 2 Local: 0:1:0
@@ -1815,6 +1816,28 @@ test_xaccTransGetTxnType (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (p, ==, xaccTransGetTxnType(txn));
 }
 
+static void
+test_xaccTransGetDatePostedDayNum (Fixture *fixture, gconstpointer pData)
+{
+    auto txn = fixture->txn;
+    GDate date, check;
+    g_date_set_dmy (&date, 14, G_DATE_FEBRUARY, 2018);
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedGDate (txn, date);
+    xaccTransCommitEdit (txn);
+    g_assert_cmpint (xaccTransGetDatePostedDayNum (txn), ==, 17576);
+    gnc_gdate_set_day_num (&check, xaccTransGetDatePostedDayNum (txn));
+    g_assert_cmpint (g_date_compare (&check, &date), ==, 0);
+    /* The cached value follows changes and rollbacks. */
+    xaccTransBeginEdit (txn);
+    g_date_add_days (&date, 1);
+    xaccTransSetDatePostedGDate (txn, date);
+    g_assert_cmpint (xaccTransGetDatePostedDayNum (txn), ==, 17577);
+    xaccTransRollbackEdit (txn);
+    g_assert_cmpint (xaccTransGetDatePostedDayNum (txn), ==, 17576);
+    g_assert_cmpint (xaccTransGetDatePostedDayNum (NULL), ==, G_MININT32);
+}
+
 /* xaccTransGetReadOnly C: 7 in 5  Local: 1:0:0
  * xaccTransIsReadonlyByPostedDate C: 2 in 2  Local: 0:0:0
  * xaccTransHasReconciledSplitsByAccount Local: 1:0:0
@@ -2038,6 +2061,7 @@ test_suite_transaction (void)
     GNC_TEST_ADD (suitename, "xaccTransRollbackEdit - Backend Errors", Fixture, NULL, setup, test_xaccTransRollbackEdit_BackendErrors, teardown);
     GNC_TEST_ADD (suitename, "xaccTransOrder_num_action", Fixture, NULL, setup, test_xaccTransOrder_num_action, teardown);
     GNC_TEST_ADD (suitename, "xaccTransGetTxnType", Fixture, NULL, setup, test_xaccTransGetTxnType, teardown);
+    GNC_TEST_ADD (suitename, "xaccTransGetDatePostedDayNum", Fixture, NULL, setup, test_xaccTransGetDatePostedDayNum, teardown);
     GNC_TEST_ADD (suitename, "xaccTransVoid", Fixture, NULL, setup, test_xaccTransVoid, teardown);
     GNC_TEST_ADD (suitename, "xaccTransReverse", Fixture, NULL, setup, test_xaccTransReverse, teardown);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_no_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_no_dirty, teardown_with_gains);